@@ -36,6 +36,7 @@ struct BMesh;
 struct BoundBox;
 struct Depsgraph;
 struct EditMeshData;
+struct EditMeshEvalCache;
 struct Mesh;
 struct MeshStatVis;
 struct Object;
@@ -83,6 +84,9 @@ typedef struct BMEditMesh {
    */
   char needs_flush_to_id;
 
+  /** Converted mesh reused by modifier evaluation, shared by evaluated copies. */
+  struct EditMeshEvalCache *eval_cache;
+
 } BMEditMesh;
 
 /* editmesh.c */
@@ -92,6 +96,12 @@ BMEditMesh *BKE_editmesh_copy(BMEditMesh *em);
 BMEditMesh *BKE_editmesh_from_object(struct Object *ob);
 void BKE_editmesh_free_derivedmesh(BMEditMesh *em);
 void BKE_editmesh_free(BMEditMesh *em);
+void BKE_editmesh_eval_cache_clear(BMEditMesh *em);
+void BKE_editmesh_eval_cache_tag_coords(BMEditMesh *em);
+bool BKE_editmesh_eval_cache_step_is_coords_only(BMEditMesh *em);
+void BKE_editmesh_mesh_for_eval_fill(BMEditMesh *em,
+                                     struct Mesh *me,
+                                     const CustomData_MeshMasks *cd_mask_extra);
 
 float (*BKE_editmesh_vert_coords_alloc(struct Depsgraph *depsgraph,
                                        struct BMEditMesh *em,
@@ -90,6 +90,11 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
 
 #define SEQ_CURRENT_END SEQ_ALL_END
 
+/* Maximum number of frames rendered at once, each prefetch worker has its own copy of the scene,
+ * so extra workers are only started when a single worker can't keep up with playback. */
+#define SEQ_PREFETCH_WORKERS_MAX 4
+
+/* Each prefetch worker uses its own ID: SEQ_TASK_PREFETCH_RENDER + worker index. */
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
   SEQ_TASK_PREFETCH_RENDER,
@@ -376,6 +381,17 @@ bool BKE_sequencer_cache_is_full(struct Scene *scene);
  * Sequencer frame prefetching
  * ********************************************************************** */
 
+typedef struct SeqPrefetchStats {
+  /* Final frames requested by the main thread and how many of them were prefetched. */
+  int frames_requested;
+  int frames_hit;
+  /* Frames rendered by prefetch workers. */
+  int frames_rendered;
+  /* Average time to render a prefetched frame, in frames of playback. */
+  float cost;
+  int workers_num;
+} SeqPrefetchStats;
+
 void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, float cost);
 void BKE_sequencer_prefetch_stop_all(void);
 void BKE_sequencer_prefetch_stop(struct Scene *scene);
@@ -386,6 +402,8 @@ void BKE_sequencer_prefetch_get_time_range(struct Scene *scene, int *start, int
 SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context);
 struct Sequence *BKE_sequencer_prefetch_get_original_sequence(struct Sequence *seq,
                                                               struct Scene *scene);
+void BKE_sequencer_prefetch_stats_add_request(struct Scene *scene, bool is_hit);
+void BKE_sequencer_prefetch_get_stats(struct Scene *scene, SeqPrefetchStats *r_stats);
 
 /* **********************************************************************
  * seqeffects.c
@@ -1754,6 +1754,58 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Check if \a mesh_eval only has deformed vertex positions compared to \a mesh_input,
+ * all other data being referenced from the input mesh.
+ */
+static bool mesh_eval_is_deformed_input(const Mesh *mesh_eval, const Mesh *mesh_input)
+{
+  return mesh_eval->runtime.deformed_only && (mesh_eval->totvert == mesh_input->totvert) &&
+         (mesh_eval->totedge == mesh_input->totedge) &&
+         (mesh_eval->totloop == mesh_input->totloop) &&
+         (mesh_eval->totpoly == mesh_input->totpoly) && (mesh_eval->medge == mesh_input->medge) &&
+         (mesh_eval->mloop == mesh_input->mloop) && (mesh_eval->mpoly == mesh_input->mpoly);
+}
+
+/**
+ * Take the previously evaluated mesh out of the object when its draw cache may be reused
+ * by the following evaluation, that is when the input mesh did not change and the modifier
+ * stack only deformed it (armatures, shape keys, lattices... animation playback).
+ *
+ * The caller is responsible for freeing the returned mesh.
+ */
+static Mesh *mesh_build_data_eval_prev_take(Object *ob,
+                                           const CustomData_MeshMasks *dataMask,
+                                           const bool need_mapping)
+{
+  Mesh *mesh_input = (Mesh *)ob->runtime.data_orig;
+  Mesh *mesh_eval_prev = (Mesh *)ob->runtime.data_eval;
+  if (mesh_input == NULL || mesh_eval_prev == NULL || !ob->runtime.is_data_eval_owned) {
+    return NULL;
+  }
+  if (GS(mesh_eval_prev->id.name) != ID_ME || mesh_eval_prev->runtime.batch_cache == NULL) {
+    return NULL;
+  }
+  /* Painting and sculpting modify mesh data without new copy-on-write updates. */
+  if (ob->mode & (OB_MODE_ALL_SCULPT | OB_MODE_ALL_PAINT | OB_MODE_EDIT)) {
+    return NULL;
+  }
+  /* The input mesh was copied again: anything may have changed. */
+  if (mesh_input->id.recalc & ID_RECALC_COPY_ON_WRITE) {
+    return NULL;
+  }
+  if ((memcmp(&ob->runtime.last_data_mask, dataMask, sizeof(*dataMask)) != 0) ||
+      (ob->runtime.last_need_mapping != need_mapping)) {
+    return NULL;
+  }
+  if (!mesh_eval_is_deformed_input(mesh_eval_prev, mesh_input)) {
+    return NULL;
+  }
+  ob->runtime.data_eval = NULL;
+  ob->runtime.is_data_eval_owned = false;
+  return mesh_eval_prev;
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1766,6 +1818,9 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  Mesh *mesh_eval_prev = mesh_build_data_eval_prev_take(ob, dataMask, need_mapping);
+  ob->runtime.is_data_eval_deform_update = false;
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1803,6 +1858,18 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (mesh_eval_prev != NULL) {
+    /* Only vertex positions changed, keep the draw data depending on topology and attributes.
+     * See #BKE_MESH_BATCH_DIRTY_DEFORM. */
+    if (is_mesh_eval_owned && (mesh_eval->runtime.batch_cache == NULL) &&
+        mesh_eval_is_deformed_input(mesh_eval, mesh)) {
+      mesh_eval->runtime.batch_cache = mesh_eval_prev->runtime.batch_cache;
+      mesh_eval_prev->runtime.batch_cache = NULL;
+      ob->runtime.is_data_eval_deform_update = true;
+    }
+    BKE_mesh_eval_delete(mesh_eval_prev);
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
@@ -29,6 +29,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 
 #include "BKE_DerivedMesh.h"
 #include "BKE_editmesh.h"
@@ -39,11 +40,45 @@
 #include "BKE_mesh_wrapper.h"
 #include "BKE_object.h"
 
+/**
+ * Mesh converted from #BMEditMesh.bm for the modifier stack, kept around while
+ * edits only move vertices so following conversions only have to refresh coordinates.
+ *
+ * Owned by the original edit-mesh, copies made for evaluation share it.
+ */
+typedef struct EditMeshEvalCache {
+  ThreadMutex mutex;
+  /** NULL when the next conversion has to be done from scratch. */
+  Mesh *mesh;
+  CustomData_MeshMasks cd_mask;
+  /** Set while edits are known to change vertex coordinates only. */
+  bool use_coords_only;
+  /** Set once the edit-mesh was evaluated with #use_coords_only set. */
+  bool use_coords_only_evaluated;
+} EditMeshEvalCache;
+
+static EditMeshEvalCache *editmesh_eval_cache_create(void)
+{
+  EditMeshEvalCache *cache = MEM_callocN(sizeof(EditMeshEvalCache), __func__);
+  BLI_mutex_init(&cache->mutex);
+  return cache;
+}
+
+static void editmesh_eval_cache_free(EditMeshEvalCache *cache)
+{
+  if (cache->mesh) {
+    BKE_id_free(NULL, cache->mesh);
+  }
+  BLI_mutex_end(&cache->mutex);
+  MEM_freeN(cache);
+}
+
 BMEditMesh *BKE_editmesh_create(BMesh *bm, const bool do_tessellate)
 {
   BMEditMesh *em = MEM_callocN(sizeof(BMEditMesh), __func__);
 
   em->bm = bm;
+  em->eval_cache = editmesh_eval_cache_create();
   if (do_tessellate) {
     BKE_editmesh_looptri_calc(em);
   }
@@ -60,6 +95,7 @@ BMEditMesh *BKE_editmesh_copy(BMEditMesh *em)
   em_copy->bb_cage = NULL;
 
   em_copy->bm = BM_mesh_copy(em->bm);
+  em_copy->eval_cache = editmesh_eval_cache_create();
 
   /* The tessellation is NOT calculated on the copy here,
    * because currently all the callers of this function use
@@ -173,6 +209,164 @@ void BKE_editmesh_free(BMEditMesh *em)
   if (em->bm) {
     BM_mesh_free(em->bm);
   }
+
+  if (em->eval_cache) {
+    editmesh_eval_cache_free(em->eval_cache);
+  }
+}
+
+/**
+ * End coordinate-only updates started with #BKE_editmesh_eval_cache_tag_coords,
+ * the next conversion starts from scratch.
+ *
+ * The converted mesh is only freed by that conversion: evaluated meshes reference its layers
+ * and may still be used until the edit-mesh is evaluated again.
+ */
+void BKE_editmesh_eval_cache_clear(BMEditMesh *em)
+{
+  EditMeshEvalCache *cache = em->eval_cache;
+  if (cache == NULL) {
+    return;
+  }
+  BLI_mutex_lock(&cache->mutex);
+  cache->use_coords_only = false;
+  cache->use_coords_only_evaluated = false;
+  BLI_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * Declare that until #BKE_editmesh_eval_cache_clear is called, edits only change vertex
+ * coordinates (and so vertex normals). Conversions for evaluation then reuse the previously
+ * converted mesh, only refreshing its vertices.
+ *
+ * \note The caller is responsible for the mesh not being changed in any other way meanwhile,
+ * typically this is used by interactive transform.
+ */
+void BKE_editmesh_eval_cache_tag_coords(BMEditMesh *em)
+{
+  EditMeshEvalCache *cache = em->eval_cache;
+  if (cache == NULL) {
+    return;
+  }
+  /* Conversions read the element tables from evaluation threads, build them here. */
+  BM_mesh_elem_table_ensure(em->bm, BM_VERT | BM_EDGE | BM_FACE);
+  BLI_mutex_lock(&cache->mutex);
+  cache->use_coords_only = true;
+  BLI_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * Call once per evaluation of the edit-mesh, check if only vertex coordinates changed
+ * since the previous evaluation, so data derived from the topology can be kept.
+ *
+ * The first evaluation after #BKE_editmesh_eval_cache_tag_coords always returns false,
+ * it may include other changes made before coordinate-only updates were tagged.
+ */
+bool BKE_editmesh_eval_cache_step_is_coords_only(BMEditMesh *em)
+{
+  EditMeshEvalCache *cache = em->eval_cache;
+  if (cache == NULL) {
+    return false;
+  }
+  BLI_mutex_lock(&cache->mutex);
+  const bool is_coords_only = cache->use_coords_only && cache->use_coords_only_evaluated;
+  cache->use_coords_only_evaluated = cache->use_coords_only;
+  BLI_mutex_unlock(&cache->mutex);
+  return is_coords_only;
+}
+
+static bool editmesh_eval_cache_is_valid(const EditMeshEvalCache *cache,
+                                         const BMesh *bm,
+                                         const CustomData_MeshMasks *cd_mask_extra)
+{
+  const Mesh *me = cache->mesh;
+  return (me != NULL) && (me->totvert == bm->totvert) && (me->totedge == bm->totedge) &&
+         (me->totloop == bm->totloop) && (me->totpoly == bm->totface) &&
+         (memcmp(&cache->cd_mask, cd_mask_extra, sizeof(*cd_mask_extra)) == 0);
+}
+
+/**
+ * Fill the empty mesh \a me from the edit-mesh for evaluation, see #BM_mesh_bm_to_me_for_eval.
+ *
+ * While coordinate-only updates are tagged the conversion is cached on the edit-mesh. Following
+ * updates reference the layers of the cached mesh, only the vertices are copied and refreshed.
+ * Modifiers writing other layers in place duplicate them first, as for any referenced layer.
+ *
+ * Called from evaluation threads, the cage and the final mesh may be filled concurrently from
+ * the same edit-mesh. The element tables are expected to be built on the main thread already
+ * (see #EDBM_update_generic and #BKE_editmesh_eval_cache_tag_coords), edits which didn't do
+ * so get them built here, once, under the lock.
+ */
+void BKE_editmesh_mesh_for_eval_fill(BMEditMesh *em,
+                                     Mesh *me,
+                                     const CustomData_MeshMasks *cd_mask_extra)
+{
+  EditMeshEvalCache *cache = em->eval_cache;
+  if (cache == NULL) {
+    BM_mesh_bm_to_me_for_eval(em->bm, me, cd_mask_extra);
+    return;
+  }
+
+  BLI_mutex_lock(&cache->mutex);
+
+  BM_mesh_elem_table_ensure(em->bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  if (!cache->use_coords_only) {
+    /* Any kind of change may have happened, don't hold on to memory that can't be reused. */
+    if (cache->mesh) {
+      BKE_id_free(NULL, cache->mesh);
+      cache->mesh = NULL;
+    }
+    BLI_mutex_unlock(&cache->mutex);
+    BM_mesh_bm_to_me_for_eval(em->bm, me, cd_mask_extra);
+    return;
+  }
+
+  if (cache->mesh == NULL) {
+    /* Convert outside of the lock, the conversion is threaded itself. */
+    BLI_mutex_unlock(&cache->mutex);
+    Mesh *me_cache = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+    BM_mesh_bm_to_me_for_eval(em->bm, me_cache, cd_mask_extra);
+    BLI_mutex_lock(&cache->mutex);
+
+    if (cache->mesh == NULL) {
+      cache->mesh = me_cache;
+      cache->cd_mask = *cd_mask_extra;
+    }
+    else {
+      /* Filled concurrently for another mesh. */
+      BKE_id_free(NULL, me_cache);
+    }
+  }
+
+  if (!editmesh_eval_cache_is_valid(cache, em->bm, cd_mask_extra)) {
+    /* Typically the cage and the final mesh requesting different layers. Don't replace the
+     * cached mesh, meshes evaluated before may reference it. */
+    BLI_mutex_unlock(&cache->mutex);
+    BM_mesh_bm_to_me_for_eval(em->bm, me, cd_mask_extra);
+    return;
+  }
+
+  /* The cached mesh isn't modified until it's freed, by the first conversion after coordinate-only
+   * updates ended. */
+  const Mesh *me_cache = cache->mesh;
+  me->totvert = me_cache->totvert;
+  me->totedge = me_cache->totedge;
+  me->totface = 0;
+  me->totloop = me_cache->totloop;
+  me->totpoly = me_cache->totpoly;
+  CustomData_copy(&me_cache->vdata, &me->vdata, CD_MASK_ALL, CD_REFERENCE, me->totvert);
+  CustomData_copy(&me_cache->edata, &me->edata, CD_MASK_ALL, CD_REFERENCE, me->totedge);
+  CustomData_copy(&me_cache->ldata, &me->ldata, CD_MASK_ALL, CD_REFERENCE, me->totloop);
+  CustomData_copy(&me_cache->pdata, &me->pdata, CD_MASK_ALL, CD_REFERENCE, me->totpoly);
+  CustomData_duplicate_referenced_layer(&me->vdata, CD_MVERT, me->totvert);
+  BKE_mesh_update_customdata_pointers(me, false);
+  me->cd_flag = me_cache->cd_flag;
+  me->runtime.deformed_only = true;
+
+  BLI_mutex_unlock(&cache->mutex);
+
+  BM_mesh_bm_to_me_for_eval_vert_coords(em->bm, me);
 }
 
 struct CageUserData {
@@ -37,6 +37,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -135,6 +137,7 @@ static void image_copy_data(Main *UNUSED(bmain), ID *id_dst, const ID *id_src, c
   /* Cleanup stuff that cannot be copied. */
   image_dst->cache = NULL;
   image_dst->rr = NULL;
+  image_dst->content_version = 0;
 
   BLI_duplicatelist(&image_dst->renderslots, &image_src->renderslots);
   LISTBASE_FOREACH (RenderSlot *, slot, &image_dst->renderslots) {
@@ -250,6 +253,15 @@ static void image_add_view(Image *ima, const char *viewname, const char *filepat
 #  define IMA_INDEX_PASS(index) (index & ~1023)
 #endif
 
+/* Last value handed out by #BKE_image_content_version. */
+static int image_content_version_last = 0;
+
+/* Pixels of the image may have changed, a new content version is assigned on demand. */
+static void image_tag_content_changed(Image *image)
+{
+  image->content_version = 0;
+}
+
 /* ******** IMAGE CACHE ************* */
 
 typedef struct ImageCacheKey {
@@ -303,6 +315,8 @@ static void imagecache_remove(Image *image, int index)
     return;
   }
 
+  image_tag_content_changed(image);
+
   ImageCacheKey key;
   key.index = index;
   IMB_moviecache_remove(image->cache, &key);
@@ -337,6 +351,7 @@ static void image_free_cached_frames(Image *image)
     IMB_moviecache_free(image->cache);
     image->cache = NULL;
   }
+  image_tag_content_changed(image);
 }
 
 static void image_free_packedfiles(Image *ima)
@@ -5555,9 +5570,27 @@ bool BKE_image_is_dirty(Image *image)
   return BKE_image_is_dirty_writable(image, NULL);
 }
 
-void BKE_image_mark_dirty(Image *UNUSED(image), ImBuf *ibuf)
+void BKE_image_mark_dirty(Image *image, ImBuf *ibuf)
 {
   ibuf->userflags |= IB_BITMAPDIRTY;
+  image_tag_content_changed(image);
+}
+
+/**
+ * Value identifying the pixels of the image, unique across all images. It changes whenever
+ * buffers are freed (reload, source changes...) or marked dirty, so caches of data derived
+ * from the pixels can compare it instead of the pixels themselves.
+ */
+int BKE_image_content_version(Image *image)
+{
+  int version = image->content_version;
+  if (version == 0) {
+    version = atomic_add_and_fetch_int32(&image_content_version_last, 1);
+    if (atomic_cas_int32(&image->content_version, 0, version) != 0) {
+      version = image->content_version;
+    }
+  }
+  return version;
 }
 
 bool BKE_image_buffer_format_writable(ImBuf *ibuf)
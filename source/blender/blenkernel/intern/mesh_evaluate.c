@@ -565,6 +565,16 @@ MLoopNorSpace *BKE_lnor_space_create(MLoopNorSpaceArray *lnors_spacearr)
   return BLI_memarena_calloc(lnors_spacearr->mem, sizeof(MLoopNorSpace));
 }
 
+/**
+ * Allocate \a spaces_len zero-initialized spaces as a single contiguous block.
+ * Unlike #BKE_lnor_space_create, filling them can then be done from multiple threads.
+ */
+MLoopNorSpace *BKE_lnor_spaces_create(MLoopNorSpaceArray *lnors_spacearr, const int spaces_len)
+{
+  lnors_spacearr->num_spaces += spaces_len;
+  return BLI_memarena_calloc(lnors_spacearr->mem, sizeof(MLoopNorSpace) * (size_t)spaces_len);
+}
+
 /* This threshold is a bit touchy (usual float precision issue), this value seems OK. */
 #define LNOR_SPACE_TRIGO_THRESHOLD (1.0f - 1e-4f)
 
@@ -777,9 +787,8 @@ void BKE_lnor_space_custom_normal_to_data(MLoopNorSpace *lnor_space,
 #define LOOP_SPLIT_TASK_BLOCK_SIZE 1024
 
 typedef struct LoopSplitTaskData {
-  /* Specific to each instance (each task). */
+  /* Specific to each smooth fan (or single loop), built on the fly by the workers. */
 
-  /** We have to create those outside of tasks, since afaik memarena is not threadsafe. */
   MLoopNorSpace *lnor_space;
   float (*lnor)[3];
   const MLoop *ml_curr;
@@ -790,11 +799,9 @@ typedef struct LoopSplitTaskData {
   const int *e2l_prev;
   int mp_index;
 
-  /** This one is special, it's owned and managed by worker tasks,
+  /** This one is special, it's owned and managed by the thread-local data of the workers,
    * avoid to have to create it for each fan! */
   BLI_Stack *edge_vectors;
-
-  char pad_c;
 } LoopSplitTaskData;
 
 typedef struct LoopSplitTaskDataCommon {
@@ -817,120 +824,183 @@ typedef struct LoopSplitTaskDataCommon {
   int numEdges;
   int numLoops;
   int numPolys;
+
+  /* Only used while tagging sharp edges. */
+  int *edge_loops_len;
+  float split_angle_cos;
+  bool check_angle;
+  bool do_sharp_edges_tag;
+
+  /* For every loop, the first loop (in polygons order) a cyclic fan walk going through it was
+   * started from, -1 when no walk went through it yet. */
+  int *loop_fan_walks;
+
+  /* Only used when generating lnor spaces, which have to be allocated once all fans are known. */
+  char *loop_fan_types;
+  int *fan_loops;
+  MLoopNorSpace *fan_spaces;
 } LoopSplitTaskDataCommon;
 
+/** #LoopSplitTaskDataCommon.loop_fan_types */
+enum {
+  LOOP_SPLIT_FAN_NONE = 0,
+  /** Both edges of the loop are sharp, it just takes its poly normal. */
+  LOOP_SPLIT_FAN_SINGLE = 1,
+  /** The loop is the entry point of a smooth fan. */
+  LOOP_SPLIT_FAN_SMOOTH = 2,
+};
+
+/* Thread-local data of the loop split workers. */
+typedef struct LoopSplitTLS {
+  /** Temp edge vectors stack, only used when computing lnor spacearr, created on first use. */
+  BLI_Stack *edge_vectors;
+} LoopSplitTLS;
+
 #define INDEX_UNSET INT_MIN
 #define INDEX_INVALID -1
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
-static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
-                                 const bool check_angle,
-                                 const float split_angle,
-                                 const bool do_sharp_edges_tag)
+/**
+ * Whether loop \a l_a is reached before loop \a l_b when iterating over polygons in order.
+ * Since loops are not handled in that order anymore when multi-threading,
+ * this is used to keep the same edges sharpness and smooth fans entry points in all cases.
+ */
+BLI_INLINE bool loop_split_loop_is_before(const int *loop_to_poly, const int l_a, const int l_b)
 {
+  const int mp_a = loop_to_poly[l_a];
+  const int mp_b = loop_to_poly[l_b];
+  return (mp_a < mp_b) || (mp_a == mp_b && l_a < l_b);
+}
+
+static void mesh_edges_sharp_tag_poly_cb(void *__restrict userdata,
+                                         const int mp_index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
   const MVert *mverts = data->mverts;
-  const MEdge *medges = data->medges;
   const MLoop *mloops = data->mloops;
 
-  const MPoly *mpolys = data->mpolys;
-
-  const int numEdges = data->numEdges;
-  const int numPolys = data->numPolys;
-
   float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
-  const float(*polynors)[3] = data->polynors;
 
   int(*edge_to_loops)[2] = data->edge_to_loops;
+  int *edge_loops_len = data->edge_loops_len;
   int *loop_to_poly = data->loop_to_poly;
 
-  BLI_bitmap *sharp_edges = do_sharp_edges_tag ? BLI_BITMAP_NEW(numEdges, __func__) : NULL;
+  const MPoly *mp = &data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+  const MLoop *ml_curr = &mloops[ml_curr_index];
 
-  const MPoly *mp;
-  int mp_index;
+  for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
+    loop_to_poly[ml_curr_index] = mp_index;
 
-  const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    if (loopnors) {
+      normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
+    }
 
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    const MLoop *ml_curr;
-    int *e2l;
-    int ml_curr_index = mp->loopstart;
-    const int ml_last_index = (ml_curr_index + mp->totloop) - 1;
+    /* Only the first two loops using an edge matter for its sharpness,
+     * any other one makes it non-manifold, hence sharp anyway. */
+    const int e2l_index = atomic_fetch_and_add_int32(&edge_loops_len[ml_curr->e], 1);
+    if (e2l_index < 2) {
+      edge_to_loops[ml_curr->e][e2l_index] = ml_curr_index;
+    }
+  }
+}
 
-    ml_curr = &mloops[ml_curr_index];
+static void mesh_edges_sharp_tag_edge_cb(void *__restrict userdata,
+                                         const int me_index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MLoop *mloops = data->mloops;
+  const MPoly *mpolys = data->mpolys;
+  const int *loop_to_poly = data->loop_to_poly;
+  const float(*polynors)[3] = data->polynors;
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
-      e2l = edge_to_loops[ml_curr->e];
+  MEdge *me = (MEdge *)&data->medges[me_index];
+  int *e2l = data->edge_to_loops[me_index];
+  const int e2l_len = data->edge_loops_len[me_index];
 
-      loop_to_poly[ml_curr_index] = mp_index;
+  if (e2l_len == 0) {
+    /* Loose edge, both values stay at 0. */
+    return;
+  }
+  if (e2l_len == 1) {
+    /* Set e2l[1] to INDEX_UNSET to tag it as unset,
+     * we have to check this here too, else we might miss some flat faces!!! */
+    e2l[1] = (mpolys[loop_to_poly[e2l[0]]].flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
+    return;
+  }
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
+  /* Loops are gathered in any order when multi-threading. */
+  if (loop_split_loop_is_before(loop_to_poly, e2l[1], e2l[0])) {
+    SWAP(int, e2l[0], e2l[1]);
+  }
 
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = ml_curr_index;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = (mp->flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
-      }
-      else if (e2l[1] == INDEX_UNSET) {
-        const bool is_angle_sharp = (check_angle &&
-                                     dot_v3v3(polynors[loop_to_poly[e2l[0]]], polynors[mp_index]) <
-                                         split_angle_cos);
-
-        /* Second loop using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
-         * same vertex, or angle between both its polys' normals is above split_angle value.
-         */
-        if (!(mp->flag & ME_SMOOTH) || (medges[ml_curr->e].flag & ME_SHARP) ||
-            ml_curr->v == mloops[e2l[0]].v || is_angle_sharp) {
-          /* Note: we are sure that loop != 0 here ;) */
-          e2l[1] = INDEX_INVALID;
-
-          /* We want to avoid tagging edges as sharp when it is already defined as such by
-           * other causes than angle threshold... */
-          if (do_sharp_edges_tag && is_angle_sharp) {
-            BLI_BITMAP_SET(sharp_edges, ml_curr->e, true);
-          }
-        }
-        else {
-          e2l[1] = ml_curr_index;
-        }
-      }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two loops using this edge, tag as sharp if not yet done. */
-        e2l[1] = INDEX_INVALID;
-
-        /* We want to avoid tagging edges as sharp when it is already defined as such by
-         * other causes than angle threshold... */
-        if (do_sharp_edges_tag) {
-          BLI_BITMAP_SET(sharp_edges, ml_curr->e, false);
-        }
-      }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
-    }
+  const int mp_index_first = loop_to_poly[e2l[0]];
+  const int mp_index_second = loop_to_poly[e2l[1]];
+
+  if (!(mpolys[mp_index_first].flag & ME_SMOOTH)) {
+    e2l[1] = INDEX_INVALID;
+    return;
   }
 
-  /* If requested, do actual tagging of edges as sharp in another loop. */
-  if (do_sharp_edges_tag) {
-    MEdge *me;
-    int me_index;
-    for (me = (MEdge *)medges, me_index = 0; me_index < numEdges; me++, me_index++) {
-      if (BLI_BITMAP_TEST(sharp_edges, me_index)) {
-        me->flag |= ME_SHARP;
-      }
-    }
+  const bool is_angle_sharp = (data->check_angle &&
+                               dot_v3v3(polynors[mp_index_first], polynors[mp_index_second]) <
+                                   data->split_angle_cos);
 
-    MEM_freeN(sharp_edges);
+  /* An edge is sharp if it is tagged as such, or its face is not smooth,
+   * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
+   * same vertex, or angle between both its polys' normals is above split_angle value.
+   */
+  if (!(mpolys[mp_index_second].flag & ME_SMOOTH) || (me->flag & ME_SHARP) ||
+      mloops[e2l[1]].v == mloops[e2l[0]].v || is_angle_sharp) {
+    e2l[1] = INDEX_INVALID;
+
+    /* We want to avoid tagging edges as sharp when it is already defined as such by
+     * other causes than angle threshold... */
+    if (data->do_sharp_edges_tag && is_angle_sharp) {
+      me->flag |= ME_SHARP;
+    }
+  }
+  else if (e2l_len > 2) {
+    /* More than two loops using this edge, tag as sharp. */
+    e2l[1] = INDEX_INVALID;
   }
 }
 
+static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
+                                 const bool check_angle,
+                                 const float split_angle,
+                                 const bool do_sharp_edges_tag)
+{
+  data->edge_loops_len = MEM_calloc_arrayN(
+      (size_t)data->numEdges, sizeof(*data->edge_loops_len), __func__);
+  data->check_angle = check_angle;
+  data->split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
+  data->do_sharp_edges_tag = do_sharp_edges_tag;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
+
+  /* Angle tagging of non-manifold edges depends on which two loops come first,
+   * keep the loops in order in that (rarely used) case. */
+  settings.use_threading = (data->numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8) &&
+                           !do_sharp_edges_tag;
+  BLI_task_parallel_range(0, data->numPolys, data, mesh_edges_sharp_tag_poly_cb, &settings);
+
+  settings.use_threading = (data->numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  BLI_task_parallel_range(0, data->numEdges, data, mesh_edges_sharp_tag_edge_cb, &settings);
+
+  MEM_freeN(data->edge_loops_len);
+  data->edge_loops_len = NULL;
+}
+
 /**
  * Define sharp edges as needed to mimic 'autosmooth' from angle threshold.
  *
@@ -968,6 +1038,7 @@ void BKE_edges_sharp_from_angle_set(const struct MVert *mverts,
       .loop_to_poly = loop_to_poly,
       .polynors = polynors,
       .numEdges = numEdges,
+      .numLoops = numLoops,
       .numPolys = numPolys,
   };
 
@@ -1301,69 +1372,78 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
 }
 
 static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
-                                 LoopSplitTaskData *data,
+                                 const char fan_type,
+                                 MLoopNorSpace *lnor_space,
+                                 const int ml_curr_index,
+                                 const int ml_prev_index,
+                                 const int mp_index,
                                  BLI_Stack *edge_vectors)
 {
-  BLI_assert(data->ml_curr);
-  if (data->e2l_prev) {
+  const MLoop *mloops = common_data->mloops;
+
+  LoopSplitTaskData data = {
+      .lnor_space = lnor_space,
+      .ml_curr = &mloops[ml_curr_index],
+      .ml_prev = &mloops[ml_prev_index],
+      .ml_curr_index = ml_curr_index,
+      .ml_prev_index = ml_prev_index,
+      .mp_index = mp_index,
+  };
+
+  if (fan_type == LOOP_SPLIT_FAN_SMOOTH) {
     BLI_assert((edge_vectors == NULL) || BLI_stack_is_empty(edge_vectors));
-    data->edge_vectors = edge_vectors;
-    split_loop_nor_fan_do(common_data, data);
+    data.e2l_prev = common_data->edge_to_loops[data.ml_prev->e];
+    data.edge_vectors = edge_vectors;
+    split_loop_nor_fan_do(common_data, &data);
   }
   else {
     /* No need for edge_vectors for 'single' case! */
-    split_loop_nor_single_do(common_data, data);
+    data.lnor = &common_data->loopnors[ml_curr_index];
+    split_loop_nor_single_do(common_data, &data);
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
+/**
+ * Mark loop \a ml_index as walked through from \a ml_start.
+ * \return false when a walk started from a loop before \a ml_start already went through it,
+ * meaning that loop is part of the same fan.
+ */
+static bool loop_split_fan_walk_mark(const int *loop_to_poly,
+                                     int *loop_fan_walks,
+                                     const int ml_index,
+                                     const int ml_start)
 {
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
-
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
+  int walk = loop_fan_walks[ml_index];
+  while (walk == -1 || loop_split_loop_is_before(loop_to_poly, ml_start, walk)) {
+    const int walk_prev = atomic_cas_int32(&loop_fan_walks[ml_index], walk, ml_start);
+    if (walk_prev == walk) {
+      return true;
     }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+    walk = walk_prev;
   }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
+  return walk == ml_start;
 }
 
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
+ * Check whether given loop is the entry point of a cyclic smooth fan, or not.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ * The first loop of the fan (in polygons order) is used, this way all loops can be checked
+ * independently from each other. Walked loops are marked with the loop the walk started from,
+ * so walks from later loops of the same fan stop as soon as they reach them.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_check_cyclic_smooth_fan(const MLoop *mloops,
+                                               const MPoly *mpolys,
+                                               const int (*edge_to_loops)[2],
+                                               const int *loop_to_poly,
+                                               int *loop_fan_walks,
+                                               const int *e2l_prev,
+                                               const MLoop *ml_curr,
+                                               const MLoop *ml_prev,
+                                               const int ml_curr_index,
+                                               const int ml_prev_index,
+                                               const int mp_curr_index,
+                                               const int numLoops)
 {
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
@@ -1386,10 +1466,13 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+  if (!loop_split_fan_walk_mark(loop_to_poly, loop_fan_walks, ml_curr_index, ml_curr_index)) {
+    /* Already walked through from a loop before this one. */
+    return false;
+  }
 
-  while (true) {
+  /* Bounded, so that invalid topology never walking back to the initial loop can't hang. */
+  for (int i = 0; i < numLoops; i++) {
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
@@ -1408,192 +1491,216 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
       return false;
     }
     /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan without finding any loop before this one,
+       * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
+      return true;
+    }
+    if (loop_split_loop_is_before(loop_to_poly, mlfan_vert_index, ml_curr_index)) {
+      /* ... that loop is the entry point of this fan, we can abort. */
+      return false;
+    }
+    if (!loop_split_fan_walk_mark(
+            loop_to_poly, loop_fan_walks, mlfan_vert_index, ml_curr_index)) {
+      /* ... a walk from a loop before this one went through it, same conclusion. */
       return false;
     }
-
-    /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
   }
+  return false;
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+static char loop_split_fan_type_get(const LoopSplitTaskDataCommon *common_data,
+                                    const int ml_curr_index,
+                                    const int ml_prev_index,
+                                    const int mp_index)
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
-
   const MLoop *mloops = common_data->mloops;
-  const MPoly *mpolys = common_data->mpolys;
-  const int *loop_to_poly = common_data->loop_to_poly;
   const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
 
-  const MPoly *mp;
-  int mp_index;
+  const MLoop *ml_curr = &mloops[ml_curr_index];
+  const MLoop *ml_prev = &mloops[ml_prev_index];
+  const int *e2l_curr = edge_to_loops[ml_curr->e];
+  const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+  if (IS_EDGE_SHARP(e2l_curr)) {
+    /* We *do not need* to check/tag loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding).
+     */
+    return IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_FAN_SINGLE : LOOP_SPLIT_FAN_SMOOTH;
+  }
+
+  /* A smooth edge, we have to check for cyclic smooth fan case.
+   * If this loop is the entry point of a cyclic smooth fan, we can do it now,
+   * otherwise we can skip it. */
+
+  /* Note: In theory, we could make loop_split_check_cyclic_smooth_fan() store
+   * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
+   * the vert during actual computation of clnor & clnorspace. However, this would complicate
+   * the code, add more memory usage, and despite its logical complexity,
+   * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
+   * so really think it's not worth it. */
+  if (loop_split_check_cyclic_smooth_fan(mloops,
+                                         common_data->mpolys,
+                                         edge_to_loops,
+                                         common_data->loop_to_poly,
+                                         common_data->loop_fan_walks,
+                                         e2l_prev,
+                                         ml_curr,
+                                         ml_prev,
+                                         ml_curr_index,
+                                         ml_prev_index,
+                                         mp_index,
+                                         common_data->numLoops)) {
+    return LOOP_SPLIT_FAN_SMOOTH;
+  }
+  return LOOP_SPLIT_FAN_NONE;
+}
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+static void loop_split_poly_cb(void *__restrict userdata,
+                               const int mp_index,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  char *loop_fan_types = common_data->loop_fan_types;
+
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+  int ml_prev_index = ml_last_index;
+
+  for (; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const char fan_type = loop_split_fan_type_get(
+        common_data, ml_curr_index, ml_prev_index, mp_index);
+
+    if (loop_fan_types) {
+      /* Fans are computed later, once their lnor spaces are allocated. */
+      loop_fan_types[ml_curr_index] = fan_type;
+    }
+    else if (fan_type != LOOP_SPLIT_FAN_NONE) {
+      loop_split_worker_do(
+          common_data, fan_type, NULL, ml_curr_index, ml_prev_index, mp_index, NULL);
+    }
+
+    ml_prev_index = ml_curr_index;
+  }
+}
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+static void loop_split_fan_cb(void *__restrict userdata,
+                              const int fan_index,
+                              const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  LoopSplitTLS *tls_data = tls->userdata_chunk;
+
+  const int ml_curr_index = common_data->fan_loops[fan_index];
+  const int mp_index = common_data->loop_to_poly[ml_curr_index];
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_prev_index = (ml_curr_index == mp->loopstart) ?
+                                (mp->loopstart + mp->totloop) - 1 :
+                                ml_curr_index - 1;
+
+  if (tls_data->edge_vectors == NULL) {
+    tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+  }
+
+  loop_split_worker_do(common_data,
+                       common_data->loop_fan_types[ml_curr_index],
+                       &common_data->fan_spaces[fan_index],
+                       ml_curr_index,
+                       ml_prev_index,
+                       mp_index,
+                       tls_data->edge_vectors);
+}
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+static void loop_split_fan_free(const void *__restrict UNUSED(userdata), void *__restrict chunk)
+{
+  LoopSplitTLS *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+  }
+}
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+static void loop_split_generator(LoopSplitTaskDataCommon *common_data)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+
+  const MPoly *mpolys = common_data->mpolys;
+  const int numLoops = common_data->numLoops;
+  const int numPolys = common_data->numPolys;
 
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(loop_split_generator);
 #endif
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
-    }
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Not enough loops to be worth the whole threading overhead... */
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
 
   /* We now know edges that can be smoothed (with their vector, and their two loops),
    * and edges that will be hard! Now, time to generate the normals.
+   * Without lnor spaces, each fan is computed as soon as its entry point is found.
    */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
-
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
-
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
-
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+  common_data->loop_fan_walks = MEM_malloc_arrayN(
+      (size_t)numLoops, sizeof(*common_data->loop_fan_walks), __func__);
+  copy_vn_i(common_data->loop_fan_walks, numLoops, -1);
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
+  if (lnors_spacearr == NULL) {
+    BLI_task_parallel_range(0, numPolys, common_data, loop_split_poly_cb, &settings);
+  }
+  else {
+    common_data->loop_fan_types = MEM_malloc_arrayN(
+        (size_t)numLoops, sizeof(*common_data->loop_fan_types), __func__);
+    BLI_task_parallel_range(0, numPolys, common_data, loop_split_poly_cb, &settings);
+
+    int fans_len = 0;
+    for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+      if (common_data->loop_fan_types[ml_index] != LOOP_SPLIT_FAN_NONE) {
+        fans_len++;
       }
-      else {
-        LoopSplitTaskData *data, data_local;
-
-        //              printf("PROCESSING!\n");
+    }
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
+    if (fans_len != 0) {
+      /* Gather fans entry points in polygons order, their lnor spaces are allocated at once. */
+      int *fan_loops = MEM_malloc_arrayN((size_t)fans_len, sizeof(*fan_loops), __func__);
+      int fan_index = 0;
+      for (int mp_index = 0; mp_index < numPolys; mp_index++) {
+        const MPoly *mp = &mpolys[mp_index];
+        for (int ml_index = mp->loopstart; ml_index < mp->loopstart + mp->totloop; ml_index++) {
+          if (common_data->loop_fan_types[ml_index] != LOOP_SPLIT_FAN_NONE) {
+            fan_loops[fan_index++] = ml_index;
           }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
         }
+      }
+      BLI_assert(fan_index == fans_len);
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+      common_data->fan_loops = fan_loops;
+      common_data->fan_spaces = BKE_lnor_spaces_create(lnors_spacearr, fans_len);
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+      LoopSplitTLS tls_data = {NULL};
+      settings.userdata_chunk = &tls_data;
+      settings.userdata_chunk_size = sizeof(tls_data);
+      settings.func_free = loop_split_fan_free;
+      BLI_task_parallel_range(0, fans_len, common_data, loop_split_fan_cb, &settings);
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
+      MEM_freeN(fan_loops);
+      common_data->fan_loops = NULL;
+      common_data->fan_spaces = NULL;
     }
-  }
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+    MEM_freeN(common_data->loop_fan_types);
+    common_data->loop_fan_types = NULL;
   }
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-  MEM_freeN(skip_loops);
+  MEM_freeN(common_data->loop_fan_walks);
+  common_data->loop_fan_walks = NULL;
 
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(loop_split_generator);
@@ -1714,19 +1821,7 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
+  loop_split_generator(&common_data);
 
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
@@ -122,7 +122,7 @@ void BKE_mesh_wrapper_ensure_mdata(Mesh *me)
       BLI_assert(me->runtime.edit_data != NULL);
 
       BMEditMesh *em = me->edit_mesh;
-      BM_mesh_bm_to_me_for_eval(em->bm, me, &me->runtime.cd_mask_extra);
+      BKE_editmesh_mesh_for_eval_fill(em, me, &me->runtime.cd_mask_extra);
 
       EditMeshData *edit_data = me->runtime.edit_data;
       if (edit_data->vertexCos) {
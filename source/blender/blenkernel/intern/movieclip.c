@@ -74,6 +74,8 @@
 
 #include "GPU_texture.h"
 
+#include "PIL_time.h"
+
 #ifdef WITH_OPENEXR
 #  include "intern/openexr/openexr_multi.h"
 #endif
@@ -666,8 +668,13 @@ static bool has_imbuf_cache(MovieClip *clip, MovieClipUser *user, int flag)
   return false;
 }
 
-static bool put_imbuf_cache(
-    MovieClip *clip, const MovieClipUser *user, ImBuf *ibuf, int flag, bool destructive)
+/* Cost is the time in seconds it took to load the frame, zero when unknown. */
+static bool put_imbuf_cache(MovieClip *clip,
+                            const MovieClipUser *user,
+                            ImBuf *ibuf,
+                            int flag,
+                            float cost,
+                            bool destructive)
 {
   MovieClipImBufCacheKey key;
 
@@ -714,7 +721,7 @@ static bool put_imbuf_cache(
   }
 
   if (destructive) {
-    IMB_moviecache_put(clip->cache->moviecache, &key, ibuf);
+    IMB_moviecache_put_with_cost(clip->cache->moviecache, &key, ibuf, cost);
     return true;
   }
 
@@ -1097,6 +1104,7 @@ static ImBuf *movieclip_get_postprocessed_ibuf(
 
   if (!ibuf) {
     bool use_sequence = false;
+    const double start_time = PIL_check_seconds_timer();
 
     /* undistorted proxies for movies should be read as image sequence */
     use_sequence = (user->render_flag & MCLIP_PROXY_RENDER_UNDISTORT) &&
@@ -1110,7 +1118,8 @@ static ImBuf *movieclip_get_postprocessed_ibuf(
     }
 
     if (ibuf && (cache_flag & MOVIECLIP_CACHE_SKIP) == 0) {
-      put_imbuf_cache(clip, user, ibuf, flag, true);
+      const float cost = (float)(PIL_check_seconds_timer() - start_time);
+      put_imbuf_cache(clip, user, ibuf, flag, cost, true);
     }
   }
 
@@ -1790,7 +1799,7 @@ bool BKE_movieclip_put_frame_if_possible(MovieClip *clip, MovieClipUser *user, I
   bool result;
 
   BLI_thread_lock(LOCK_MOVIECLIP);
-  result = put_imbuf_cache(clip, user, ibuf, clip->flag, false);
+  result = put_imbuf_cache(clip, user, ibuf, clip->flag, 0.0f, false);
   BLI_thread_unlock(LOCK_MOVIECLIP);
 
   return result;
@@ -377,12 +377,47 @@ void BKE_object_batch_cache_dirty_tag(Object *ob)
   }
 }
 
+/**
+ * Check if the mesh evaluation only moved vertices since the previous evaluation,
+ * in which case draw buffers that only depend on topology can be kept.
+ */
+static bool object_eval_mesh_is_deform_only(Depsgraph *depsgraph, Object *ob)
+{
+  if (ob->type != OB_MESH) {
+    return false;
+  }
+  BMEditMesh *em = ((Mesh *)ob->data)->edit_mesh;
+  if (em == NULL) {
+    /* Set by the modifier stack evaluation, which kept the previous draw cache. */
+    const bool is_deform_update = ob->runtime.is_data_eval_deform_update;
+    ob->runtime.is_data_eval_deform_update = false;
+    return is_deform_update;
+  }
+  if (!DEG_is_active(depsgraph)) {
+    return false;
+  }
+  /* Always advance the coordinate-only state, even when it can't be used. */
+  if (!BKE_editmesh_eval_cache_step_is_coords_only(em)) {
+    return false;
+  }
+  /* Modifiers generating geometry may change topology when vertices move. */
+  const Mesh *me_final = em->mesh_eval_final;
+  const Mesh *me_cage = em->mesh_eval_cage;
+  return (me_final != NULL) && (me_final->runtime.wrapper_type == ME_WRAPPER_TYPE_BMESH) &&
+         ((me_cage == NULL) || (me_cage->runtime.wrapper_type == ME_WRAPPER_TYPE_BMESH));
+}
+
 void BKE_object_eval_uber_data(Depsgraph *depsgraph, Scene *scene, Object *ob)
 {
   DEG_debug_print_eval(depsgraph, __func__, ob->id.name, ob);
   BLI_assert(ob->type != OB_ARMATURE);
   BKE_object_handle_data_update(depsgraph, scene, ob);
-  BKE_object_batch_cache_dirty_tag(ob);
+  if (object_eval_mesh_is_deform_only(depsgraph, ob)) {
+    BKE_mesh_batch_cache_dirty_tag(ob->data, BKE_MESH_BATCH_DIRTY_DEFORM);
+  }
+  else {
+    BKE_object_batch_cache_dirty_tag(ob);
+  }
 }
 
 void BKE_object_eval_ptcache_reset(Depsgraph *depsgraph, Scene *scene, Object *object)
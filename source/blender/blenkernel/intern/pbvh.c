@@ -250,43 +250,23 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
   pbvh->totnode = totnode;
 }
 
-/* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+static int int_cmp(const void *a_v, const void *b_v)
 {
-  void *key, **value_p;
-
-  key = POINTER_FROM_INT(vertex);
-  if (!BLI_ghash_ensure_p(map, key, &value_p)) {
-    int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
-      value_i = *uniq_verts;
-      (*uniq_verts)++;
-    }
-    else {
-      value_i = ~(*face_verts);
-      (*face_verts)++;
-    }
-    *value_p = POINTER_FROM_INT(value_i);
-    return value_i;
-  }
-
-  return POINTER_AS_INT(*value_p);
+  const int a = *(const int *)a_v;
+  const int b = *(const int *)b_v;
+  return (a > b) - (a < b);
 }
 
-/* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+/* Find vertices used by the faces in this node and update the draw buffers.
+ *
+ * A vertex is unique to the first leaf using it (in the order leaves are created),
+ * \a vert_leaf stores the index of that leaf for each vertex. */
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, const int leaf, const int *vert_leaf)
 {
   bool has_visible = false;
 
-  node->uniq_verts = node->face_verts = 0;
   const int totface = node->totprim;
 
-  /* reserve size is rough guess */
-  GHash *map = BLI_ghash_int_new_ex("build_mesh_leaf_node gh", 2 * totface);
-
   int(*face_vert_indices)[3] = MEM_mallocN(sizeof(int[3]) * totface, "bvh node face vert indices");
 
   node->face_vert_indices = (const int(*)[3])face_vert_indices;
@@ -295,11 +275,12 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
     has_visible = true;
   }
 
+  /* Sorted, de-duplicated vertices of the node, used to look up their index in the node. */
+  int *verts = MEM_mallocN(sizeof(int) * totface * 3, __func__);
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      verts[i * 3 + j] = pbvh->mloop[lt->tri[j]].v;
     }
 
     if (has_visible == false) {
@@ -309,46 +290,122 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
     }
   }
 
-  int *vert_indices = MEM_callocN(sizeof(int) * (node->uniq_verts + node->face_verts),
-                                  "bvh node vert indices");
-  node->vert_indices = vert_indices;
-
-  /* Build the vertex list, unique verts first */
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, map) {
-    void *value = BLI_ghashIterator_getValue(&gh_iter);
-    int ndx = POINTER_AS_INT(value);
+  int verts_len = 0;
+  if (totface != 0) {
+    qsort(verts, totface * 3, sizeof(int), int_cmp);
+    verts_len = 1;
+    for (int i = 1; i < totface * 3; i++) {
+      if (verts[i] != verts[verts_len - 1]) {
+        verts[verts_len++] = verts[i];
+      }
+    }
+  }
 
-    if (ndx < 0) {
-      ndx = -ndx + node->uniq_verts - 1;
+  node->uniq_verts = node->face_verts = 0;
+  for (int i = 0; i < verts_len; i++) {
+    if (vert_leaf[verts[i]] == leaf) {
+      node->uniq_verts++;
     }
+  }
+  node->face_verts = verts_len - node->uniq_verts;
 
-    vert_indices[ndx] = POINTER_AS_INT(BLI_ghashIterator_getKey(&gh_iter));
+  /* Build the vertex list, unique verts first. */
+  int *vert_indices = MEM_mallocN(sizeof(int) * verts_len, "bvh node vert indices");
+  int *vert_local = MEM_mallocN(sizeof(int) * verts_len, __func__);
+  int uniq_index = 0, other_index = node->uniq_verts;
+  for (int i = 0; i < verts_len; i++) {
+    const int ndx = (vert_leaf[verts[i]] == leaf) ? uniq_index++ : other_index++;
+    vert_indices[ndx] = verts[i];
+    vert_local[i] = ndx;
   }
+  node->vert_indices = vert_indices;
 
   for (int i = 0; i < totface; i++) {
-    const int sides = 3;
-
-    for (int j = 0; j < sides; j++) {
-      if (face_vert_indices[i][j] < 0) {
-        face_vert_indices[i][j] = -face_vert_indices[i][j] + node->uniq_verts - 1;
-      }
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      const int v = pbvh->mloop[lt->tri[j]].v;
+      const int *v_sorted = bsearch(&v, verts, verts_len, sizeof(int), int_cmp);
+      face_vert_indices[i][j] = vert_local[v_sorted - verts];
     }
   }
 
+  MEM_freeN(vert_local);
+  MEM_freeN(verts);
+
   BKE_pbvh_node_mark_rebuild_draw(node);
 
   BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+}
+
+typedef struct PBVHBuildBounds {
+  BB vb;
+  BB cb;
+} PBVHBuildBounds;
+
+typedef struct PBVHBuildBoundsData {
+  const int *prim_indices;
+  const BBC *prim_bbc;
+  bool calc_cb;
+} PBVHBuildBoundsData;
 
-  BLI_ghash_free(map, NULL, NULL);
+static void build_bounds_cb(void *__restrict userdata,
+                            const int i,
+                            const TaskParallelTLS *__restrict tls)
+{
+  const PBVHBuildBoundsData *data = userdata;
+  PBVHBuildBounds *bounds = tls->userdata_chunk;
+  const BBC *bbc = &data->prim_bbc[data->prim_indices[i]];
+
+  BB_expand_with_bb(&bounds->vb, (BB *)bbc);
+  if (data->calc_cb) {
+    BB_expand(&bounds->cb, bbc->bcentroid);
+  }
 }
 
-static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
+static void build_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                void *__restrict chunk_join,
+                                void *__restrict chunk)
+{
+  PBVHBuildBounds *join = chunk_join;
+  PBVHBuildBounds *bounds = chunk;
+
+  BB_expand_with_bb(&join->vb, &bounds->vb);
+  BB_expand_with_bb(&join->cb, &bounds->cb);
+}
+
+/* Calculate the bounding box of a range of primitives and optionally of their centroids.
+ * Nodes near the root cover most primitives, so these are threaded. */
+static void build_bounds_calc(
+    PBVH *pbvh, BBC *prim_bbc, int offset, int count, BB *r_vb, BB *r_cb)
 {
-  BB_reset(&node->vb);
-  for (int i = offset + count - 1; i >= offset; i--) {
-    BB_expand_with_bb(&node->vb, (BB *)(&prim_bbc[pbvh->prim_indices[i]]));
+  PBVHBuildBoundsData data = {
+      .prim_indices = pbvh->prim_indices,
+      .prim_bbc = prim_bbc,
+      .calc_cb = (r_cb != NULL),
+  };
+
+  PBVHBuildBounds bounds;
+  BB_reset(&bounds.vb);
+  BB_reset(&bounds.cb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = count > pbvh->leaf_limit * 4;
+  settings.min_iter_per_thread = pbvh->leaf_limit;
+  settings.userdata_chunk = &bounds;
+  settings.userdata_chunk_size = sizeof(bounds);
+  settings.func_reduce = build_bounds_reduce;
+  BLI_task_parallel_range(offset, offset + count, &data, build_bounds_cb, &settings);
+
+  *r_vb = bounds.vb;
+  if (r_cb) {
+    *r_cb = bounds.cb;
   }
+}
+
+static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
+{
+  build_bounds_calc(pbvh, prim_bbc, offset, count, &node->vb, NULL);
   node->orig_vb = node->vb;
 }
 
@@ -423,12 +480,7 @@ static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, in
   /* Still need vb for searches */
   update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
 
-  if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-  else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
+  /* Vertices and visibility are filled in for all leaves at once, see #build_leaves. */
 }
 
 /* Return zero if all primitives in the node can be drawn with the
@@ -494,18 +546,19 @@ static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int off
   pbvh->nodes[node_index].children_offset = pbvh->totnode;
   pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
 
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
+  /* Update parent node bounding box, along with the centroid bounds when needed */
+  PBVHNode *node = &pbvh->nodes[node_index];
+  if (!below_leaf_limit && !cb) {
+    cb = &cb_backing;
+    build_bounds_calc(pbvh, prim_bbc, offset, count, &node->vb, cb);
+    node->orig_vb = node->vb;
+  }
+  else {
+    update_vb(pbvh, node, prim_bbc, offset, count);
+  }
 
   if (!below_leaf_limit) {
     /* Find axis with widest range of primitive centroids */
-    if (!cb) {
-      cb = &cb_backing;
-      BB_reset(cb);
-      for (int i = offset + count - 1; i >= offset; i--) {
-        BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
-      }
-    }
     const int axis = BB_widest_axis(cb);
 
     /* Partition primitives along that axis */
@@ -531,6 +584,92 @@ static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int off
             offset + count - end);
 }
 
+typedef struct PBVHBuildLeavesData {
+  PBVH *pbvh;
+  PBVHNode **leaves;
+  int *vert_leaf;
+} PBVHBuildLeavesData;
+
+static void build_leaves_vert_leaf_cb(void *__restrict userdata,
+                                      const int leaf,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeavesData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const PBVHNode *node = data->leaves[leaf];
+
+  for (int i = 0; i < node->totprim; i++) {
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      int *vert_leaf = &data->vert_leaf[pbvh->mloop[lt->tri[j]].v];
+      /* Keep the lowest leaf index. */
+      int leaf_prev = *vert_leaf;
+      while (leaf < leaf_prev) {
+        const int leaf_test = atomic_cas_int32(vert_leaf, leaf_prev, leaf);
+        if (leaf_test == leaf_prev) {
+          break;
+        }
+        leaf_prev = leaf_test;
+      }
+    }
+  }
+}
+
+static void build_leaves_cb(void *__restrict userdata,
+                            const int leaf,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeavesData *data = userdata;
+
+  if (data->pbvh->looptri) {
+    build_mesh_leaf_node(data->pbvh, data->leaves[leaf], leaf, data->vert_leaf);
+  }
+  else {
+    build_grid_leaf_node(data->pbvh, data->leaves[leaf]);
+  }
+}
+
+/* Fill in vertices and visibility of all leaves, in parallel. */
+static void build_leaves(PBVH *pbvh)
+{
+  /* Gather leaves depth first, the order they were created in by #build_sub. */
+  PBVHNode **leaves = MEM_mallocN(sizeof(*leaves) * pbvh->totnode, __func__);
+  int *stack = MEM_mallocN(sizeof(*stack) * pbvh->totnode, __func__);
+  int leaves_len = 0, stack_len = 0;
+
+  stack[stack_len++] = 0;
+  while (stack_len) {
+    PBVHNode *node = &pbvh->nodes[stack[--stack_len]];
+    if (node->flag & PBVH_Leaf) {
+      leaves[leaves_len++] = node;
+    }
+    else {
+      stack[stack_len++] = node->children_offset + 1;
+      stack[stack_len++] = node->children_offset;
+    }
+  }
+  MEM_freeN(stack);
+
+  PBVHBuildLeavesData data = {
+      .pbvh = pbvh,
+      .leaves = leaves,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, leaves_len);
+
+  if (pbvh->looptri) {
+    data.vert_leaf = MEM_mallocN(sizeof(int) * pbvh->totvert, __func__);
+    copy_vn_i(data.vert_leaf, pbvh->totvert, INT_MAX);
+    BLI_task_parallel_range(0, leaves_len, &data, build_leaves_vert_leaf_cb, &settings);
+  }
+
+  BLI_task_parallel_range(0, leaves_len, &data, build_leaves_cb, &settings);
+
+  MEM_SAFE_FREE(data.vert_leaf);
+  MEM_freeN(leaves);
+}
+
 static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
 {
   if (totprim != pbvh->totprim) {
@@ -554,6 +693,72 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
 
   pbvh->totnode = 1;
   build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_leaves(pbvh);
+}
+
+typedef struct PBVHBuildPrimData {
+  const PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildPrimData;
+
+static void build_prim_bbc_cb(void *__restrict userdata,
+                              const int i,
+                              const TaskParallelTLS *__restrict tls)
+{
+  const PBVHBuildPrimData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  BBC *bbc = &data->prim_bbc[i];
+  BB *cb = tls->userdata_chunk;
+
+  BB_reset((BB *)bbc);
+
+  if (pbvh->looptri) {
+    const MLoopTri *lt = &pbvh->looptri[i];
+    const int sides = 3;
+
+    for (int j = 0; j < sides; j++) {
+      BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+    }
+  }
+  else {
+    const CCGKey *key = &pbvh->gridkey;
+    CCGElem *grid = pbvh->grids[i];
+
+    for (int j = 0; j < key->grid_area; j++) {
+      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+    }
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(cb, bbc->bcentroid);
+}
+
+static void build_prim_bbc_reduce(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_join,
+                                  void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+/* Store the AABB and the AABB centroid of each primitive,
+ * \a r_cb is set to the bounds of all centroids. */
+static void build_prim_bbc_calc(PBVH *pbvh, BBC *prim_bbc, int totprim, BB *r_cb)
+{
+  PBVHBuildPrimData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+
+  BB_reset(r_cb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = pbvh->looptri ? 1024 : 16;
+  settings.userdata_chunk = r_cb;
+  settings.userdata_chunk_size = sizeof(*r_cb);
+  settings.func_reduce = build_prim_bbc_reduce;
+  BLI_task_parallel_range(0, totprim, &data, build_prim_bbc_cb, &settings);
 }
 
 /**
@@ -583,7 +788,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->mloop = mloop;
   pbvh->looptri = looptri;
   pbvh->verts = verts;
-  pbvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
   pbvh->totvert = totvert;
   pbvh->leaf_limit = LEAF_LIMIT;
   pbvh->vdata = vdata;
@@ -593,33 +797,28 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
+#ifdef PERFCNTRS
+  const double time_start = PIL_check_seconds_timer();
+#endif
 
   /* For each face, store the AABB and the AABB centroid */
   prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  build_prim_bbc_calc(pbvh, prim_bbc, looptri_num, &cb);
 
   if (looptri_num) {
     pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
   }
 
   MEM_freeN(prim_bbc);
-  MEM_freeN(pbvh->vert_bitmap);
+
+#ifdef PERFCNTRS
+  printf("%s: %d triangles, %d nodes in %fs\n",
+         __func__,
+         looptri_num,
+         pbvh->totnode,
+         PIL_check_seconds_timer() - time_start);
+#endif
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -642,32 +841,31 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   pbvh->grid_hidden = grid_hidden;
   pbvh->leaf_limit = max_ii(LEAF_LIMIT / (gridsize * gridsize), 1);
 
+#ifdef PERFCNTRS
+  const double time_start = PIL_check_seconds_timer();
+#endif
+
   BB cb;
-  BB_reset(&cb);
 
   /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
 
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  build_prim_bbc_calc(pbvh, prim_bbc, totgrid, &cb);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
   }
 
   MEM_freeN(prim_bbc);
+
+#ifdef PERFCNTRS
+  printf("%s: %d grids of size %d, %d nodes in %fs\n",
+         __func__,
+         totgrid,
+         gridsize,
+         pbvh->totnode,
+         PIL_check_seconds_timer() - time_start);
+#endif
 }
 
 PBVH *BKE_pbvh_new(void)
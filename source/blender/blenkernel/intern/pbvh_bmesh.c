@@ -25,6 +25,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_DerivedMesh.h"
@@ -754,8 +755,18 @@ typedef struct {
   int cd_vert_mask_offset;
   int cd_vert_node_offset;
   int cd_face_node_offset;
+  /**
+   * When set, edges are gathered here instead of being inserted into the queue,
+   * see #edge_queue_create_from_nodes.
+   */
+  BLI_Buffer *candidates;
 } EdgeQueueContext;
 
+typedef struct EdgeQueueCandidate {
+  BMEdge *e;
+  float priority;
+} EdgeQueueCandidate;
+
 /* only tag'd edges are in the queue */
 #ifdef USE_EDGEQUEUE_TAG
 #  define EDGE_QUEUE_TEST(e) (BM_elem_flag_test((CHECK_TYPE_INLINE(e, BMEdge *), e), BM_ELEM_TAG))
@@ -842,6 +853,12 @@ static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priorit
    * should already make the brush move the vertices only 50%, which means
    * that topology updates will also happen less frequent, that should be
    * enough. */
+  if (eq_ctx->candidates) {
+    const EdgeQueueCandidate candidate = {e, priority};
+    BLI_buffer_append(eq_ctx->candidates, EdgeQueueCandidate, candidate);
+    return;
+  }
+
   if (((eq_ctx->cd_vert_mask_offset == -1) ||
        (check_mask(eq_ctx, e->v1) || check_mask(eq_ctx, e->v2))) &&
       !(BM_elem_flag_test_bool(e->v1, BM_ELEM_HIDDEN) ||
@@ -991,6 +1008,90 @@ static void short_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
   }
 }
 
+typedef struct EdgeQueueNodeData {
+  const EdgeQueueContext *eq_ctx;
+  PBVHNode **nodes;
+  BLI_Buffer *candidates;
+  void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f);
+} EdgeQueueNodeData;
+
+static void edge_queue_node_gather_cb(void *__restrict userdata,
+                                      const int n,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgeQueueNodeData *data = userdata;
+  EdgeQueueContext eq_ctx = *data->eq_ctx;
+  eq_ctx.candidates = &data->candidates[n];
+
+  GSetIterator gs_iter;
+  /* Check each face */
+  GSET_ITER (gs_iter, data->nodes[n]->bm_faces) {
+    BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
+
+    data->face_add(&eq_ctx, f);
+  }
+}
+
+/* Fill the queue from the faces of leaf nodes marked for topology update.
+ *
+ * Checking faces against the brush and measuring edges is done for each node in parallel,
+ * only reading the mesh. Edges are then inserted in node order, giving the same queue
+ * as checking all nodes one after the other.
+ *
+ * Only building the queue is threaded. Splitting and collapsing the queued edges stays serial:
+ * it allocates from the BMesh pools, writes the BMLog and moves elements between nodes, none of
+ * which is thread safe. It's also most of the time of a topology update. */
+static void edge_queue_create_from_nodes(EdgeQueueContext *eq_ctx,
+                                         PBVH *pbvh,
+                                         void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f))
+{
+  PBVHNode **nodes = MEM_mallocN(sizeof(*nodes) * pbvh->totnode, __func__);
+  int totnode = 0;
+
+  for (int n = 0; n < pbvh->totnode; n++) {
+    PBVHNode *node = &pbvh->nodes[n];
+
+    /* Check leaf nodes marked for topology update */
+    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
+        !(node->flag & PBVH_FullyHidden)) {
+      nodes[totnode++] = node;
+    }
+  }
+
+  BLI_Buffer *candidates = MEM_mallocN(sizeof(*candidates) * max_ii(totnode, 1), __func__);
+  for (int n = 0; n < totnode; n++) {
+    BLI_buffer_field_init(&candidates[n], EdgeQueueCandidate);
+  }
+
+  EdgeQueueNodeData data = {
+      .eq_ctx = eq_ctx,
+      .nodes = nodes,
+      .candidates = candidates,
+      .face_add = face_add,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totnode);
+  BLI_task_parallel_range(0, totnode, &data, edge_queue_node_gather_cb, &settings);
+
+  for (int n = 0; n < totnode; n++) {
+    const EdgeQueueCandidate *candidate = candidates[n].data;
+    for (size_t i = 0; i < candidates[n].count; i++, candidate++) {
+      /* Nodes share edges along their boundaries, only add these once. */
+#ifdef USE_EDGEQUEUE_TAG
+      if (EDGE_QUEUE_TEST(candidate->e) == false)
+#endif
+      {
+        edge_queue_insert(eq_ctx, candidate->e, candidate->priority);
+      }
+    }
+    BLI_buffer_field_free(&candidates[n]);
+  }
+
+  MEM_freeN(candidates);
+  MEM_freeN(nodes);
+}
+
 /* Create a priority queue containing vertex pairs connected by a long
  * edge as defined by PBVH.bm_max_edge_len.
  *
@@ -1036,22 +1137,7 @@ static void long_edge_queue_create(EdgeQueueContext *eq_ctx,
   pbvh_bmesh_edge_tag_verify(pbvh);
 #endif
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        long_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_create_from_nodes(eq_ctx, pbvh, long_edge_queue_face_add);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -1095,22 +1181,7 @@ static void short_edge_queue_create(EdgeQueueContext *eq_ctx,
     eq_ctx->q->edge_queue_tri_in_range = edge_queue_tri_in_sphere;
   }
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        short_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_create_from_nodes(eq_ctx, pbvh, short_edge_queue_face_add);
 }
 
 /*************************** Topology update **************************/
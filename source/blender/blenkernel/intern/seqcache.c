@@ -24,6 +24,8 @@
 #include <stddef.h>
 #include <time.h>
 
+#include "zlib.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -42,6 +44,7 @@
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -49,6 +52,15 @@
 #include "BKE_scene.h"
 #include "BKE_sequencer.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -66,6 +78,8 @@
  * Entries are linked in order as they are put into cache.
  * Only permanent (is_temp_cache = 0) cache entries are linked.
  * Putting #SEQ_CACHE_STORE_FINAL_OUT will reset linking
+ * Main render and each prefetch worker render different frames at once, so every task builds
+ * its own chain of entries.
  *
  * Only entire frame can be freed to release resources for new entries (recycling).
  * Once again, this is to reduce number of iterations, but also more controllable than removing
@@ -81,8 +95,19 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data can be stored uncompressed, compressed with LZO (low compression, fast) or
+ * compressed with zlib (high compression). The codec is stored per image.
  * Images are written in order in which they are rendered.
+ * Writing is done by a background task pool, so rendering and prefetching don't wait for
+ * compression and disk I/O. Images are compressed outside of the read/write lock, only the
+ * file access itself is serialized. If too many images are waiting to be written, images are
+ * written by the rendering thread to limit memory usage.
+ * When reading, data of an image is read with single read and decompressed from memory.
+ * List of files with their size and modification time is stored in an index file in each
+ * project directory on exit, so the cache directory doesn't have to be scanned on startup.
+ * Modification time of every directory is stored in the index too. Index is used only if none
+ * of the directories was modified since it was written, so files written or deleted by other
+ * Blender instances, or when Blender isn't closed properly, are never missed.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
@@ -94,11 +119,21 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
+#define DCACHE_INDEX_FNAME "cache_index"
+/* Maximum number of images waiting to be written by the background task pool. */
+#define DCACHE_WRITE_QUEUE_MAX 16
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+enum {
+  DCACHE_CODEC_NONE = 0,
+  DCACHE_CODEC_ZLIB = 1,
+  DCACHE_CODEC_LZO = 2,
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -116,8 +151,29 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+  /* Background writing. */
+  TaskPool *write_pool;
+  ThreadMutex write_pool_mutex;
+  int write_pending_num;
+  /* Incremented when files are invalidated, images of an older count are not written anymore.
+   * Changed with both mutexes locked, read with either of them. */
+  unsigned int invalidate_count;
+  /* Project directory of blend file, index of its files is written on exit. */
+  char project_dir[FILE_MAX];
+  /* Directories modified after this time may contain files missing in the list. */
+  int64_t scan_time;
 } SeqDiskCache;
 
+/* Image waiting to be written by background task pool. Pixels are copied, the image buffer
+ * itself can be modified or freed by the renderer after it was added to the cache. */
+typedef struct DiskCacheWriteData {
+  char path[FILE_MAX];
+  DiskCacheHeaderEntry header_entry;
+  void *data;
+  /* #SeqDiskCache.invalidate_count when the image was added to the cache. */
+  unsigned int invalidate_count;
+} DiskCacheWriteData;
+
 typedef struct DiskCacheFile {
   struct DiskCacheFile *next, *prev;
   char path[FILE_MAX];
@@ -138,7 +194,8 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last linked key of frame being rendered, for each task. */
+  struct SeqCacheKey *last_key[SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_WORKERS_MAX];
   size_t memory_used;
   SeqDiskCache *disk_cache;
 } SeqCache;
@@ -146,6 +203,7 @@ typedef struct SeqCache {
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  bool is_prefetched; /* Rendered by prefetch worker, used for prefetch statistics. */
 } SeqCacheItem;
 
 typedef struct SeqCacheKey {
@@ -220,11 +278,11 @@ static DiskCacheFile *seq_disk_cache_add_file_to_list(SeqDiskCache *disk_cache,
   return cache_file;
 }
 
-static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, char *path)
+/* Add files in path and its subdirectories to the list. */
+static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, const char *path)
 {
   struct direntry *filelist, *fl;
   uint nbr, i;
-  disk_cache->size_total = 0;
 
   i = nbr = BLI_filelist_dir_contents(path, &filelist);
   fl = filelist;
@@ -291,6 +349,7 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 
     if (!oldest_file) {
       /* We shouldn't enforce limits with no files, do re-scan. */
+      disk_cache->size_total = 0;
       seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
       continue;
     }
@@ -298,6 +357,7 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
     if (BLI_exists(oldest_file->path) == 0) {
       /* File may have been manually deleted during runtime, do re-scan. */
       BLI_freelistN(&disk_cache->files);
+      disk_cache->size_total = 0;
       seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
       continue;
     }
@@ -309,7 +369,8 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
   return true;
 }
 
-static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
+static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache,
+                                                            const char *path)
 {
   DiskCacheFile *cache_file = disk_cache->files.first;
 
@@ -322,14 +383,17 @@ static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_c
   return NULL;
 }
 
-/* Update file size and timestamp. */
-static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, char *path)
+/* Update file size and timestamp. File is added to the list if it isn't there yet. */
+static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, const char *path)
 {
   DiskCacheFile *cache_file;
   int64_t size_before;
   int64_t size_after;
 
   cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
+  if (cache_file == NULL) {
+    cache_file = seq_disk_cache_add_file_to_list(disk_cache, path);
+  }
   size_before = cache_file->fstat.st_size;
 
   if (BLI_stat(path, &cache_file->fstat) == -1) {
@@ -390,6 +454,211 @@ static void seq_disk_cache_get_file_path(SeqDiskCache *disk_cache,
   BLI_path_append(path, path_len, cache_filename);
 }
 
+/* Index of files in project directory. Format:
+ * <version>
+ * <time of writing>
+ * n <number of scene directories>
+ * d <mtime> <path of scene or strip directory>
+ * f <size> <mtime> <path of file in last listed directory>
+ * end
+ */
+
+static void seq_disk_cache_get_index_path(const char *project_dir, char *path, size_t path_len)
+{
+  BLI_strncpy(path, project_dir, path_len);
+  BLI_path_append(path, path_len, DCACHE_INDEX_FNAME);
+}
+
+/* Call fn for each subdirectory of path. Returns number of subdirectories. */
+static int seq_disk_cache_foreach_dir(const char *path,
+                                      void (*fn)(const char *path, BLI_stat_t *st, void *data),
+                                      void *data)
+{
+  struct direntry *filelist;
+  uint nbr = BLI_filelist_dir_contents(path, &filelist);
+  int dirs_num = 0;
+
+  for (uint i = 0; i < nbr; i++) {
+    struct direntry *fl = &filelist[i];
+    char file[FILE_MAX];
+    BLI_split_dirfile(fl->path, NULL, file, 0, sizeof(file));
+    if (FILENAME_IS_CURRPAR(file) || (BLI_file_attributes(fl->path) & FILE_ATTR_ANY_LINK) ||
+        !BLI_is_dir(fl->path)) {
+      continue;
+    }
+
+    char subpath[FILE_MAX];
+    BLI_strncpy(subpath, fl->path, sizeof(subpath));
+    BLI_path_slash_ensure(subpath);
+    if (fn) {
+      fn(subpath, &fl->s, data);
+    }
+    dirs_num++;
+  }
+  BLI_filelist_free(filelist, nbr);
+
+  return dirs_num;
+}
+
+/* Remove files added to the list after last_file. */
+static void seq_disk_cache_remove_files_after(SeqDiskCache *disk_cache, DiskCacheFile *last_file)
+{
+  DiskCacheFile *cache_file = last_file ? last_file->next : disk_cache->files.first;
+  while (cache_file) {
+    DiskCacheFile *next_file = cache_file->next;
+    disk_cache->size_total -= cache_file->fstat.st_size;
+    BLI_freelinkN(&disk_cache->files, cache_file);
+    cache_file = next_file;
+  }
+}
+
+/* Add files listed in index of project directory to the list. Returns false if there is no
+ * valid index. Index is not valid if any directory was modified since it was written, because
+ * files could have been written or deleted by other Blender instance. */
+static bool seq_disk_cache_read_index(SeqDiskCache *disk_cache, const char *project_dir)
+{
+  char index_path[FILE_MAX];
+  seq_disk_cache_get_index_path(project_dir, index_path, sizeof(index_path));
+
+  FILE *file = BLI_fopen(index_path, "r");
+  if (!file) {
+    return false;
+  }
+
+  DiskCacheFile *last_file = disk_cache->files.last;
+  char line[FILE_MAX + 64];
+  int version = 0;
+  int64_t index_time = 0;
+  int dirs_num = -1;
+  bool is_valid = fgets(line, sizeof(line), file) != NULL && sscanf(line, "%d", &version) == 1 &&
+                  version == DCACHE_CURRENT_VERSION && fgets(line, sizeof(line), file) != NULL &&
+                  sscanf(line, "%" SCNd64, &index_time) == 1 &&
+                  fgets(line, sizeof(line), file) != NULL &&
+                  sscanf(line, "n %d", &dirs_num) == 1;
+  bool is_complete = false;
+
+  while (is_valid && !is_complete && fgets(line, sizeof(line), file)) {
+    int64_t size, mtime;
+    int path_offset = 0;
+    if (STREQ(line, "end\n")) {
+      is_complete = true;
+    }
+    else if (sscanf(line, "d %" SCNd64 " %n", &mtime, &path_offset) == 1 && path_offset != 0) {
+      char *path = line + path_offset;
+      BLI_str_rstrip(path);
+      /* Directory modified in the same second the index was written in may be missing files. */
+      BLI_stat_t st;
+      is_valid = BLI_stat(path, &st) != -1 && (int64_t)st.st_mtime == mtime &&
+                 mtime < index_time;
+    }
+    else if (sscanf(line, "f %" SCNd64 " %" SCNd64 " %n", &size, &mtime, &path_offset) == 2 &&
+             path_offset != 0) {
+      char *path = line + path_offset;
+      BLI_str_rstrip(path);
+      DiskCacheFile *cache_file = seq_disk_cache_add_file_to_list(disk_cache, path);
+      cache_file->fstat.st_size = size;
+      cache_file->fstat.st_mtime = mtime;
+      disk_cache->size_total += size;
+    }
+    else {
+      is_valid = false;
+    }
+  }
+
+  fclose(file);
+
+  /* Scene directories are validated by their modification time, new ones by their count. */
+  if (is_valid && is_complete) {
+    is_valid = seq_disk_cache_foreach_dir(project_dir, NULL, NULL) == dirs_num;
+  }
+
+  if (!is_valid || !is_complete) {
+    seq_disk_cache_remove_files_after(disk_cache, last_file);
+    return false;
+  }
+
+  return true;
+}
+
+typedef struct DiskCacheIndexWriteData {
+  SeqDiskCache *disk_cache;
+  FILE *file;
+} DiskCacheIndexWriteData;
+
+static void seq_disk_cache_write_index_strip_dir(const char *path, BLI_stat_t *st, void *data)
+{
+  DiskCacheIndexWriteData *write_data = data;
+  SeqDiskCache *disk_cache = write_data->disk_cache;
+
+  /* Files in directory modified since it was scanned may have been written or deleted by other
+   * disk cache, merge the list with files on disk. */
+  if ((int64_t)st->st_mtime >= disk_cache->scan_time) {
+    DiskCacheFile *next_file, *cache_file = disk_cache->files.first;
+    for (; cache_file; cache_file = next_file) {
+      next_file = cache_file->next;
+      if (STREQ(cache_file->dir, path)) {
+        disk_cache->size_total -= cache_file->fstat.st_size;
+        BLI_freelinkN(&disk_cache->files, cache_file);
+      }
+    }
+    seq_disk_cache_get_files(disk_cache, path);
+  }
+
+  fprintf(write_data->file, "d %" PRId64 " %s\n", (int64_t)st->st_mtime, path);
+  LISTBASE_FOREACH (DiskCacheFile *, cache_file, &disk_cache->files) {
+    if (STREQ(cache_file->dir, path)) {
+      fprintf(write_data->file,
+              "f %" PRId64 " %" PRId64 " %s\n",
+              (int64_t)cache_file->fstat.st_size,
+              (int64_t)cache_file->fstat.st_mtime,
+              cache_file->path);
+    }
+  }
+}
+
+static void seq_disk_cache_write_index_scene_dir(const char *path, BLI_stat_t *st, void *data)
+{
+  DiskCacheIndexWriteData *write_data = data;
+  fprintf(write_data->file, "d %" PRId64 " %s\n", (int64_t)st->st_mtime, path);
+  seq_disk_cache_foreach_dir(path, seq_disk_cache_write_index_strip_dir, data);
+}
+
+static void seq_disk_cache_write_index(SeqDiskCache *disk_cache, const char *project_dir)
+{
+  if (!BLI_is_dir(project_dir)) {
+    return;
+  }
+
+  /* Write to temporary file first, so other Blender instances never read incomplete index. */
+  char index_path[FILE_MAX], index_path_temp[FILE_MAX];
+  seq_disk_cache_get_index_path(project_dir, index_path, sizeof(index_path));
+  BLI_snprintf(index_path_temp, sizeof(index_path_temp), "%s@%p", index_path, disk_cache);
+
+  FILE *file = BLI_fopen(index_path_temp, "w");
+  if (!file) {
+    return;
+  }
+
+  DiskCacheIndexWriteData write_data = {disk_cache, file};
+  fprintf(file, "%d\n", DCACHE_CURRENT_VERSION);
+  fprintf(file, "%" PRId64 "\n", (int64_t)time(NULL));
+  fprintf(file, "n %d\n", seq_disk_cache_foreach_dir(project_dir, NULL, NULL));
+  seq_disk_cache_foreach_dir(project_dir, seq_disk_cache_write_index_scene_dir, &write_data);
+  fprintf(file, "end\n");
+  fclose(file);
+
+  BLI_rename(index_path_temp, index_path);
+}
+
+/* Add files of project directory to the list, using its index if it is valid. */
+static void seq_disk_cache_load_project_dir(const char *path, BLI_stat_t *UNUSED(st), void *data)
+{
+  SeqDiskCache *disk_cache = data;
+  if (!seq_disk_cache_read_index(disk_cache, path)) {
+    seq_disk_cache_get_files(disk_cache, path);
+  }
+}
+
 static void seq_disk_cache_create_version_file(char *path)
 {
   BLI_make_existing_file(path);
@@ -466,6 +735,12 @@ static void seq_disk_cache_invalidate(Scene *scene,
 
   BLI_mutex_lock(&disk_cache->read_write_mutex);
 
+  /* Images waiting to be written may be outdated, they are skipped by the write tasks. The pool
+   * is not canceled, so it keeps working for images rendered after this. */
+  BLI_mutex_lock(&disk_cache->write_pool_mutex);
+  disk_cache->invalidate_count++;
+  BLI_mutex_unlock(&disk_cache->write_pool_mutex);
+
   start = seq_changed->startdisp - DCACHE_IMAGES_PER_FILE;
   end = seq_changed->enddisp;
 
@@ -474,29 +749,88 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static void *seq_disk_cache_imbuf_data(ImBuf *ibuf)
 {
   if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+    return ibuf->rect;
   }
 
-  return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+  return ibuf->rect_float;
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+/* Compress image data with codec chosen by compression level.
+ * Returns compressed data, which is either newly allocated buffer or `data` itself if
+ * data is stored uncompressed. Used codec and size of data are stored in header_entry. */
+static void *seq_disk_cache_compress(void *data, int level, DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  const size_t size_raw = header_entry->size_raw;
+
+  header_entry->codec = DCACHE_CODEC_NONE;
+  header_entry->size_compressed = size_raw;
+
+  if (level == 0) {
+    return data;
+  }
+
+#ifdef WITH_LZO
+  /* Low compression level uses LZO, which is much faster than zlib. */
+  if (level == 1) {
+    lzo_uint out_len = LZO_OUT_LEN(size_raw);
+    unsigned char *out = MEM_mallocN(out_len, "seq disk cache lzo buffer");
+    void *wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "seq disk cache lzo wrkmem");
+    const int r = lzo1x_1_compress(data, (lzo_uint)size_raw, out, &out_len, wrkmem);
+    MEM_freeN(wrkmem);
+
+    if (r == LZO_E_OK && out_len < size_raw) {
+      header_entry->codec = DCACHE_CODEC_LZO;
+      header_entry->size_compressed = out_len;
+      return out;
+    }
+    MEM_freeN(out);
+    return data;
+  }
+#endif
+
+  uLongf out_len = compressBound(size_raw);
+  unsigned char *out = MEM_mallocN(out_len, "seq disk cache zlib buffer");
+  if (compress2(out, &out_len, data, size_raw, level) == Z_OK && out_len < size_raw) {
+    header_entry->codec = DCACHE_CODEC_ZLIB;
+    header_entry->size_compressed = out_len;
+    return out;
+  }
+  MEM_freeN(out);
+  return data;
+}
+
+/* Returns number of bytes decompressed into ibuf. */
+static size_t seq_disk_cache_decompress_to_imbuf(ImBuf *ibuf,
+                                                 const void *data,
+                                                 const DiskCacheHeaderEntry *header_entry)
+{
+  void *buf = seq_disk_cache_imbuf_data(ibuf);
+
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_ZLIB: {
+      uLongf out_len = header_entry->size_raw;
+      if (uncompress(buf, &out_len, data, header_entry->size_compressed) != Z_OK) {
+        return 0;
+      }
+      return out_len;
+    }
+#ifdef WITH_LZO
+    case DCACHE_CODEC_LZO: {
+      lzo_uint out_len = header_entry->size_raw;
+      if (lzo1x_decompress_safe(
+              data, (lzo_uint)header_entry->size_compressed, buf, &out_len, NULL) != LZO_E_OK) {
+        return 0;
+      }
+      return out_len;
+    }
+#endif
   }
 
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  /* Unknown codec or codec not supported by this build. */
+  return 0;
 }
 
 static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -520,7 +854,37 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static void seq_disk_cache_init_header_entry(ImBuf *ibuf,
+                                             float nfra,
+                                             DiskCacheHeaderEntry *header_entry)
+{
+  memset(header_entry, 0, sizeof(*header_entry));
+
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    header_entry->encoding = 255;
+  }
+  else {
+    header_entry->encoding = 0;
+  }
+
+  header_entry->frameno = nfra;
+
+  /* Store colorspace name of ibuf. */
+  const char *colorspace_name;
+  if (ibuf->rect) {
+    header_entry->size_raw = ibuf->x * ibuf->y * ibuf->channels;
+    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
+  }
+  else {
+    header_entry->size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
+    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
+  }
+  BLI_strncpy(
+      header_entry->colorspace_name, colorspace_name, sizeof(header_entry->colorspace_name));
+}
+
+static int seq_disk_cache_add_header_entry(DiskCacheHeader *header,
+                                           const DiskCacheHeaderEntry *new_entry)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -545,28 +909,8 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     offset = header->entry[i - 1].offset + header->entry[i - 1].size_compressed;
   }
 
-  if (ENDIAN_ORDER == B_ENDIAN) {
-    header->entry[i].encoding = 255;
-  }
-  else {
-    header->entry[i].encoding = 0;
-  }
-
+  header->entry[i] = *new_entry;
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->nfra;
-
-  /* Store colorspace name of ibuf. */
-  const char *colorspace_name;
-  if (ibuf->rect) {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels;
-    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
-  }
-  else {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
-    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
-  }
-  BLI_strncpy(
-      header->entry[i].colorspace_name, colorspace_name, sizeof(header->entry[i].colorspace_name));
 
   return i;
 }
@@ -582,42 +926,72 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Write raw image data described by header_entry, as initialized by
+ * #seq_disk_cache_init_header_entry. */
+/* Images added to the cache before files were invalidated (`invalidate_count` differs from the
+ * current one) are not written. */
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache,
+                                      const char *path,
+                                      const DiskCacheHeaderEntry *header_entry,
+                                      void *raw_data,
+                                      const unsigned int invalidate_count)
 {
-  char path[FILE_MAX];
+  DiskCacheHeaderEntry new_entry = *header_entry;
+  bool success = false;
+
+  /* Don't compress outdated images, checked again once locked. */
+  BLI_mutex_lock(&disk_cache->write_pool_mutex);
+  const bool is_outdated = invalidate_count != disk_cache->invalidate_count;
+  BLI_mutex_unlock(&disk_cache->write_pool_mutex);
+  if (is_outdated) {
+    return false;
+  }
+
+  /* Compress before locking, so images can be compressed by multiple threads at once. */
+  void *data = seq_disk_cache_compress(raw_data, seq_disk_cache_compression_level(), &new_entry);
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+
+  if (invalidate_count != disk_cache->invalidate_count) {
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    if (data != raw_data) {
+      MEM_freeN(data);
+    }
+    return false;
+  }
 
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
   FILE *file = BLI_fopen(path, "rb+");
   if (!file) {
     file = BLI_fopen(path, "wb+");
-    if (!file) {
-      return false;
-    }
-    seq_disk_cache_add_file_to_list(disk_cache, path);
   }
 
-  DiskCacheHeader header;
-  memset(&header, 0, sizeof(header));
-  seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
-
-  if (bytes_written != 0) {
-    /* Last step is writing header, as image data can be overwritten,
-     * but missing data would cause problems.
-     */
-    header.entry[entry_index].size_compressed = bytes_written;
-    seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
+  if (file) {
+    DiskCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    seq_disk_cache_read_header(file, &header);
+    int entry_index = seq_disk_cache_add_header_entry(&header, &new_entry);
+
+    BLI_fseek(file, header.entry[entry_index].offset, SEEK_SET);
+    if (fwrite(data, 1, new_entry.size_compressed, file) == new_entry.size_compressed) {
+      /* Last step is writing header, as image data can be overwritten,
+       * but missing data would cause problems.
+       */
+      seq_disk_cache_write_header(file, &header);
+      success = true;
+    }
     fclose(file);
+    seq_disk_cache_update_file(disk_cache, path);
+  }
 
-    return true;
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  if (data != raw_data) {
+    MEM_freeN(data);
   }
 
-  return false;
+  return success;
 }
 
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
@@ -626,10 +1000,12 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   DiskCacheHeader header;
 
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
-  BLI_make_existing_file(path);
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
 
   FILE *file = BLI_fopen(path, "rb");
   if (!file) {
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
@@ -639,44 +1015,148 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   /* Item not found. */
   if (entry_index < 0) {
     fclose(file);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
+  const DiskCacheHeaderEntry *header_entry = &header.entry[entry_index];
   ImBuf *ibuf;
   uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
   size_t expected_size;
 
-  if (header.entry[entry_index].size_raw == size_char) {
+  if (header_entry->size_raw == size_char) {
     expected_size = size_char;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_rect_colorspace(ibuf, header_entry->colorspace_name);
   }
-  else if (header.entry[entry_index].size_raw == size_float) {
+  else if (header_entry->size_raw == size_float) {
     expected_size = size_float;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_float_colorspace(ibuf, header_entry->colorspace_name);
   }
   else {
     fclose(file);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  /* Uncompressed data is read directly into image buffer. */
+  void *buf = seq_disk_cache_imbuf_data(ibuf);
+  void *data = buf;
+  bool is_valid = true;
 
-  /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
+  if (header_entry->codec == DCACHE_CODEC_NONE) {
+    is_valid = header_entry->size_compressed == expected_size;
+  }
+  else {
+    /* Data is stored compressed only if it is smaller than raw data. */
+    is_valid = header_entry->size_compressed < expected_size;
+    if (is_valid) {
+      data = MEM_mallocN(header_entry->size_compressed, "seq disk cache read buffer");
+    }
+  }
+
+  /* Whole entry is read at once, decompression is done after the file is unlocked. */
+  if (is_valid) {
+    BLI_fseek(file, header_entry->offset, SEEK_SET);
+    is_valid = fread(data, 1, header_entry->size_compressed, file) ==
+               header_entry->size_compressed;
+  }
+  fclose(file);
+
+  if (is_valid) {
+    BLI_file_touch(path);
+    seq_disk_cache_update_file(disk_cache, path);
+  }
+
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  if (data != buf) {
+    /* Sanity check. */
+    if (is_valid) {
+      is_valid = seq_disk_cache_decompress_to_imbuf(ibuf, data, header_entry) == expected_size;
+    }
+    MEM_freeN(data);
+  }
+
+  if (!is_valid) {
     IMB_freeImBuf(ibuf);
     return NULL;
   }
-  BLI_file_touch(path);
-  seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
 
+static void seq_disk_cache_write_task(TaskPool *__restrict pool, void *taskdata)
+{
+  SeqDiskCache *disk_cache = BLI_task_pool_user_data(pool);
+  DiskCacheWriteData *write_data = taskdata;
+
+  seq_disk_cache_write_file(disk_cache,
+                            write_data->path,
+                            &write_data->header_entry,
+                            write_data->data,
+                            write_data->invalidate_count);
+  seq_disk_cache_enforce_limits(disk_cache);
+}
+
+static void seq_disk_cache_write_data_free(TaskPool *__restrict pool, void *taskdata)
+{
+  SeqDiskCache *disk_cache = BLI_task_pool_user_data(pool);
+  DiskCacheWriteData *write_data = taskdata;
+
+  MEM_freeN(write_data->data);
+  MEM_freeN(write_data);
+
+  BLI_mutex_lock(&disk_cache->write_pool_mutex);
+  disk_cache->write_pending_num--;
+  BLI_mutex_unlock(&disk_cache->write_pool_mutex);
+}
+
+/* Write image in background. If too many images are waiting to be written already, image is
+ * written immediately, so memory usage doesn't grow when rendering is faster than writing. */
+static void seq_disk_cache_write_file_async(SeqDiskCache *disk_cache,
+                                            SeqCacheKey *key,
+                                            ImBuf *ibuf)
+{
+  char path[FILE_MAX];
+  DiskCacheHeaderEntry header_entry;
+  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
+  seq_disk_cache_init_header_entry(ibuf, key->nfra, &header_entry);
+
+  BLI_mutex_lock(&disk_cache->write_pool_mutex);
+  const bool use_pool = disk_cache->write_pending_num < DCACHE_WRITE_QUEUE_MAX;
+  if (use_pool) {
+    disk_cache->write_pending_num++;
+  }
+  const unsigned int invalidate_count = disk_cache->invalidate_count;
+  BLI_mutex_unlock(&disk_cache->write_pool_mutex);
+
+  if (!use_pool) {
+    seq_disk_cache_write_file(
+        disk_cache, path, &header_entry, seq_disk_cache_imbuf_data(ibuf), invalidate_count);
+    seq_disk_cache_enforce_limits(disk_cache);
+    return;
+  }
+
+  /* Copy outside of the lock, other threads don't have to wait for it. */
+  DiskCacheWriteData *write_data = MEM_mallocN(sizeof(DiskCacheWriteData), "DiskCacheWriteData");
+  BLI_strncpy(write_data->path, path, sizeof(write_data->path));
+  write_data->header_entry = header_entry;
+  write_data->invalidate_count = invalidate_count;
+  write_data->data = MEM_mallocN(header_entry.size_raw, "DiskCacheWriteData data");
+  memcpy(write_data->data, seq_disk_cache_imbuf_data(ibuf), header_entry.size_raw);
+
+  BLI_mutex_lock(&disk_cache->write_pool_mutex);
+  BLI_task_pool_push(disk_cache->write_pool,
+                     seq_disk_cache_write_task,
+                     write_data,
+                     true,
+                     seq_disk_cache_write_data_free);
+  BLI_mutex_unlock(&disk_cache->write_pool_mutex);
+}
+
 #undef DCACHE_FNAME_FORMAT
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
@@ -771,7 +1251,19 @@ static size_t seq_cache_get_mem_total(void)
 static void seq_cache_keyfree(void *val)
 {
   SeqCacheKey *key = val;
-  BLI_mempool_free(key->cache_owner->keys_pool, key);
+  SeqCache *cache = key->cache_owner;
+
+  /* Frame of this task may still be rendered, don't link its next entry to freed key. */
+  if (cache->last_key[key->task_id] == key) {
+    cache->last_key[key->task_id] = NULL;
+  }
+
+  BLI_mempool_free(cache->keys_pool, key);
+}
+
+static void seq_cache_reset_linking(SeqCache *cache)
+{
+  memset(cache->last_key, 0, sizeof(cache->last_key));
 }
 
 static void seq_cache_valfree(void *val)
@@ -793,20 +1285,22 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->is_prefetched = key->task_id >= SEQ_TASK_PREFETCH_RENDER;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
-    cache->last_key = key;
+    cache->last_key[key->task_id] = key;
     cache->memory_used += IMB_get_size_in_memory(ibuf);
   }
 }
 
-static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key)
+static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key, bool *r_is_prefetched)
 {
   SeqCacheItem *item = BLI_ghash_lookup(cache->hash, key);
 
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
+    *r_is_prefetched = item->is_prefetched;
 
     return item->ibuf;
   }
@@ -1035,21 +1529,43 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_lock(&cache_create_lock);
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
-  if (cache == NULL) {
+  if (cache == NULL || cache->disk_cache != NULL) {
+    BLI_mutex_unlock(&cache_create_lock);
     return;
   }
 
-  if (cache->disk_cache != NULL) {
-    return;
-  }
+  SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
+  disk_cache->bmain = bmain;
+  BLI_mutex_init(&disk_cache->read_write_mutex);
+  BLI_mutex_init(&disk_cache->write_pool_mutex);
+  disk_cache->write_pool = BLI_task_pool_create_background(disk_cache, TASK_PRIORITY_LOW);
+  seq_disk_cache_get_project_dir(
+      disk_cache, disk_cache->project_dir, sizeof(disk_cache->project_dir));
+
+  seq_disk_cache_handle_versioning(disk_cache);
+  disk_cache->scan_time = (int64_t)time(NULL);
+  seq_disk_cache_foreach_dir(
+      seq_disk_cache_base_dir(), seq_disk_cache_load_project_dir, disk_cache);
+  disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  cache->disk_cache = disk_cache;
+  BLI_mutex_unlock(&cache_create_lock);
+}
+
+static void seq_disk_cache_free(SeqDiskCache *disk_cache)
+{
+  /* Finish writing images waiting in queue. */
+  BLI_task_pool_work_and_wait(disk_cache->write_pool);
+  BLI_task_pool_free(disk_cache->write_pool);
 
-  cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
-  cache->disk_cache->bmain = bmain;
-  BLI_mutex_init(&cache->disk_cache->read_write_mutex);
-  seq_disk_cache_handle_versioning(cache->disk_cache);
-  seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
-  cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  /* Serialize with other disk caches writing index of the same project directory. */
+  BLI_mutex_lock(&cache_create_lock);
+  seq_disk_cache_write_index(disk_cache, disk_cache->project_dir);
   BLI_mutex_unlock(&cache_create_lock);
+
+  BLI_freelistN(&disk_cache->files);
+  BLI_mutex_end(&disk_cache->read_write_mutex);
+  BLI_mutex_end(&disk_cache->write_pool_mutex);
+  MEM_freeN(disk_cache);
 }
 
 static void seq_cache_create(Main *bmain, Scene *scene)
@@ -1060,7 +1576,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1110,9 +1625,7 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
-    BLI_freelistN(&cache->disk_cache->files);
-    BLI_mutex_end(&cache->disk_cache->read_write_mutex);
-    MEM_freeN(cache->disk_cache);
+    seq_disk_cache_free(cache->disk_cache);
   }
 
   MEM_freeN(cache);
@@ -1144,7 +1657,7 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1208,7 +1721,7 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1240,6 +1753,7 @@ struct ImBuf *BKE_sequencer_cache_get(
   SeqCache *cache = seq_cache_get_from_scene(scene);
   ImBuf *ibuf = NULL;
   SeqCacheKey key;
+  bool is_prefetched = false;
 
   /* Try RAM cache: */
   if (cache && seq) {
@@ -1248,10 +1762,15 @@ struct ImBuf *BKE_sequencer_cache_get(
     key.nfra = seq_cache_cfra_to_frame_index(seq, cfra);
     key.type = type;
 
-    ibuf = seq_cache_get(cache, &key);
+    ibuf = seq_cache_get(cache, &key, &is_prefetched);
   }
   seq_cache_unlock(scene);
 
+  /* Final frames requested by main thread tell how useful prefetching is. */
+  if (type == SEQ_CACHE_STORE_FINAL_OUT && context->task_id == SEQ_TASK_MAIN_RENDER) {
+    BKE_sequencer_prefetch_stats_add_request(scene, ibuf != NULL && is_prefetched);
+  }
+
   if (ibuf) {
     return ibuf;
   }
@@ -1262,9 +1781,7 @@ struct ImBuf *BKE_sequencer_cache_get(
       seq_disk_cache_create(context->bmain, context->scene);
     }
 
-    BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
     ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
-    BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
     if (ibuf) {
       if (key.type == SEQ_CACHE_STORE_FINAL_OUT) {
         BKE_sequencer_cache_put_if_possible(context, seq, cfra, type, ibuf, 0.0f, true);
@@ -1303,8 +1820,11 @@ bool BKE_sequencer_cache_put_if_possible(const SeqRenderData *context,
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = NULL;
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  seq_cache_lock(scene);
+  seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+  cache->last_key[context->task_id] = NULL;
+  seq_cache_unlock(scene);
   return false;
 }
 
@@ -1372,31 +1892,32 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   key->link_next = NULL;
   key->is_temp_cache = true;
   key->task_id = context->task_id;
+  BLI_assert(key->task_id < ARRAY_SIZE(cache->last_key));
 
   /* Item stored for later use */
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = cache->last_key[key->task_id];
   }
 
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = cache->last_key[key->task_id];
   seq_cache_put(cache, key, i);
 
   /* Restore pointer to previous item as this one will be freed when stack is rendered. */
   if (key->is_temp_cache) {
-    cache->last_key = temp_last_key;
+    cache->last_key[key->task_id] = temp_last_key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key of the task points to current key.
    */
   if (flag & type && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = cache->last_key[key->task_id];
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    cache->last_key[key->task_id] = NULL;
   }
 
   seq_cache_unlock(scene);
@@ -1407,10 +1928,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_file_async(cache->disk_cache, key, i);
     }
   }
 }
@@ -1439,7 +1957,7 @@ void BKE_sequencer_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->nfra, key->type, key->cost);
   }
 
-  cache->last_key = NULL;
+  seq_cache_reset_linking(cache);
   seq_cache_unlock(scene);
 }
 
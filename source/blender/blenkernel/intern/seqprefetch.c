@@ -21,7 +21,9 @@
  * \ingroup bke
  */
 
+#include <math.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -34,6 +36,7 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -54,30 +57,52 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
+#include "atomic_ops.h"
+
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+  int index;
+
+  struct Depsgraph *depsgraph;
+  struct Scene *scene_eval;
+
+  /* Render context of scene copy and original context used for cache. */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* Frame being rendered. */
+  float cfra;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
   struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
+  PrefetchWorker workers[SEQ_PREFETCH_WORKERS_MAX];
+  /* Number of workers with initialized depsgraph. */
+  int workers_num;
+  /* Number of workers which should keep rendering, based on measured cost of frames. */
+  int workers_active_num;
+  int workers_running_num;
 
   /* prefetch area */
   float cfra;
   int num_frames_prefetched;
 
+  /* Running average of render cost of prefetched frames. */
+  float cost;
+  SeqPrefetchStats stats;
+
   /* control */
   bool running;
   bool waiting;
@@ -165,7 +190,14 @@ SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
-  return &pfjob->context;
+  for (int i = 0; i < pfjob->workers_num; i++) {
+    if (pfjob->workers[i].scene_eval == context->scene) {
+      return &pfjob->workers[i].context;
+    }
+  }
+
+  BLI_assert(!"Prefetch context not found");
+  return &pfjob->workers[0].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -183,9 +215,9 @@ static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
 }
 
 void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
@@ -196,37 +228,91 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+void BKE_sequencer_prefetch_stats_add_request(Scene *scene, bool is_hit)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (!pfjob || (scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) == 0) {
+    return;
+  }
+
+  atomic_add_and_fetch_int32(&pfjob->stats.frames_requested, 1);
+  if (is_hit) {
+    atomic_add_and_fetch_int32(&pfjob->stats.frames_hit, 1);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+void BKE_sequencer_prefetch_get_stats(Scene *scene, SeqPrefetchStats *r_stats)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (!pfjob) {
+    memset(r_stats, 0, sizeof(*r_stats));
+    return;
+  }
+
+  *r_stats = pfjob->stats;
+  r_stats->cost = pfjob->cost;
+  r_stats->workers_num = pfjob->workers_num;
+}
+
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
+{
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
+  }
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
+}
+
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
+{
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
   Main *bmain = pfjob->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  worker->cfra = seq_prefetch_cfra(pfjob);
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+}
+
+static void seq_prefetch_tag_id_copy_cb(ID *id, void *user_data)
+{
+  PrefetchWorker *worker = user_data;
+  DEG_graph_id_tag_update(
+      worker->pfjob->bmain_eval, worker->depsgraph, id, ID_RECALC_COPY_ON_WRITE);
+}
+
+/* Reuse the depsgraph of a worker for a new prefetch run, instead of building a new one.
+ * Prefetching is restarted after any change of the original data, which isn't tagged in this
+ * depsgraph: rebuild relations in place and copy all datablocks again. */
+static void seq_prefetch_refresh_depsgraph(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
+  DEG_foreach_ID(worker->depsgraph, seq_prefetch_tag_id_copy_cb, worker);
+
+  worker->cfra = seq_prefetch_cfra(pfjob);
+  seq_prefetch_update_depsgraph(worker);
+
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -274,44 +360,55 @@ void BKE_sequencer_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
-static void seq_prefetch_update_context(const SeqRenderData *context)
+static void seq_prefetch_update_context(const SeqRenderData *context, PrefetchWorker *worker)
 {
-  PrefetchJob *pfjob;
-  pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchJob *pfjob = worker->pfjob;
+  /* Each worker uses its own ID, so workers don't free temporary cache of each other. */
+  const eSeqTaskId task_id = SEQ_TASK_PREFETCH_RENDER + worker->index;
 
   BKE_sequencer_new_render_data(pfjob->bmain_eval,
-                                pfjob->depsgraph,
-                                pfjob->scene_eval,
+                                worker->depsgraph,
+                                worker->scene_eval,
                                 context->rectx,
                                 context->recty,
                                 context->preview_render_size,
                                 false,
-                                &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
+                                &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = task_id;
 
   BKE_sequencer_new_render_data(pfjob->bmain,
-                                pfjob->depsgraph,
+                                worker->depsgraph,
                                 pfjob->scene,
                                 context->rectx,
                                 context->recty,
                                 context->preview_render_size,
                                 false,
-                                &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
+                                &worker->context);
+  worker->context.is_prefetch_render = false;
 
   /* Same ID as prefetch context, because context will be swapped, but we still
    * want to assign this ID to cache entries created in this thread.
    * This is to allow "temp cache" work correctly for both threads.
    */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  worker->context.task_id = task_id;
 }
 
-static void seq_prefetch_update_scene(Scene *scene)
+/* Number of workers needed to keep up with playback. */
+static int seq_prefetch_workers_needed(float cost)
+{
+  const int workers_max = min_ii(max_ii(BLI_system_thread_count() - 1, 1),
+                                 SEQ_PREFETCH_WORKERS_MAX);
+  return min_ii(max_ii((int)ceilf(cost), 1), workers_max);
+}
+
+/* Prepare depsgraphs of workers needed for rendering frames with given cost and free the rest.
+ * Depsgraphs of the previous run are kept for workers which are still needed. */
+static void seq_prefetch_update_scene(Scene *scene, float cost)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
@@ -319,8 +416,23 @@ static void seq_prefetch_update_scene(Scene *scene)
     return;
   }
 
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  const int workers_num = seq_prefetch_workers_needed(cost);
+
+  for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    if (i >= workers_num) {
+      seq_prefetch_free_depsgraph(worker);
+    }
+    else if (worker->depsgraph != NULL) {
+      seq_prefetch_refresh_depsgraph(worker);
+    }
+    else {
+      seq_prefetch_init_depsgraph(worker);
+    }
+  }
+
+  pfjob->workers_num = workers_num;
+  pfjob->workers_active_num = workers_num;
 }
 
 static void seq_prefetch_resume(Scene *scene)
@@ -328,7 +440,7 @@ static void seq_prefetch_resume(Scene *scene)
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
   if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -341,24 +453,32 @@ void BKE_sequencer_prefetch_free(Scene *scene)
 
   BKE_sequencer_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
+  if (G.debug & G_DEBUG) {
+    printf("Sequencer prefetch: %d of %d requested frames prefetched, %d frames rendered\n",
+           pfjob->stats.frames_hit,
+           pfjob->stats.frames_requested,
+           pfjob->stats.frames_rendered);
+  }
+
+  for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+  }
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
   BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
-static bool seq_prefetch_do_skip_frame(Scene *scene)
+static bool seq_prefetch_do_skip_frame(PrefetchWorker *worker)
 {
-  Editing *ed = scene->ed;
-  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
-  float cfra = seq_prefetch_cfra(pfjob);
+  Editing *ed = worker->pfjob->scene->ed;
+  float cfra = worker->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = BKE_sequencer_get_shown_sequences(ed->seqbasep, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &worker->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
@@ -414,34 +534,81 @@ static bool seq_prefetch_do_skip_frame(Scene *scene)
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+/* Suspend thread if there is nothing to be prefetched or if the worker isn't needed to keep up
+ * with playback, then take next frame to render.
+ * Returns false when the worker should stop. */
+static bool seq_prefetch_next_frame(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
+  bool has_frame = false;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
+  seq_prefetch_update_area(pfjob);
+
+  while ((pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
+    if (seq_prefetch_need_suspend(pfjob)) {
+      pfjob->waiting = true;
+    }
+    else if (worker->index >= pfjob->workers_active_num) {
+      /* Idle until frames get more expensive, see #seq_prefetch_update_cost. */
+    }
+    else {
+      break;
+    }
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
     seq_prefetch_update_area(pfjob);
   }
   pfjob->waiting = false;
+
+  if ((pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop &&
+      worker->index < pfjob->workers_active_num &&
+      seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
+    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+    if (pfjob->num_frames_prefetched <= 5 ||
+        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) >= 2) {
+      worker->cfra = seq_prefetch_cfra(pfjob);
+      pfjob->num_frames_prefetched++;
+      has_frame = true;
+    }
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return has_frame;
+}
+
+/* Update average cost of rendered frames and number of workers needed to keep up with it. */
+static void seq_prefetch_update_cost(PrefetchJob *pfjob, float cost)
+{
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->stats.frames_rendered++;
+  pfjob->cost = (pfjob->stats.frames_rendered == 1) ? cost : pfjob->cost * 0.8f + cost * 0.2f;
+  const int workers_active_num = min_ii(seq_prefetch_workers_needed(pfjob->cost),
+                                        pfjob->workers_num);
+  if (workers_active_num > pfjob->workers_active_num) {
+    /* Wake up idle workers. */
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+  }
+  pfjob->workers_active_num = workers_active_num;
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 }
 
-static void *seq_prefetch_frames(void *job)
+static void *seq_prefetch_frames(void *worker_v)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchWorker *worker = (PrefetchWorker *)worker_v;
+  PrefetchJob *pfjob = worker->pfjob;
+  Scene *scene_eval = worker->scene_eval;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  while (seq_prefetch_next_frame(worker)) {
+    scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+    seq_prefetch_update_depsgraph(worker);
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
     BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+        &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -449,44 +616,35 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to NULL before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    scene_eval->ed->prefetch_job = pfjob;
 
-    if (seq_prefetch_do_skip_frame(pfjob->scene)) {
-      pfjob->num_frames_prefetched++;
+    if (seq_prefetch_do_skip_frame(worker)) {
       continue;
     }
 
-    ImBuf *ibuf = BKE_sequencer_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
+    const double begin = PIL_check_seconds_timer();
+    ImBuf *ibuf = BKE_sequencer_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
     IMB_freeImBuf(ibuf);
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
-
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
+    Scene *scene = pfjob->scene;
+    seq_prefetch_update_cost(pfjob, (float)((PIL_check_seconds_timer() - begin) * FPS));
+  }
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+  BKE_sequencer_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->workers_running_num--;
+  if (pfjob->workers_running_num == 0) {
+    pfjob->running = false;
   }
-
-  BKE_sequencer_cache_free_temp_cache(
-      pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return 0;
 }
 
-static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
+static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra, float cost)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
@@ -495,7 +653,7 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, SEQ_PREFETCH_WORKERS_MAX);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
@@ -503,21 +661,34 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob->bmain_eval = BKE_main_new();
 
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+        pfjob->workers[i].index = i;
+      }
     }
   }
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
+  /* Cost of the current frame is not known when it was cached, use cost measured by workers. */
+  seq_prefetch_update_scene(context->scene, max_ff(cost, pfjob->cost));
+
+  for (int i = 0; i < pfjob->workers_num; i++) {
+    seq_prefetch_update_context(context, &pfjob->workers[i]);
+  }
+
   pfjob->waiting = false;
   pfjob->stop = false;
   pfjob->running = true;
+  pfjob->workers_running_num = pfjob->workers_num;
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
+  for (int i = 0; i < pfjob->workers_num; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->workers[i]);
+  }
 
   return pfjob;
 }
@@ -543,7 +714,7 @@ void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, floa
         !(playing && cost > 0.9) && ed->cache_flag & SEQ_CACHE_ALL_TYPES && has_strips &&
         !G.is_rendering && !G.moving) {
 
-      seq_prefetch_start(context, cfra);
+      seq_prefetch_start(context, cfra, cost);
     }
   }
 }
@@ -27,7 +27,6 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #include "MEM_guardedalloc.h"
 
@@ -49,6 +48,7 @@
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -81,6 +81,8 @@
 
 #include "RNA_access.h"
 
+#include "PIL_time.h"
+
 #include "RE_pipeline.h"
 
 #include <pthread.h>
@@ -113,19 +115,31 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float cfra,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image);
 static ImBuf *seq_render_strip(const SeqRenderData *context,
                                SeqRenderState *state,
                                Sequence *seq,
                                float cfra);
+static void seq_render_strips_parallel(const SeqRenderData *context,
+                                       SeqRenderState *state,
+                                       Sequence **seqs,
+                                       const int seqs_len,
+                                       float cfra,
+                                       ImBuf **r_ibufs,
+                                       float *r_costs);
 static void seq_free_animdata(Scene *scene, Sequence *seq);
 static ImBuf *seq_render_mask(const SeqRenderData *context, Mask *mask, float nr, bool make_float);
 static int seq_num_files(Scene *scene, char views_format, const bool is_multiview);
 static void seq_anim_add_suffix(Scene *scene, struct anim *anim, const int view_id);
 
-static ThreadMutex seq_render_mutex = BLI_MUTEX_INITIALIZER;
+/* Prefetch workers render frames with their own copy of the scene, those can share
+ * seq_render_rwlock when no strip of the frame touches global state. Other renders hold it
+ * exclusively. Taking seq_render_turnstile before the lock keeps a stream of shared renders
+ * from starving the main thread. */
+static ThreadMutex seq_render_turnstile = BLI_MUTEX_INITIALIZER;
+static ThreadRWMutex seq_render_rwlock = BLI_RWLOCK_INITIALIZER;
 
 /* **** XXX ******** */
 #define SELECT 1
@@ -2967,6 +2981,9 @@ static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
       out = sh.execute(context, seq, cfra, fac, facf, NULL, NULL, NULL);
       break;
     case EARLY_DO_EFFECT:
+      if (seq->type != SEQ_TYPE_SPEED) {
+        seq_render_strips_parallel(context, state, input, 3, cfra, ibuf, NULL);
+      }
       for (i = 0; i < 3; i++) {
         /* Speed effect requires time remapping of cfra for input(s). */
         if (input[0] && seq->type == SEQ_TYPE_SPEED) {
@@ -2974,7 +2991,7 @@ static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
           ibuf[i] = seq_render_strip(context, state, input[0], target_frame);
         }
         else { /* Other effects. */
-          if (input[i]) {
+          if (input[i] && ibuf[i] == NULL) {
             ibuf[i] = seq_render_strip(context, state, input[i], cfra);
           }
         }
@@ -3125,7 +3142,7 @@ static ImBuf *seq_render_image_strip(const SeqRenderData *context,
 
       if (view_id != context->view_id) {
         ibufs_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibufs_arr[view_id], cfra, clock(), true, false);
+            &localcontext, seq, ibufs_arr[view_id], cfra, PIL_check_seconds_timer(), true, false);
       }
     }
 
@@ -3272,7 +3289,7 @@ static ImBuf *seq_render_movie_strip(
 
       if (view_id != context->view_id) {
         ibuf_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibuf_arr[view_id], cfra, clock(), true, false);
+            &localcontext, seq, ibuf_arr[view_id], cfra, PIL_check_seconds_timer(), true, false);
       }
     }
 
@@ -3838,16 +3855,17 @@ static ImBuf *do_render_strip_uncached(const SeqRenderData *context,
 }
 
 /* Estimate time spent by the program rendering the strip */
-static clock_t seq_estimate_render_cost_begin(void)
+/* Wall clock time, processor time would add up the time of all threads when strips are rendered
+ * in parallel. */
+static double seq_estimate_render_cost_begin(void)
 {
-  return clock();
+  return PIL_check_seconds_timer();
 }
 
-static float seq_estimate_render_cost_end(Scene *scene, clock_t begin)
+static float seq_estimate_render_cost_end(Scene *scene, double begin)
 {
-  clock_t end = clock();
-  float time_spent = (float)(end - begin);
-  float time_max = (1.0f / scene->r.frs_sec) * CLOCKS_PER_SEC;
+  float time_spent = (float)(PIL_check_seconds_timer() - begin);
+  float time_max = 1.0f / scene->r.frs_sec;
 
   if (time_max != 0) {
     return time_spent / time_max;
@@ -3860,7 +3878,7 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float cfra,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image)
 {
@@ -3898,7 +3916,7 @@ static ImBuf *seq_render_strip(const SeqRenderData *context,
   bool use_preprocess = false;
   bool is_proxy_image = false;
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
 
   ibuf = BKE_sequencer_cache_get(context, seq, cfra, SEQ_CACHE_STORE_PREPROCESSED, false);
   if (ibuf != NULL) {
@@ -3924,6 +3942,174 @@ static ImBuf *seq_render_strip(const SeqRenderData *context,
   return ibuf;
 }
 
+/* Strips which only read their own data when rendered, so several of them can be rendered at the
+ * same time. Scene, clip, mask, meta and effect strips can render other strips or data-blocks,
+ * those are always rendered from the calling thread. */
+static bool seq_render_strip_is_threadsafe(const Sequence *seq)
+{
+  if (!ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE, SEQ_TYPE_COLOR)) {
+    return false;
+  }
+  /* Mask modifiers render another strip. */
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_sequence) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Strips which can be rendered by prefetch workers at the same time, each worker rendering a
+ * different frame. Unlike seq_render_strip_is_threadsafe() this includes meta and effect strips,
+ * because every worker renders its own copy of them. Scene, clip, mask, text, multicam and
+ * adjustment strips use data shared between workers (render pipeline, fonts, original scene). */
+static bool seq_render_strip_is_concurrent_safe(const Sequence *seq)
+{
+  if (seq == NULL) {
+    return true;
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_sequence) {
+      return false;
+    }
+  }
+
+  switch (seq->type) {
+    case SEQ_TYPE_IMAGE:
+    case SEQ_TYPE_MOVIE:
+    case SEQ_TYPE_COLOR:
+    case SEQ_TYPE_SOUND_RAM:
+    case SEQ_TYPE_SOUND_HD:
+      return true;
+    case SEQ_TYPE_META:
+      LISTBASE_FOREACH (Sequence *, seq_child, &seq->seqbase) {
+        if (!seq_render_strip_is_concurrent_safe(seq_child)) {
+          return false;
+        }
+      }
+      return true;
+    case SEQ_TYPE_SCENE:
+    case SEQ_TYPE_MOVIECLIP:
+    case SEQ_TYPE_MASK:
+    case SEQ_TYPE_TEXT:
+    case SEQ_TYPE_MULTICAM:
+    case SEQ_TYPE_ADJUSTMENT:
+      return false;
+  }
+
+  if (seq->type & SEQ_TYPE_EFFECT) {
+    return seq_render_strip_is_concurrent_safe(seq->seq1) &&
+           seq_render_strip_is_concurrent_safe(seq->seq2) &&
+           seq_render_strip_is_concurrent_safe(seq->seq3);
+  }
+
+  return false;
+}
+
+static void seq_render_lock(const bool is_shared)
+{
+  BLI_mutex_lock(&seq_render_turnstile);
+  BLI_rw_mutex_lock(&seq_render_rwlock, is_shared ? THREAD_LOCK_READ : THREAD_LOCK_WRITE);
+  BLI_mutex_unlock(&seq_render_turnstile);
+}
+
+static void seq_render_unlock(void)
+{
+  BLI_rw_mutex_unlock(&seq_render_rwlock);
+}
+
+typedef struct SeqRenderParallelData {
+  const SeqRenderData *context;
+  SeqRenderState *state;
+  Sequence **seqs;
+  float cfra;
+  ImBuf **ibufs;
+  float *costs;
+} SeqRenderParallelData;
+
+static void seq_render_strips_parallel_task(void *__restrict userdata,
+                                            const int index,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SeqRenderParallelData *data = userdata;
+  double begin = seq_estimate_render_cost_begin();
+  data->ibufs[index] = seq_render_strip(
+      data->context, data->state, data->seqs[index], data->cfra);
+  data->costs[index] = seq_estimate_render_cost_end(data->context->scene, begin);
+}
+
+/**
+ * Render the thread-safe strips of \a seqs concurrently, their images are returned in
+ * \a r_ibufs. Entries of other strips (and NULL entries) are set to NULL, it's up to the caller
+ * to render those. When not NULL, \a r_costs gets the render cost of every returned image, so it
+ * can still be accounted for in the cost of the entries they are blended into.
+ */
+static void seq_render_strips_parallel(const SeqRenderData *context,
+                                       SeqRenderState *state,
+                                       Sequence **seqs,
+                                       const int seqs_len,
+                                       float cfra,
+                                       ImBuf **r_ibufs,
+                                       float *r_costs)
+{
+  Sequence *batch_seqs[MAXSEQ + 1];
+  ImBuf *batch_ibufs[MAXSEQ + 1];
+  float batch_costs[MAXSEQ + 1];
+  int batch_index[MAXSEQ + 1];
+  int batch_len = 0;
+
+  BLI_assert(seqs_len <= MAXSEQ + 1);
+
+  for (int i = 0; i < seqs_len; i++) {
+    r_ibufs[i] = NULL;
+    if (r_costs) {
+      r_costs[i] = 0.0f;
+    }
+    if (seqs[i] == NULL || !seq_render_strip_is_threadsafe(seqs[i])) {
+      continue;
+    }
+    /* A strip used twice would be rendered by two threads at once. */
+    bool is_duplicate = false;
+    for (int j = 0; j < batch_len; j++) {
+      if (batch_seqs[j] == seqs[i]) {
+        is_duplicate = true;
+        break;
+      }
+    }
+    if (!is_duplicate) {
+      batch_seqs[batch_len] = seqs[i];
+      batch_index[batch_len] = i;
+      batch_len++;
+    }
+  }
+
+  if (batch_len < 2) {
+    return;
+  }
+
+  SeqRenderParallelData data = {
+      .context = context,
+      .state = state,
+      .seqs = batch_seqs,
+      .cfra = cfra,
+      .ibufs = batch_ibufs,
+      .costs = batch_costs,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, batch_len, &data, seq_render_strips_parallel_task, &settings);
+
+  for (int j = 0; j < batch_len; j++) {
+    r_ibufs[batch_index[j]] = batch_ibufs[j];
+    if (r_costs) {
+      r_costs[batch_index[j]] = batch_costs[j];
+    }
+  }
+}
+
 /*********************** strip stack rendering functions *************************/
 
 static bool seq_must_swap_input_in_blend_mode(Sequence *seq)
@@ -3998,10 +4184,14 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  Sequence *render_seqs[MAXSEQ + 1] = {NULL};
+  ImBuf *render_ibufs[MAXSEQ + 1];
+  float render_costs[MAXSEQ + 1];
   int count;
   int i;
   ImBuf *out = NULL;
-  clock_t begin;
+  bool render_base = false;
+  double begin;
 
   count = BKE_sequencer_get_shown_sequences(seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
 
@@ -4019,7 +4209,7 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
       break;
     }
     if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-      out = seq_render_strip(context, state, seq, cfra);
+      render_base = true;
       break;
     }
 
@@ -4028,7 +4218,7 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     switch (early_out) {
       case EARLY_NO_INPUT:
       case EARLY_USE_INPUT_2:
-        out = seq_render_strip(context, state, seq, cfra);
+        render_base = true;
         break;
       case EARLY_USE_INPUT_1:
         if (i == 0) {
@@ -4053,11 +4243,34 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
         }
         break;
     }
-    if (out) {
+    if (out || render_base) {
       break;
     }
   }
 
+  /* The base strip and the strips blended over it don't depend on each other,
+   * render them concurrently before blending. */
+  const int render_start = max_ii(i, 0);
+  if (render_base) {
+    render_seqs[i] = seq_arr[i];
+  }
+  for (int j = i + 1; j < count; j++) {
+    if (seq_get_early_out_for_blend_mode(seq_arr[j]) == EARLY_DO_EFFECT) {
+      render_seqs[j] = seq_arr[j];
+    }
+  }
+  seq_render_strips_parallel(context,
+                             state,
+                             render_seqs + render_start,
+                             count - render_start,
+                             cfra,
+                             render_ibufs + render_start,
+                             render_costs + render_start);
+
+  if (render_base) {
+    out = render_ibufs[i] ? render_ibufs[i] : seq_render_strip(context, state, seq_arr[i], cfra);
+  }
+
   i++;
   for (; i < count; i++) {
     begin = seq_estimate_render_cost_begin();
@@ -4065,7 +4278,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
+      ImBuf *ibuf2 = render_ibufs[i] ? render_ibufs[i] :
+                                       seq_render_strip(context, state, seq, cfra);
 
       out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
 
@@ -4073,7 +4287,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
       IMB_freeImBuf(ibuf2);
     }
 
-    float cost = seq_estimate_render_cost_end(context->scene, begin);
+    /* Strips rendered concurrently weren't timed here, add their own render time. */
+    float cost = seq_estimate_render_cost_end(context->scene, begin) + render_costs[i];
     BKE_sequencer_cache_put(
         context, seq_arr[i], cfra, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
   }
@@ -4120,11 +4335,16 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
 
   BKE_sequencer_cache_free_temp_cache(context->scene, context->task_id, cfra);
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
   float cost = 0;
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    bool is_shared = context->is_prefetch_render;
+    for (int i = 0; i < count && is_shared; i++) {
+      is_shared = seq_render_strip_is_concurrent_safe(seq_arr[i]);
+    }
+
+    seq_render_lock(is_shared);
     out = seq_render_strip_stack(context, &state, seqbasep, cfra, chanshown);
     cost = seq_estimate_render_cost_end(context->scene, begin);
 
@@ -4136,7 +4356,7 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
       BKE_sequencer_cache_put_if_possible(
           context, seq_arr[count - 1], cfra, SEQ_CACHE_STORE_FINAL_OUT, out, cost, false);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    seq_render_unlock();
   }
 
   BKE_sequencer_prefetch_start(context, cfra, cost);
@@ -446,6 +446,18 @@ void BKE_undosys_stack_limit_steps_and_memory(UndoStack *ustack, int steps, size
      * (see #MemFileUndoStep). */
     undosys_stack_clear_all_first(ustack, us->prev, us_exclude);
   }
+
+  if (CLOG_CHECK(&LOG, 1)) {
+    size_t data_size_used = 0;
+    LISTBASE_FOREACH (UndoStep *, us_iter, &ustack->steps) {
+      data_size_used += us_iter->data_size;
+    }
+    CLOG_INFO(&LOG,
+              1,
+              "steps=%d, memory_used=%zu",
+              BLI_listbase_count(&ustack->steps),
+              data_size_used);
+  }
 }
 
 /** \} */
@@ -877,8 +889,9 @@ void BKE_undosys_print(UndoStack *ustack)
   printf("Undo %d Steps (*: active, #=applied, M=memfile-active, S=skip)\n",
          BLI_listbase_count(&ustack->steps));
   int index = 0;
+  size_t data_size_all = 0;
   LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
-    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s'\n",
+    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s', size=%zu\n",
            (us == ustack->step_active) ? '*' : ' ',
            us->is_applied ? '#' : ' ',
            (us == ustack->step_active_memfile) ? 'M' : ' ',
@@ -886,9 +899,12 @@ void BKE_undosys_print(UndoStack *ustack)
            index,
            (void *)us,
            us->type->name,
-           us->name);
+           us->name,
+           us->data_size);
+    data_size_all += us->data_size;
     index++;
   }
+  printf("Undo memory: %zu bytes\n", data_size_all);
 }
 
 /** \} */
@@ -143,6 +143,58 @@ MINLINE void blend_color_interpolate_float(float dst[4],
                                            const float src2[4],
                                            float t);
 
+/******************** Blending Pixel Spans **********************
+ * Blend \a pixels_num consecutive RGBA pixels, vectorized where possible.
+ * - byte functions assume straight alpha
+ * - float functions assume premultiplied alpha
+ */
+
+/* dst = src1 * (1 - fac) + src2 * fac, for bytes \a fac is in the [0..256] range. */
+void blend_color_cross_byte_n(unsigned char *dst,
+                              const unsigned char *src1,
+                              const unsigned char *src2,
+                              int fac,
+                              int pixels_num);
+void blend_color_cross_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+
+/* dst = src1 over src2, with src1 alpha scaled by \a fac. */
+void blend_color_alphaover_byte_n(unsigned char *dst,
+                                  const unsigned char *src1,
+                                  const unsigned char *src2,
+                                  float fac,
+                                  int pixels_num);
+void blend_color_alphaover_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+
+/* dst = src1 under src2, with src1 alpha scaled by \a fac. */
+void blend_color_alphaunder_byte_n(unsigned char *dst,
+                                   const unsigned char *src1,
+                                   const unsigned char *src2,
+                                   float fac,
+                                   int pixels_num);
+void blend_color_alphaunder_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+
+/* Blend modes as applied by the sequencer: src2 is blended onto src1 with the functions above,
+ * the alpha of src1 is scaled by \a fac while blending and the result keeps the alpha of src1. */
+void blend_color_add_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_sub_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_mul_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_lighten_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_darken_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_screen_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_difference_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+void blend_color_exclusion_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+
 #if BLI_MATH_DO_INLINE
 #  include "intern/math_color_blend_inline.c"
 #endif
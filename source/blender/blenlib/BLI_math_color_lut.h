@@ -0,0 +1,71 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Range of the log shaper in stops, see #BLI_color_lut3d_new. */
+#define COLOR_LUT3D_LOG_MIN -10.0f
+#define COLOR_LUT3D_LOG_MAX 6.0f
+
+/**
+ * RGB transform sampled on a regular 3D grid of nodes, applied with tetrahedral interpolation.
+ */
+typedef struct ColorLUT3D {
+  /* Number of nodes per axis. */
+  int size;
+  /* Shape the input with log2, for scene linear values. */
+  bool use_log_shaper;
+  /* Largest input value covered by the nodes, the smallest is zero. */
+  float domain_max;
+  /* Value of every node, red varying fastest. */
+  float (*table)[3];
+} ColorLUT3D;
+
+/**
+ * Create a LUT with \a size nodes per axis. The table is filled with the input value of every
+ * node, the caller transforms it in place to bake the LUT.
+ *
+ * Without shaper the nodes are evenly spread over [0, 1]. With the log shaper the nodes are
+ * spread over the stops from #COLOR_LUT3D_LOG_MIN to #COLOR_LUT3D_LOG_MAX (evenly spaced within
+ * each stop), so an unbounded scene linear input gets the same precision for dark and bright
+ * values. \a size - 1 must be a multiple of the number of stops then.
+ */
+ColorLUT3D *BLI_color_lut3d_new(int size, bool use_log_shaper);
+void BLI_color_lut3d_free(ColorLUT3D *lut);
+
+/**
+ * Apply the LUT to \a rgb.
+ * \return false when \a rgb is outside of the domain of the LUT, \a r_rgb is not written then.
+ */
+bool BLI_color_lut3d_apply_v3(const ColorLUT3D *lut, const float rgb[3], float r_rgb[3]);
+/** Apply a LUT without shaper to byte values. */
+void BLI_color_lut3d_apply_uchar3(const ColorLUT3D *lut,
+                                  const unsigned char rgb[3],
+                                  float r_rgb[3]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,49 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ * \brief Multi-threaded merge-by-distance search on flat coordinate arrays.
+ *
+ * Points are binned into a uniform grid with cells no smaller than the merge distance,
+ * so neighbors only have to be looked up in the 27 surrounding cells.
+ * Clusters are searched in parallel over the grid cells, results don't depend on the number
+ * of threads. Memory use is linear in the number of points, however many of them are close.
+ */
+
+#include "BLI_bitmap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int BLI_merge_by_distance_clusters(const float (*co)[3],
+                                   const int co_len,
+                                   const BLI_bitmap *mask,
+                                   const float dist,
+                                   const int max_interactions,
+                                   int *r_dest_map);
+
+int BLI_merge_by_distance_duplicates(const float (*co)[3],
+                                     const int co_len,
+                                     const float dist,
+                                     int *duplicates);
+
+#ifdef __cplusplus
+}
+#endif
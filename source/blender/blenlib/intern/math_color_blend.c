@@ -0,0 +1,604 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Blending of pixel spans, used by the sequencer effects.
+ *
+ * The SSE2 code paths do the same floating point operations in the same order as the scalar
+ * ones, so both give identical results.
+ */
+
+#include <string.h>
+
+#include "BLI_math_base.h"
+#include "BLI_math_color.h"
+#include "BLI_math_color_blend.h"
+#include "BLI_utildefines.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#ifdef __SSE2__
+
+/* -------------------------------------------------------------------- */
+/** \name SSE2 Pixel Conversion
+ * \{ */
+
+BLI_INLINE __m128 load_uchar4_ps(const unsigned char color[4])
+{
+  unsigned int packed;
+  memcpy(&packed, color, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  __m128i c = _mm_cvtsi32_si128((int)packed);
+  c = _mm_unpacklo_epi8(c, zero);
+  c = _mm_unpacklo_epi16(c, zero);
+  return _mm_cvtepi32_ps(c);
+}
+
+/* Same as #straight_uchar_to_premul_float. */
+BLI_INLINE __m128 straight_uchar_to_premul_ps(const unsigned char color[4])
+{
+  const float alpha = color[3] * (1.0f / 255.0f);
+  const float fac = alpha * (1.0f / 255.0f);
+  return _mm_mul_ps(load_uchar4_ps(color), _mm_setr_ps(fac, fac, fac, 1.0f / 255.0f));
+}
+
+/* mask ? a : b */
+BLI_INLINE __m128 select_ps(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/* All bits set in the alpha lane. */
+BLI_INLINE __m128 alpha_mask_ps(void)
+{
+  return _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+}
+
+/* mask ? a : b */
+BLI_INLINE __m128i select_si128(__m128 mask, __m128i a, __m128i b)
+{
+  const __m128i mask_i = _mm_castps_si128(mask);
+  return _mm_or_si128(_mm_and_si128(mask_i, a), _mm_andnot_si128(mask_i, b));
+}
+
+BLI_INLINE __m128i load_uchar4_si128(const unsigned char color[4])
+{
+  unsigned int packed;
+  memcpy(&packed, color, sizeof(packed));
+  return _mm_cvtsi32_si128((int)packed);
+}
+
+BLI_INLINE void store_uchar4_si128(unsigned char result[4], __m128i color)
+{
+  const unsigned int packed = (unsigned int)_mm_cvtsi128_si32(color);
+  memcpy(result, &packed, sizeof(packed));
+}
+
+/**
+ * Same as #premul_float_to_straight_uchar, without branches.
+ * The pixel is returned in the lowest 32 bits.
+ */
+BLI_INLINE __m128i premul_ps_to_straight_uchar(__m128 color)
+{
+  /* Alpha of zero or one leaves the color as is, multiplying by one gives the same result. */
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 is_unchanged = _mm_or_ps(_mm_cmpeq_ps(alpha, _mm_setzero_ps()),
+                                        _mm_cmpeq_ps(alpha, one));
+  const __m128 alpha_inv = select_ps(is_unchanged, one, _mm_div_ps(one, alpha));
+  /* Alpha itself is not divided. */
+  color = _mm_mul_ps(color, select_ps(alpha_mask_ps(), one, alpha_inv));
+
+  /* #unit_float_to_uchar_clamp for all channels. */
+  __m128i c = _mm_cvttps_epi32(
+      _mm_add_ps(_mm_mul_ps(color, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+  const __m128 is_low = _mm_cmple_ps(color, _mm_setzero_ps());
+  const __m128 is_high = _mm_cmpgt_ps(color, _mm_set1_ps(1.0f - 0.5f / 255.0f));
+  c = _mm_andnot_si128(_mm_castps_si128(is_low), c);
+  c = _mm_or_si128(_mm_andnot_si128(_mm_castps_si128(is_high), c),
+                   _mm_and_si128(_mm_castps_si128(is_high), _mm_set1_epi32(255)));
+  c = _mm_packs_epi32(c, c);
+  return _mm_packus_epi16(c, c);
+}
+
+/** \} */
+
+#endif /* __SSE2__ */
+
+/* -------------------------------------------------------------------- */
+/** \name Cross
+ * \{ */
+
+void blend_color_cross_byte_n(unsigned char *dst,
+                              const unsigned char *src1,
+                              const unsigned char *src2,
+                              int fac,
+                              int pixels_num)
+{
+  const int fac2 = fac;
+  const int fac1 = 256 - fac2;
+  int i = 0;
+
+#ifdef __SSE2__
+  /* 16 bit lanes can't hold the intermediate result for factors outside of the [0..256] range. */
+  if (fac2 >= 0 && fac2 <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fac1_v = _mm_set1_epi16((short)fac1);
+    const __m128i fac2_v = _mm_set1_epi16((short)fac2);
+    for (; i + 4 <= pixels_num; i += 4) {
+      const __m128i a = _mm_loadu_si128((const __m128i *)&src1[i * 4]);
+      const __m128i b = _mm_loadu_si128((const __m128i *)&src2[i * 4]);
+      __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), fac1_v),
+                                 _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), fac2_v));
+      __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), fac1_v),
+                                 _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), fac2_v));
+      lo = _mm_srli_epi16(lo, 8);
+      hi = _mm_srli_epi16(hi, 8);
+      _mm_storeu_si128((__m128i *)&dst[i * 4], _mm_packus_epi16(lo, hi));
+    }
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const unsigned char *rt1 = &src1[i * 4];
+    const unsigned char *rt2 = &src2[i * 4];
+    unsigned char *rt = &dst[i * 4];
+    rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
+    rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
+    rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
+    rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
+  }
+}
+
+void blend_color_cross_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  const float fac2 = fac;
+  const float fac1 = 1.0f - fac2;
+  int i = 0;
+
+#ifdef __SSE2__
+  const __m128 fac1_v = _mm_set1_ps(fac1);
+  const __m128 fac2_v = _mm_set1_ps(fac2);
+  for (; i < pixels_num; i++) {
+    const __m128 rt1 = _mm_loadu_ps(&src1[i * 4]);
+    const __m128 rt2 = _mm_loadu_ps(&src2[i * 4]);
+    _mm_storeu_ps(&dst[i * 4], _mm_add_ps(_mm_mul_ps(fac1_v, rt1), _mm_mul_ps(fac2_v, rt2)));
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const float *rt1 = &src1[i * 4];
+    const float *rt2 = &src2[i * 4];
+    float *rt = &dst[i * 4];
+    rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
+    rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
+    rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
+    rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Alpha Over
+ * \{ */
+
+void blend_color_alphaover_byte_n(unsigned char *dst,
+                                  const unsigned char *src1,
+                                  const unsigned char *src2,
+                                  float fac,
+                                  int pixels_num)
+{
+  if (fac <= 0.0f) {
+    memcpy(dst, src2, sizeof(unsigned char[4]) * (size_t)pixels_num);
+    return;
+  }
+
+  int i = 0;
+
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_v = _mm_set1_ps(fac);
+  for (; i < pixels_num; i++) {
+    const __m128 rt1 = straight_uchar_to_premul_ps(&src1[i * 4]);
+    const __m128 rt2 = straight_uchar_to_premul_ps(&src2[i * 4]);
+    const __m128 alpha1 = _mm_shuffle_ps(rt1, rt1, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 mfac = _mm_sub_ps(one, _mm_mul_ps(fac_v, alpha1));
+    const __m128i result = premul_ps_to_straight_uchar(
+        _mm_add_ps(_mm_mul_ps(fac_v, rt1), _mm_mul_ps(mfac, rt2)));
+    store_uchar4_si128(
+        &dst[i * 4],
+        select_si128(_mm_cmple_ps(mfac, zero), load_uchar4_si128(&src1[i * 4]), result));
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const unsigned char *cp1 = &src1[i * 4];
+    const unsigned char *cp2 = &src2[i * 4];
+    unsigned char *rt = &dst[i * 4];
+    const float mfac = 1.0f - fac * (cp1[3] * (1.0f / 255.0f));
+
+    if (mfac <= 0.0f) {
+      memcpy(rt, cp1, sizeof(unsigned char[4]));
+    }
+    else {
+      float rt1[4], rt2[4], tempc[4];
+      straight_uchar_to_premul_float(rt1, cp1);
+      straight_uchar_to_premul_float(rt2, cp2);
+      tempc[0] = fac * rt1[0] + mfac * rt2[0];
+      tempc[1] = fac * rt1[1] + mfac * rt2[1];
+      tempc[2] = fac * rt1[2] + mfac * rt2[2];
+      tempc[3] = fac * rt1[3] + mfac * rt2[3];
+      premul_float_to_straight_uchar(rt, tempc);
+    }
+  }
+}
+
+void blend_color_alphaover_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  if (fac <= 0.0f) {
+    memcpy(dst, src2, sizeof(float[4]) * (size_t)pixels_num);
+    return;
+  }
+
+  int i = 0;
+
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_v = _mm_set1_ps(fac);
+  for (; i < pixels_num; i++) {
+    const __m128 rt1 = _mm_loadu_ps(&src1[i * 4]);
+    const __m128 rt2 = _mm_loadu_ps(&src2[i * 4]);
+    const __m128 alpha1 = _mm_shuffle_ps(rt1, rt1, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 mfac = _mm_sub_ps(one, _mm_mul_ps(fac_v, alpha1));
+    const __m128 result = _mm_add_ps(_mm_mul_ps(fac_v, rt1), _mm_mul_ps(mfac, rt2));
+    _mm_storeu_ps(&dst[i * 4], select_ps(_mm_cmple_ps(mfac, zero), rt1, result));
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const float *rt1 = &src1[i * 4];
+    const float *rt2 = &src2[i * 4];
+    float *rt = &dst[i * 4];
+    const float mfac = 1.0f - (fac * rt1[3]);
+
+    if (mfac <= 0.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
+    }
+    else {
+      rt[0] = fac * rt1[0] + mfac * rt2[0];
+      rt[1] = fac * rt1[1] + mfac * rt2[1];
+      rt[2] = fac * rt1[2] + mfac * rt2[2];
+      rt[3] = fac * rt1[3] + mfac * rt2[3];
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Alpha Under
+ * \{ */
+
+void blend_color_alphaunder_byte_n(unsigned char *dst,
+                                   const unsigned char *src1,
+                                   const unsigned char *src2,
+                                   float fac,
+                                   int pixels_num)
+{
+  int i = 0;
+
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_v = _mm_set1_ps(fac);
+  /* The 'skybuf' case only depends on the alpha of src2 when the factor is one or more. */
+  const __m128 use_src1_fac = (fac >= 1.0f) ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : zero;
+  for (; i < pixels_num; i++) {
+    const __m128 rt1 = straight_uchar_to_premul_ps(&src1[i * 4]);
+    const __m128 rt2 = straight_uchar_to_premul_ps(&src2[i * 4]);
+    const __m128 alpha2 = _mm_shuffle_ps(rt2, rt2, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 mfac = _mm_mul_ps(fac_v, _mm_sub_ps(one, alpha2));
+    const __m128i result = premul_ps_to_straight_uchar(_mm_add_ps(_mm_mul_ps(mfac, rt1), rt2));
+    const __m128 use_src1 = _mm_and_ps(_mm_cmple_ps(alpha2, zero), use_src1_fac);
+    const __m128 use_src2 = _mm_or_ps(_mm_cmpge_ps(alpha2, one), _mm_cmple_ps(mfac, zero));
+    const __m128i cp1 = load_uchar4_si128(&src1[i * 4]);
+    const __m128i cp2 = load_uchar4_si128(&src2[i * 4]);
+    const __m128i result_or_src2 = select_si128(use_src2, cp2, result);
+    store_uchar4_si128(&dst[i * 4], select_si128(use_src1, cp1, result_or_src2));
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const unsigned char *cp1 = &src1[i * 4];
+    const unsigned char *cp2 = &src2[i * 4];
+    unsigned char *rt = &dst[i * 4];
+    const float alpha2 = cp2[3] * (1.0f / 255.0f);
+
+    /* This complex optimization is because the 'skybuf' can be crossed in. */
+    if (alpha2 <= 0.0f && fac >= 1.0f) {
+      memcpy(rt, cp1, sizeof(unsigned char[4]));
+      continue;
+    }
+    if (alpha2 >= 1.0f) {
+      memcpy(rt, cp2, sizeof(unsigned char[4]));
+      continue;
+    }
+    const float mfac = fac * (1.0f - alpha2);
+    if (mfac <= 0.0f) {
+      memcpy(rt, cp2, sizeof(unsigned char[4]));
+      continue;
+    }
+    float rt1[4], rt2[4], tempc[4];
+    straight_uchar_to_premul_float(rt1, cp1);
+    straight_uchar_to_premul_float(rt2, cp2);
+    tempc[0] = (mfac * rt1[0] + rt2[0]);
+    tempc[1] = (mfac * rt1[1] + rt2[1]);
+    tempc[2] = (mfac * rt1[2] + rt2[2]);
+    tempc[3] = (mfac * rt1[3] + rt2[3]);
+    premul_float_to_straight_uchar(rt, tempc);
+  }
+}
+
+void blend_color_alphaunder_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  int i = 0;
+
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_v = _mm_set1_ps(fac);
+  /* The 'skybuf' case only depends on the alpha of src2 when the factor is one or more. */
+  const __m128 use_src1_fac = (fac >= 1.0f) ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : zero;
+  for (; i < pixels_num; i++) {
+    const __m128 rt1 = _mm_loadu_ps(&src1[i * 4]);
+    const __m128 rt2 = _mm_loadu_ps(&src2[i * 4]);
+    const __m128 alpha2 = _mm_shuffle_ps(rt2, rt2, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 mfac = _mm_mul_ps(fac_v, _mm_sub_ps(one, alpha2));
+    const __m128 result = _mm_add_ps(_mm_mul_ps(mfac, rt1), rt2);
+    const __m128 use_src1 = _mm_and_ps(_mm_cmple_ps(alpha2, zero), use_src1_fac);
+    const __m128 use_src2 = _mm_or_ps(_mm_cmpge_ps(alpha2, one), _mm_cmpeq_ps(mfac, zero));
+    _mm_storeu_ps(&dst[i * 4], select_ps(use_src1, rt1, select_ps(use_src2, rt2, result)));
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const float *rt1 = &src1[i * 4];
+    const float *rt2 = &src2[i * 4];
+    float *rt = &dst[i * 4];
+
+    /* This complex optimization is because the 'skybuf' can be crossed in. */
+    if (rt2[3] <= 0 && fac >= 1.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
+    }
+    else if (rt2[3] >= 1.0f) {
+      memcpy(rt, rt2, sizeof(float[4]));
+    }
+    else {
+      const float mfac = fac * (1.0f - rt2[3]);
+
+      if (mfac == 0) {
+        memcpy(rt, rt2, sizeof(float[4]));
+      }
+      else {
+        rt[0] = mfac * rt1[0] + rt2[0];
+        rt[1] = mfac * rt1[1] + rt2[1];
+        rt[2] = mfac * rt1[2] + rt2[2];
+        rt[3] = mfac * rt1[3] + rt2[3];
+      }
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Blend Modes
+ *
+ * The SSE2 functions blend a whole pixel, the color channels are the same as the ones of the
+ * per pixel functions, alpha is overwritten by the caller.
+ * \{ */
+
+typedef void (*BlendFuncFloat)(float dst[4], const float src1[4], const float src2[4]);
+
+#ifdef __SSE2__
+typedef __m128 (*BlendFuncFloatSSE)(__m128 src1, __m128 src2);
+
+BLI_INLINE __m128 blend_add_ps(__m128 src1, __m128 src2)
+{
+  const __m128 alpha1 = _mm_shuffle_ps(src1, src1, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_add_ps(src1, _mm_mul_ps(src2, alpha1));
+}
+
+BLI_INLINE __m128 blend_sub_ps(__m128 src1, __m128 src2)
+{
+  const __m128 alpha1 = _mm_shuffle_ps(src1, src1, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_max_ps(_mm_sub_ps(src1, _mm_mul_ps(src2, alpha1)), _mm_setzero_ps());
+}
+
+BLI_INLINE __m128 blend_mul_ps(__m128 src1, __m128 src2)
+{
+  const __m128 alpha1 = _mm_shuffle_ps(src1, src1, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 t = _mm_shuffle_ps(src2, src2, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 mt = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+  return _mm_add_ps(_mm_mul_ps(mt, src1), _mm_mul_ps(_mm_mul_ps(src1, src2), alpha1));
+}
+
+/* Maximum (or minimum) of src1 and src2 remapped to the alpha of src1. */
+BLI_INLINE __m128 blend_lighten_darken_ps(__m128 src1, __m128 src2, const bool lighten)
+{
+  const __m128 alpha1 = _mm_shuffle_ps(src1, src1, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 t = _mm_shuffle_ps(src2, src2, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 mt = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+  const __m128 src2_mapped = _mm_mul_ps(src2, _mm_div_ps(alpha1, t));
+  const __m128 value = lighten ? _mm_max_ps(src1, src2_mapped) : _mm_min_ps(src1, src2_mapped);
+  return _mm_add_ps(_mm_mul_ps(mt, src1), _mm_mul_ps(t, value));
+}
+
+BLI_INLINE __m128 blend_lighten_ps(__m128 src1, __m128 src2)
+{
+  return blend_lighten_darken_ps(src1, src2, true);
+}
+
+BLI_INLINE __m128 blend_darken_ps(__m128 src1, __m128 src2)
+{
+  return blend_lighten_darken_ps(src1, src2, false);
+}
+
+/* Mix of src1 and a value computed from both colors, by the alpha of src2. */
+BLI_INLINE __m128 blend_mix_value_ps(__m128 src1, __m128 src2, __m128 value)
+{
+  const __m128 fac = _mm_shuffle_ps(src2, src2, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128 mfac = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+  return _mm_add_ps(_mm_mul_ps(value, fac), _mm_mul_ps(src1, mfac));
+}
+
+BLI_INLINE __m128 blend_screen_ps(__m128 src1, __m128 src2)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 value = _mm_max_ps(
+      _mm_sub_ps(one, _mm_mul_ps(_mm_sub_ps(one, src1), _mm_sub_ps(one, src2))),
+      _mm_setzero_ps());
+  return blend_mix_value_ps(src1, src2, value);
+}
+
+BLI_INLINE __m128 blend_difference_ps(__m128 src1, __m128 src2)
+{
+  const __m128 sign_mask = _mm_set1_ps(-0.0f);
+  const __m128 value = _mm_andnot_ps(sign_mask, _mm_sub_ps(src1, src2));
+  return blend_mix_value_ps(src1, src2, value);
+}
+
+BLI_INLINE __m128 blend_exclusion_ps(__m128 src1, __m128 src2)
+{
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 value = _mm_sub_ps(
+      half,
+      _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), _mm_sub_ps(src1, half)), _mm_sub_ps(src2, half)));
+  return blend_mix_value_ps(src1, src2, value);
+}
+#endif /* __SSE2__ */
+
+/**
+ * Blend a span the way the sequencer applies blend modes: the alpha of src1 is scaled by
+ * \a fac while blending and the result keeps the alpha of src1. Pixels of src2 with zero alpha
+ * leave src1 unchanged, like the per pixel functions.
+ */
+BLI_INLINE void blend_color_mode_float_n(float *dst,
+                                         const float *src1,
+                                         const float *src2,
+                                         float fac,
+                                         int pixels_num,
+#ifdef __SSE2__
+                                         BlendFuncFloatSSE blend_func_sse,
+#endif
+                                         BlendFuncFloat blend_func)
+{
+  int i = 0;
+
+#ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 alpha_mask = alpha_mask_ps();
+  const __m128 fac_v = _mm_setr_ps(1.0f, 1.0f, 1.0f, fac);
+  for (; i < pixels_num; i++) {
+    const __m128 rt1 = _mm_loadu_ps(&src1[i * 4]);
+    const __m128 rt2 = _mm_loadu_ps(&src2[i * 4]);
+    const __m128 rt1_fac = _mm_mul_ps(rt1, fac_v);
+    const __m128 alpha2 = _mm_shuffle_ps(rt2, rt2, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 result = select_ps(
+        _mm_cmpeq_ps(alpha2, zero), rt1_fac, blend_func_sse(rt1_fac, rt2));
+    _mm_storeu_ps(&dst[i * 4], select_ps(alpha_mask, rt1, result));
+  }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const float *rt1 = &src1[i * 4];
+    float *rt = &dst[i * 4];
+    const float rt1_fac[4] = {rt1[0], rt1[1], rt1[2], rt1[3] * fac};
+    blend_func(rt, rt1_fac, &src2[i * 4]);
+    rt[3] = rt1[3];
+  }
+}
+
+#ifdef __SSE2__
+#  define BLEND_COLOR_MODE_FLOAT_N(mode) \
+    blend_color_mode_float_n( \
+        dst, src1, src2, fac, pixels_num, blend_##mode##_ps, blend_color_##mode##_float)
+#else
+#  define BLEND_COLOR_MODE_FLOAT_N(mode) \
+    blend_color_mode_float_n(dst, src1, src2, fac, pixels_num, blend_color_##mode##_float)
+#endif
+
+void blend_color_add_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(add);
+}
+
+void blend_color_sub_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(sub);
+}
+
+void blend_color_mul_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(mul);
+}
+
+void blend_color_lighten_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(lighten);
+}
+
+void blend_color_darken_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(darken);
+}
+
+void blend_color_screen_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(screen);
+}
+
+void blend_color_difference_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(difference);
+}
+
+void blend_color_exclusion_float_n(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num)
+{
+  BLEND_COLOR_MODE_FLOAT_N(exclusion);
+}
+
+#undef BLEND_COLOR_MODE_FLOAT_N
+
+/** \} */
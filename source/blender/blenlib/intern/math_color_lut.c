@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * 3D lookup tables of RGB transforms, used to bake expensive color transforms which are applied
+ * to many pixels, like the display transform of large images.
+ */
+
+#include <math.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_color_lut.h"
+#include "BLI_utildefines.h"
+
+#define LOG_RANGE (COLOR_LUT3D_LOG_MAX - COLOR_LUT3D_LOG_MIN)
+/* 2^COLOR_LUT3D_LOG_MIN, added before taking the log so zero maps to the first node. */
+#define LOG_OFFSET (1.0f / 1024.0f)
+
+/* Log2 read from the bits of a positive float: exact on powers of two and linear in between.
+ * Cheap compared to log2f, which matters as it's done for every channel of every pixel.
+ * The slope changes at powers of two, so nodes are placed on them to interpolate smoothly. */
+BLI_INLINE float lut_log2_approx(const float x)
+{
+  union {
+    float f;
+    int32_t i;
+  } u = {x};
+  return (float)u.i * (1.0f / 8388608.0f) - 127.0f;
+}
+
+static float lut_exp2_approx(const double x)
+{
+  union {
+    float f;
+    int32_t i;
+  } u;
+  u.i = (int32_t)lround((x + 127.0) * 8388608.0);
+  return u.f;
+}
+
+static float lut_shaper_inverse(const ColorLUT3D *lut, const float t)
+{
+  if (lut->use_log_shaper) {
+    return lut_exp2_approx(COLOR_LUT3D_LOG_MIN + (double)t * LOG_RANGE) - LOG_OFFSET;
+  }
+  return t;
+}
+
+ColorLUT3D *BLI_color_lut3d_new(int size, bool use_log_shaper)
+{
+  BLI_assert(size >= 2);
+  BLI_assert(!use_log_shaper || (size - 1) % (int)LOG_RANGE == 0);
+
+  ColorLUT3D *lut = MEM_callocN(sizeof(*lut), __func__);
+  lut->size = size;
+  lut->use_log_shaper = use_log_shaper;
+  lut->domain_max = lut_shaper_inverse(lut, 1.0f);
+  lut->table = MEM_malloc_arrayN((size_t)size * size * size, sizeof(*lut->table), __func__);
+
+  float *values = MEM_malloc_arrayN(size, sizeof(float), __func__);
+  for (int i = 0; i < size; i++) {
+    values[i] = lut_shaper_inverse(lut, (float)i / (float)(size - 1));
+  }
+  /* Exact ends, so the domain check matches the nodes. */
+  values[0] = 0.0f;
+  values[size - 1] = lut->domain_max;
+
+  float(*node)[3] = lut->table;
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, node++) {
+        (*node)[0] = values[r];
+        (*node)[1] = values[g];
+        (*node)[2] = values[b];
+      }
+    }
+  }
+
+  MEM_freeN(values);
+
+  return lut;
+}
+
+void BLI_color_lut3d_free(ColorLUT3D *lut)
+{
+  MEM_freeN(lut->table);
+  MEM_freeN(lut);
+}
+
+/* Interpolate the nodes around \a co, given in node units. Tetrahedral interpolation only reads
+ * 4 of the 8 surrounding nodes, it's exact on the gray axis like trilinear interpolation. */
+BLI_INLINE void lut_interpolate(const ColorLUT3D *lut, const float co[3], float r_rgb[3])
+{
+  const int size = lut->size;
+  const int stride[3] = {1, size, size * size};
+  int node[3];
+  float fac[3];
+
+  for (int c = 0; c < 3; c++) {
+    node[c] = min_ii((int)co[c], size - 2);
+    fac[c] = co[c] - (float)node[c];
+  }
+
+  /* Walk from the first to the last node along the axes in order of decreasing factor. */
+  int axis[3];
+  if (fac[0] > fac[1]) {
+    if (fac[1] > fac[2]) {
+      ARRAY_SET_ITEMS(axis, 0, 1, 2);
+    }
+    else if (fac[0] > fac[2]) {
+      ARRAY_SET_ITEMS(axis, 0, 2, 1);
+    }
+    else {
+      ARRAY_SET_ITEMS(axis, 2, 0, 1);
+    }
+  }
+  else {
+    if (fac[2] > fac[1]) {
+      ARRAY_SET_ITEMS(axis, 2, 1, 0);
+    }
+    else if (fac[2] > fac[0]) {
+      ARRAY_SET_ITEMS(axis, 1, 2, 0);
+    }
+    else {
+      ARRAY_SET_ITEMS(axis, 1, 0, 2);
+    }
+  }
+
+  const float(*n0)[3] = lut->table + node[0] * stride[0] + node[1] * stride[1] +
+                        node[2] * stride[2];
+  const float(*n1)[3] = n0 + stride[axis[0]];
+  const float(*n2)[3] = n1 + stride[axis[1]];
+  const float(*n3)[3] = n2 + stride[axis[2]];
+  const float w0 = 1.0f - fac[axis[0]];
+  const float w1 = fac[axis[0]] - fac[axis[1]];
+  const float w2 = fac[axis[1]] - fac[axis[2]];
+  const float w3 = fac[axis[2]];
+
+  for (int c = 0; c < 3; c++) {
+    r_rgb[c] = w0 * (*n0)[c] + w1 * (*n1)[c] + w2 * (*n2)[c] + w3 * (*n3)[c];
+  }
+}
+
+bool BLI_color_lut3d_apply_v3(const ColorLUT3D *lut, const float rgb[3], float r_rgb[3])
+{
+  const float scale = (float)(lut->size - 1);
+  float co[3];
+
+  for (int c = 0; c < 3; c++) {
+    /* Written so NaN is outside of the domain too. */
+    if (!(rgb[c] >= 0.0f && rgb[c] <= lut->domain_max)) {
+      return false;
+    }
+    if (lut->use_log_shaper) {
+      co[c] = (lut_log2_approx(rgb[c] + LOG_OFFSET) - COLOR_LUT3D_LOG_MIN) * (scale / LOG_RANGE);
+      CLAMP(co[c], 0.0f, scale);
+    }
+    else {
+      co[c] = rgb[c] * scale;
+    }
+  }
+
+  lut_interpolate(lut, co, r_rgb);
+  return true;
+}
+
+void BLI_color_lut3d_apply_uchar3(const ColorLUT3D *lut,
+                                  const unsigned char rgb[3],
+                                  float r_rgb[3])
+{
+  BLI_assert(!lut->use_log_shaper);
+
+  const float scale = (float)(lut->size - 1) / 255.0f;
+  const float co[3] = {(float)rgb[0] * scale, (float)rgb[1] * scale, (float)rgb[2] * scale};
+
+  lut_interpolate(lut, co, r_rgb);
+}
@@ -0,0 +1,509 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Merge-by-distance kernel shared by the weld modifier and the remove doubles operator.
+ *
+ * Points are sorted by the cell of a uniform grid they fall into, then by their coordinates, so
+ * points at exactly the same location form runs that are searched once. Neighbors are never
+ * stored: clusters are joined directly in a lock-free disjoint set while searching the cells in
+ * parallel, duplicates are claimed by the first point visiting them.
+ */
+
+#include <algorithm>
+#include <atomic>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_merge_by_distance.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#ifdef WITH_TBB
+/* Quiet top level deprecation message, unrelated to API usage here. */
+#  define TBB_SUPPRESS_DEPRECATED_MESSAGES 1
+#  include <tbb/parallel_sort.h>
+#endif
+
+namespace blender::merge_by_distance {
+
+/* Bits used for each axis of a cell key, cells are made bigger when the grid doesn't fit. */
+#define CELL_AXIS_BITS 21
+#define CELL_AXIS_MAX ((1 << CELL_AXIS_BITS) - 1)
+
+struct CellPoint {
+  uint64_t key;
+  int index;
+};
+
+BLI_INLINE uint64_t cell_key(const int x, const int y, const int z)
+{
+  return ((uint64_t)x << (2 * CELL_AXIS_BITS)) | ((uint64_t)y << CELL_AXIS_BITS) | (uint64_t)z;
+}
+
+struct PointGrid {
+  const float (*co)[3];
+  float range_sq;
+
+  /** Points sorted by cell, then by coordinates, then by index. */
+  Array<CellPoint> points;
+  /** Ranges in #points of points with the same coordinates, sorted by index. */
+  Array<int> run_offsets;
+  /** Unique cell keys, and the range of each cell in #run_offsets. */
+  Array<uint64_t> cell_keys;
+  Array<int> cell_run_offsets;
+
+  int run_len(const int run) const
+  {
+    return run_offsets[run + 1] - run_offsets[run];
+  }
+  const float *run_co(const int run) const
+  {
+    return co[points[run_offsets[run]].index];
+  }
+};
+
+struct CellPointCmp {
+  const float (*co)[3];
+
+  bool operator()(const CellPoint &a, const CellPoint &b) const
+  {
+    if (a.key != b.key) {
+      return a.key < b.key;
+    }
+    const float *co_a = co[a.index], *co_b = co[b.index];
+    for (int axis = 0; axis < 3; axis++) {
+      if (co_a[axis] != co_b[axis]) {
+        return co_a[axis] < co_b[axis];
+      }
+    }
+    return a.index < b.index;
+  }
+};
+
+static void point_grid_build(PointGrid &grid,
+                             const float (*co)[3],
+                             const int co_len,
+                             const BLI_bitmap *mask,
+                             const float dist)
+{
+  float min[3], max[3];
+  int points_len = 0;
+
+  INIT_MINMAX(min, max);
+  for (int i = 0; i < co_len; i++) {
+    if (mask == nullptr || BLI_BITMAP_TEST(mask, i)) {
+      minmax_v3v3_v3(min, max, co[i]);
+      points_len++;
+    }
+  }
+
+  /* Cells can't be smaller than the search range, but they may need to grow so the
+   * whole bounds fit in the key. A zero distance still needs a non-degenerate cell. */
+  float cell_size = max_ff(dist, FLT_EPSILON);
+  for (int axis = 0; axis < 3 && points_len; axis++) {
+    cell_size = max_ff(cell_size, (max[axis] - min[axis]) / (float)(CELL_AXIS_MAX - 1));
+  }
+  const float cell_size_inv = 1.0f / cell_size;
+
+  grid.co = co;
+  grid.points = Array<CellPoint>(points_len);
+  for (int i = 0, p = 0; i < co_len; i++) {
+    if (mask == nullptr || BLI_BITMAP_TEST(mask, i)) {
+      int cell[3];
+      for (int axis = 0; axis < 3; axis++) {
+        cell[axis] = clamp_i((int)((co[i][axis] - min[axis]) * cell_size_inv), 0, CELL_AXIS_MAX);
+      }
+      grid.points[p].key = cell_key(cell[0], cell[1], cell[2]);
+      grid.points[p].index = i;
+      p++;
+    }
+  }
+
+  const CellPointCmp cmp = {co};
+#ifdef WITH_TBB
+  tbb::parallel_sort(grid.points.begin(), grid.points.end(), cmp);
+#else
+  std::sort(grid.points.begin(), grid.points.end(), cmp);
+#endif
+
+  int runs_len = 0, cells_len = 0;
+  for (int p = 0; p < points_len; p++) {
+    if (p == 0 || grid.points[p].key != grid.points[p - 1].key) {
+      cells_len++;
+      runs_len++;
+    }
+    else if (!equals_v3v3(co[grid.points[p].index], co[grid.points[p - 1].index])) {
+      runs_len++;
+    }
+  }
+
+  grid.run_offsets = Array<int>(runs_len + 1);
+  grid.cell_keys = Array<uint64_t>(cells_len);
+  grid.cell_run_offsets = Array<int>(cells_len + 1);
+  for (int p = 0, r = 0, c = 0; p < points_len; p++) {
+    if (p == 0 || grid.points[p].key != grid.points[p - 1].key) {
+      grid.cell_keys[c] = grid.points[p].key;
+      grid.cell_run_offsets[c] = r;
+      grid.run_offsets[r] = p;
+      c++;
+      r++;
+    }
+    else if (!equals_v3v3(co[grid.points[p].index], co[grid.points[p - 1].index])) {
+      grid.run_offsets[r] = p;
+      r++;
+    }
+  }
+  grid.run_offsets[runs_len] = points_len;
+  grid.cell_run_offsets[cells_len] = runs_len;
+}
+
+/**
+ * Collect the (up to 27) non-empty cells around \a cell, in ascending key order.
+ * Cells sharing the same x and y are contiguous in the sorted keys, so only one
+ * binary search is needed per column of three cells.
+ * \return the number of cells written to \a r_cells.
+ */
+static int point_grid_cell_neighbors(const PointGrid &grid, const int cell, int r_cells[27])
+{
+  const uint64_t key = grid.cell_keys[cell];
+  const int x = (int)(key >> (2 * CELL_AXIS_BITS));
+  const int y = (int)((key >> CELL_AXIS_BITS) & CELL_AXIS_MAX);
+  const int z = (int)(key & CELL_AXIS_MAX);
+  const uint64_t *keys_begin = grid.cell_keys.begin();
+  const uint64_t *keys_end = grid.cell_keys.end();
+  const uint64_t *search_begin = keys_begin;
+  int cells_len = 0;
+
+  for (int dx = -1; dx <= 1; dx++) {
+    if (!IN_RANGE_INCL(x + dx, 0, CELL_AXIS_MAX)) {
+      continue;
+    }
+    for (int dy = -1; dy <= 1; dy++) {
+      if (!IN_RANGE_INCL(y + dy, 0, CELL_AXIS_MAX)) {
+        continue;
+      }
+      const uint64_t key_first = cell_key(x + dx, y + dy, max_ii(z - 1, 0));
+      const uint64_t key_last = cell_key(x + dx, y + dy, min_ii(z + 1, CELL_AXIS_MAX));
+      const uint64_t *found;
+      if (dx == 0 && dy == 0) {
+        /* The column of this cell, no need to search. */
+        found = &keys_begin[(cell > 0 && keys_begin[cell - 1] >= key_first) ? cell - 1 : cell];
+      }
+      else {
+        /* Columns are visited in ascending key order, so the search range shrinks. */
+        found = std::lower_bound(search_begin, keys_end, key_first);
+      }
+      for (; found != keys_end && *found <= key_last; found++) {
+        r_cells[cells_len++] = (int)(found - keys_begin);
+      }
+      search_begin = found;
+    }
+  }
+  return cells_len;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Lock-free Disjoint Set
+ *
+ * Roots are always linked below the lower root, so the root of a set is its lowest index and
+ * the result doesn't depend on the order joins happen in.
+ * \{ */
+
+static int parent_find_root(std::atomic<int> *parent, int x)
+{
+  while (true) {
+    const int p = parent[x].load(std::memory_order_relaxed);
+    if (p == x) {
+      return x;
+    }
+    /* Path halving, when another thread changed the parent the path only stays longer. */
+    int p_expect = p;
+    const int gp = parent[p].load(std::memory_order_relaxed);
+    parent[x].compare_exchange_weak(p_expect, gp, std::memory_order_relaxed);
+    x = gp;
+  }
+}
+
+static bool parent_join(std::atomic<int> *parent, int a, int b)
+{
+  while (true) {
+    a = parent_find_root(parent, a);
+    b = parent_find_root(parent, b);
+    if (a == b) {
+      return false;
+    }
+    if (a < b) {
+      std::swap(a, b);
+    }
+    int a_expect = a;
+    if (parent[a].compare_exchange_weak(a_expect, b, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+/** \} */
+
+struct ClusterData {
+  const PointGrid *grid;
+  std::atomic<int> *parent;
+  int max_interactions;
+};
+
+/**
+ * Join all points of the runs in \a cell with each other and with the runs in range.
+ * Every pair of runs is only tested from the lower run.
+ */
+static void cluster_cell_join_all(const ClusterData &data, const int cell)
+{
+  const PointGrid &grid = *data.grid;
+  int cells_other[27];
+  const int cells_other_len = point_grid_cell_neighbors(grid, cell, cells_other);
+
+  for (int run = grid.cell_run_offsets[cell]; run < grid.cell_run_offsets[cell + 1]; run++) {
+    const int head = grid.points[grid.run_offsets[run]].index;
+    for (int p = grid.run_offsets[run] + 1; p < grid.run_offsets[run + 1]; p++) {
+      parent_join(data.parent, head, grid.points[p].index);
+    }
+
+    const float *co = grid.run_co(run);
+    for (int c = 0; c < cells_other_len; c++) {
+      const int cell_other = cells_other[c];
+      const int run_other_end = grid.cell_run_offsets[cell_other + 1];
+      for (int run_other = max_ii(grid.cell_run_offsets[cell_other], run + 1);
+           run_other < run_other_end;
+           run_other++) {
+        const int head_other = grid.points[grid.run_offsets[run_other]].index;
+        /* Checking the roots first skips the distance test in dense clusters. */
+        if (parent_find_root(data.parent, head) == parent_find_root(data.parent, head_other)) {
+          continue;
+        }
+        if (len_squared_v3v3(co, grid.run_co(run_other)) <= grid.range_sq) {
+          parent_join(data.parent, head, head_other);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Join every point in \a cell with its \a max_interactions lowest neighbors of higher index.
+ * Runs are sorted by index, so only the first candidates of each run in range are considered.
+ */
+static void cluster_cell_join_limited(const ClusterData &data,
+                                      const int cell,
+                                      Vector<int> &r_candidates)
+{
+  const PointGrid &grid = *data.grid;
+  int cells_other[27];
+  const int cells_other_len = point_grid_cell_neighbors(grid, cell, cells_other);
+
+  for (int run = grid.cell_run_offsets[cell]; run < grid.cell_run_offsets[cell + 1]; run++) {
+    const float *co = grid.run_co(run);
+    for (int p = grid.run_offsets[run]; p < grid.run_offsets[run + 1]; p++) {
+      const int index = grid.points[p].index;
+      r_candidates.clear();
+
+      for (int c = 0; c < cells_other_len; c++) {
+        const int cell_other = cells_other[c];
+        for (int run_other = grid.cell_run_offsets[cell_other];
+             run_other < grid.cell_run_offsets[cell_other + 1];
+             run_other++) {
+          if (run_other != run && len_squared_v3v3(co, grid.run_co(run_other)) > grid.range_sq) {
+            continue;
+          }
+          const CellPoint *run_begin = &grid.points[grid.run_offsets[run_other]];
+          const CellPoint *run_end = run_begin + grid.run_len(run_other);
+          const CellPoint *higher = std::upper_bound(
+              run_begin, run_end, index, [](const int value, const CellPoint &point) {
+                return value < point.index;
+              });
+          for (int i = 0; higher != run_end && i < data.max_interactions; higher++, i++) {
+            r_candidates.append(higher->index);
+          }
+        }
+      }
+
+      const int candidates_len = min_ii((int)r_candidates.size(), data.max_interactions);
+      std::partial_sort(
+          r_candidates.begin(), r_candidates.begin() + candidates_len, r_candidates.end());
+      for (int i = 0; i < candidates_len; i++) {
+        parent_join(data.parent, index, r_candidates[i]);
+      }
+    }
+  }
+}
+
+static void cluster_task(void *__restrict userdata,
+                         const int cell,
+                         const TaskParallelTLS *__restrict /*tls*/)
+{
+  const ClusterData &data = *(const ClusterData *)userdata;
+  if (data.max_interactions > 0) {
+    Vector<int> candidates;
+    cluster_cell_join_limited(data, cell, candidates);
+  }
+  else {
+    cluster_cell_join_all(data, cell);
+  }
+}
+
+}  // namespace blender::merge_by_distance
+
+using namespace blender;
+using namespace blender::merge_by_distance;
+
+/**
+ * Find clusters of points closer than \a dist from each other, merges are transitive
+ * so a chain of close points ends up in a single cluster.
+ *
+ * \param mask: When not null, only points enabled in the mask are considered.
+ * \param max_interactions: Limit the number of neighbors linked to each point,
+ * only the lowest indices are used. Zero means no limit.
+ * \param r_dest_map: Array of \a co_len items, set to -1 for points that aren't merged,
+ * otherwise the lowest index of the cluster the point belongs to.
+ * \return The number of points merged into another one.
+ */
+int BLI_merge_by_distance_clusters(const float (*co)[3],
+                                   const int co_len,
+                                   const BLI_bitmap *mask,
+                                   const float dist,
+                                   const int max_interactions,
+                                   int *r_dest_map)
+{
+  PointGrid grid;
+  grid.range_sq = square_f(dist);
+  point_grid_build(grid, co, co_len, mask, dist);
+
+  Array<std::atomic<int>> parent(co_len);
+  for (int i = 0; i < co_len; i++) {
+    parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  ClusterData data = {&grid, parent.data(), max_interactions};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, (int)grid.cell_keys.size(), &data, cluster_task, &settings);
+
+  /* Points are only left out when they're the root of a set of their own. */
+  int merged_len = 0;
+  for (int i = 0; i < co_len; i++) {
+    r_dest_map[i] = -1;
+  }
+  for (int i = 0; i < co_len; i++) {
+    const int root = parent_find_root(parent.data(), i);
+    if (root != i) {
+      r_dest_map[i] = r_dest_map[root] = root;
+      merged_len++;
+    }
+  }
+  return merged_len;
+}
+
+/**
+ * Find duplicate points in \a dist, gives the same result as
+ * #BLI_kdtree_3d_calc_duplicates_fast with `use_index_order` enabled.
+ * Points are visited by index, every unmerged point within range of the visited point
+ * is merged into it, so merging is always a single step.
+ *
+ * \note Without `use_index_order` the KD-tree visits points in the order of its balanced nodes.
+ * Groups only match that order when they are further apart than \a dist. For chained points,
+ * each closer than \a dist to the next, the visit order decides which points are merged:
+ * with points at 0.9, 0.0 and 1.8 and a distance of 1.0, visiting the point at 0.0 first only
+ * merges the point at 0.9 into it, visiting the point at 0.9 first merges all three.
+ *
+ * \param duplicates: An array of \a co_len items, values initialized to -1 are candidates
+ * to be merged. Setting the index to its own position in the array prevents it from being
+ * touched, although it can still be used as a target.
+ * \return The number of merges found.
+ */
+int BLI_merge_by_distance_duplicates(const float (*co)[3],
+                                     const int co_len,
+                                     const float dist,
+                                     int *duplicates)
+{
+  PointGrid grid;
+  grid.range_sq = square_f(dist);
+  point_grid_build(grid, co, co_len, nullptr, dist);
+
+  /* Points in each cell and run, to find the neighbors of a point from its index. */
+  Array<int> point_run(co_len);
+  const int cells_len = (int)grid.cell_keys.size();
+  Array<int> run_cell(grid.run_offsets.size() - 1);
+  for (int cell = 0; cell < cells_len; cell++) {
+    for (int run = grid.cell_run_offsets[cell]; run < grid.cell_run_offsets[cell + 1]; run++) {
+      run_cell[run] = cell;
+      for (int p = grid.run_offsets[run]; p < grid.run_offsets[run + 1]; p++) {
+        point_run[grid.points[p].index] = run;
+      }
+    }
+  }
+
+  /* Every unmerged point of a run is claimed the first time the run is in range of a visited
+   * point, after that the run never has to be looked at again. This keeps the search linear
+   * for any number of points at the same location. */
+  Array<bool> run_done(run_cell.size(), false);
+
+  int found = 0;
+  for (int i = 0; i < co_len; i++) {
+    if (!ELEM(duplicates[i], -1, i)) {
+      continue;
+    }
+    const int run = point_run[i];
+    int cells_other[27];
+    const int cells_other_len = point_grid_cell_neighbors(grid, run_cell[run], cells_other);
+    const int found_prev = found;
+
+    for (int c = 0; c < cells_other_len; c++) {
+      const int cell_other = cells_other[c];
+      for (int run_other = grid.cell_run_offsets[cell_other];
+           run_other < grid.cell_run_offsets[cell_other + 1];
+           run_other++) {
+        if (run_done[run_other] ||
+            len_squared_v3v3(co[i], grid.run_co(run_other)) > grid.range_sq) {
+          continue;
+        }
+        bool is_done = true;
+        for (int p = grid.run_offsets[run_other]; p < grid.run_offsets[run_other + 1]; p++) {
+          const int index_other = grid.points[p].index;
+          if (duplicates[index_other] == -1) {
+            if (index_other == i) {
+              /* Only known to be a target once something was merged into it. */
+              is_done = false;
+              continue;
+            }
+            duplicates[index_other] = i;
+            found++;
+          }
+        }
+        run_done[run_other] = is_done;
+      }
+    }
+    if (found != found_prev) {
+      /* Prevent chains of doubles. */
+      duplicates[i] = i;
+    }
+  }
+  return found;
+}
@@ -0,0 +1,255 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "BLI_math.h"
+#include "BLI_math_color_blend.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+/* Odd, so the vectorized code paths also have to handle a tail of pixels. */
+static const int pixels_num = 67;
+
+static const float factors[] = {-0.5f, 0.0f, 0.001f, 0.25f, 0.5f, 0.75f, 0.999f, 1.0f, 1.5f};
+
+/* Random pixels, every pixel with an alpha of exactly zero or one is included a few times. */
+static Vector<unsigned char> random_pixels_byte(RandomNumberGenerator &rng)
+{
+  Vector<unsigned char> pixels(pixels_num * 4);
+  for (int i = 0; i < pixels_num * 4; i++) {
+    pixels[i] = (unsigned char)rng.get_int32(256);
+  }
+  for (int i = 0; i < pixels_num; i += 5) {
+    pixels[i * 4 + 3] = (i % 10) ? 255 : 0;
+  }
+  return pixels;
+}
+
+static Vector<float> random_pixels_float(RandomNumberGenerator &rng)
+{
+  Vector<float> pixels(pixels_num * 4);
+  for (int i = 0; i < pixels_num * 4; i++) {
+    pixels[i] = rng.get_float() * 1.2f - 0.1f;
+  }
+  for (int i = 0; i < pixels_num; i += 5) {
+    pixels[i * 4 + 3] = (i % 10) ? 1.0f : 0.0f;
+  }
+  return pixels;
+}
+
+/* Reference implementations, a pixel at a time. */
+
+static void cross_byte_ref(unsigned char *rt,
+                           const unsigned char *rt1,
+                           const unsigned char *rt2,
+                           int fac)
+{
+  for (int i = 0; i < 4; i++) {
+    rt[i] = ((256 - fac) * rt1[i] + fac * rt2[i]) >> 8;
+  }
+}
+
+static void alphaover_byte_ref(unsigned char *rt,
+                               const unsigned char *cp1,
+                               const unsigned char *cp2,
+                               float fac)
+{
+  float rt1[4], rt2[4], tempc[4];
+  straight_uchar_to_premul_float(rt1, cp1);
+  straight_uchar_to_premul_float(rt2, cp2);
+  const float mfac = 1.0f - fac * rt1[3];
+  if (fac <= 0.0f) {
+    memcpy(rt, cp2, 4);
+  }
+  else if (mfac <= 0.0f) {
+    memcpy(rt, cp1, 4);
+  }
+  else {
+    for (int i = 0; i < 4; i++) {
+      tempc[i] = fac * rt1[i] + mfac * rt2[i];
+    }
+    premul_float_to_straight_uchar(rt, tempc);
+  }
+}
+
+static void alphaunder_byte_ref(unsigned char *rt,
+                                const unsigned char *cp1,
+                                const unsigned char *cp2,
+                                float fac)
+{
+  float rt1[4], rt2[4], tempc[4];
+  straight_uchar_to_premul_float(rt1, cp1);
+  straight_uchar_to_premul_float(rt2, cp2);
+  if (rt2[3] <= 0.0f && fac >= 1.0f) {
+    memcpy(rt, cp1, 4);
+  }
+  else if (rt2[3] >= 1.0f) {
+    memcpy(rt, cp2, 4);
+  }
+  else {
+    const float mfac = fac * (1.0f - rt2[3]);
+    if (mfac <= 0.0f) {
+      memcpy(rt, cp2, 4);
+    }
+    else {
+      for (int i = 0; i < 4; i++) {
+        tempc[i] = mfac * rt1[i] + rt2[i];
+      }
+      premul_float_to_straight_uchar(rt, tempc);
+    }
+  }
+}
+
+static void cross_float_ref(float *rt, const float *rt1, const float *rt2, float fac)
+{
+  for (int i = 0; i < 4; i++) {
+    rt[i] = (1.0f - fac) * rt1[i] + fac * rt2[i];
+  }
+}
+
+static void alphaover_float_ref(float *rt, const float *rt1, const float *rt2, float fac)
+{
+  const float mfac = 1.0f - fac * rt1[3];
+  if (fac <= 0.0f) {
+    copy_v4_v4(rt, rt2);
+  }
+  else if (mfac <= 0.0f) {
+    copy_v4_v4(rt, rt1);
+  }
+  else {
+    for (int i = 0; i < 4; i++) {
+      rt[i] = fac * rt1[i] + mfac * rt2[i];
+    }
+  }
+}
+
+static void alphaunder_float_ref(float *rt, const float *rt1, const float *rt2, float fac)
+{
+  if (rt2[3] <= 0.0f && fac >= 1.0f) {
+    copy_v4_v4(rt, rt1);
+  }
+  else if (rt2[3] >= 1.0f) {
+    copy_v4_v4(rt, rt2);
+  }
+  else {
+    const float mfac = fac * (1.0f - rt2[3]);
+    if (mfac == 0.0f) {
+      copy_v4_v4(rt, rt2);
+    }
+    else {
+      for (int i = 0; i < 4; i++) {
+        rt[i] = mfac * rt1[i] + rt2[i];
+      }
+    }
+  }
+}
+
+template<typename BlendFn, typename RefFn>
+static void test_blend_byte(BlendFn blend_fn, RefFn ref_fn, float fac_ref_scale)
+{
+  RandomNumberGenerator rng(42);
+  const Vector<unsigned char> src1 = random_pixels_byte(rng);
+  const Vector<unsigned char> src2 = random_pixels_byte(rng);
+
+  for (const float fac : factors) {
+    Vector<unsigned char> result(pixels_num * 4);
+    Vector<unsigned char> expected(pixels_num * 4);
+    blend_fn(result.data(), src1.data(), src2.data(), fac * fac_ref_scale, pixels_num);
+    for (int i = 0; i < pixels_num; i++) {
+      ref_fn(&expected[i * 4], &src1[i * 4], &src2[i * 4], fac * fac_ref_scale);
+    }
+    for (int i = 0; i < pixels_num * 4; i++) {
+      EXPECT_EQ(result[i], expected[i]) << "factor " << fac << ", index " << i;
+    }
+  }
+}
+
+template<typename BlendFn, typename RefFn>
+static void test_blend_float(BlendFn blend_fn, RefFn ref_fn)
+{
+  RandomNumberGenerator rng(42);
+  const Vector<float> src1 = random_pixels_float(rng);
+  const Vector<float> src2 = random_pixels_float(rng);
+
+  for (const float fac : factors) {
+    Vector<float> result(pixels_num * 4);
+    Vector<float> expected(pixels_num * 4);
+    blend_fn(result.data(), src1.data(), src2.data(), fac, pixels_num);
+    for (int i = 0; i < pixels_num; i++) {
+      ref_fn(&expected[i * 4], &src1[i * 4], &src2[i * 4], fac);
+    }
+    for (int i = 0; i < pixels_num * 4; i++) {
+      EXPECT_FLOAT_EQ(result[i], expected[i]) << "factor " << fac << ", index " << i;
+    }
+  }
+}
+
+TEST(math_color_blend, CrossByte)
+{
+  test_blend_byte(
+      [](unsigned char *dst,
+         const unsigned char *src1,
+         const unsigned char *src2,
+         float fac,
+         int len) { blend_color_cross_byte_n(dst, src1, src2, (int)fac, len); },
+      [](unsigned char *rt, const unsigned char *rt1, const unsigned char *rt2, float fac) {
+        cross_byte_ref(rt, rt1, rt2, (int)fac);
+      },
+      256.0f);
+}
+
+TEST(math_color_blend, AlphaOverByte)
+{
+  test_blend_byte(blend_color_alphaover_byte_n, alphaover_byte_ref, 1.0f);
+}
+
+TEST(math_color_blend, AlphaUnderByte)
+{
+  test_blend_byte(blend_color_alphaunder_byte_n, alphaunder_byte_ref, 1.0f);
+}
+
+TEST(math_color_blend, CrossFloat)
+{
+  test_blend_float(blend_color_cross_float_n, cross_float_ref);
+}
+
+TEST(math_color_blend, AlphaOverFloat)
+{
+  test_blend_float(blend_color_alphaover_float_n, alphaover_float_ref);
+}
+
+TEST(math_color_blend, AlphaUnderFloat)
+{
+  test_blend_float(blend_color_alphaunder_float_n, alphaunder_float_ref);
+}
+
+/* Blend modes the way the sequencer applied them a pixel at a time. */
+template<void (*blend_fn)(float dst[4], const float src1[4], const float src2[4])>
+static void blend_mode_float_ref(float *rt, const float *rt1, const float *rt2, float fac)
+{
+  float rt1_fac[4];
+  copy_v4_v4(rt1_fac, rt1);
+  rt1_fac[3] *= fac;
+  blend_fn(rt, rt1_fac, rt2);
+  rt[3] = rt1[3];
+}
+
+TEST(math_color_blend, BlendModesFloat)
+{
+  test_blend_float(blend_color_add_float_n, blend_mode_float_ref<blend_color_add_float>);
+  test_blend_float(blend_color_sub_float_n, blend_mode_float_ref<blend_color_sub_float>);
+  test_blend_float(blend_color_mul_float_n, blend_mode_float_ref<blend_color_mul_float>);
+  test_blend_float(blend_color_lighten_float_n, blend_mode_float_ref<blend_color_lighten_float>);
+  test_blend_float(blend_color_darken_float_n, blend_mode_float_ref<blend_color_darken_float>);
+  test_blend_float(blend_color_screen_float_n, blend_mode_float_ref<blend_color_screen_float>);
+  test_blend_float(blend_color_difference_float_n,
+                   blend_mode_float_ref<blend_color_difference_float>);
+  test_blend_float(blend_color_exclusion_float_n,
+                   blend_mode_float_ref<blend_color_exclusion_float>);
+}
+
+}  // namespace blender::tests
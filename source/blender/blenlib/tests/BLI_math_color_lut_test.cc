@@ -0,0 +1,147 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "BLI_math.h"
+#include "BLI_math_color_lut.h"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+/* Sizes used for the display transform of byte and float buffers. */
+static const int byte_lut_size = 52;
+static const int float_lut_size = 65;
+
+/* Display transform of the fallback color management configuration, with an exposure. */
+static void display_transform(float rgb[3])
+{
+  for (int c = 0; c < 3; c++) {
+    rgb[c] = linearrgb_to_srgb(rgb[c] * 2.0f);
+  }
+}
+
+static void bake(ColorLUT3D *lut, void (*transform)(float rgb[3]))
+{
+  const int len = lut->size * lut->size * lut->size;
+  for (int i = 0; i < len; i++) {
+    transform(lut->table[i]);
+  }
+}
+
+static void byte_transform(float rgb[3])
+{
+  for (int c = 0; c < 3; c++) {
+    rgb[c] = srgb_to_linearrgb(rgb[c]);
+  }
+  display_transform(rgb);
+}
+
+TEST(math_color_lut, ByteNodes)
+{
+  ColorLUT3D *lut = BLI_color_lut3d_new(byte_lut_size, false);
+  bake(lut, byte_transform);
+
+  /* Byte values on nodes are transformed exactly. */
+  for (int i = 0; i < 256; i += 5) {
+    const unsigned char rgb[3] = {(unsigned char)i, (unsigned char)(255 - i), 0};
+    float expected[3] = {i / 255.0f, (255 - i) / 255.0f, 0.0f};
+    float result[3];
+    byte_transform(expected);
+    BLI_color_lut3d_apply_uchar3(lut, rgb, result);
+    EXPECT_V3_NEAR(result, expected, 1e-5f);
+  }
+
+  BLI_color_lut3d_free(lut);
+}
+
+TEST(math_color_lut, ByteAccuracy)
+{
+  ColorLUT3D *lut = BLI_color_lut3d_new(byte_lut_size, false);
+  bake(lut, byte_transform);
+
+  /* Every gray and a random sample of colors, compared with the exact transform. */
+  RandomNumberGenerator rng(0);
+  float max_error = 0.0f;
+  for (int i = 0; i < 256 + 100000; i++) {
+    unsigned char rgb[3];
+    if (i < 256) {
+      rgb[0] = rgb[1] = rgb[2] = (unsigned char)i;
+    }
+    else {
+      for (int c = 0; c < 3; c++) {
+        rgb[c] = (unsigned char)rng.get_int32(256);
+      }
+    }
+    float expected[3] = {rgb[0] / 255.0f, rgb[1] / 255.0f, rgb[2] / 255.0f};
+    float result[3];
+    byte_transform(expected);
+    BLI_color_lut3d_apply_uchar3(lut, rgb, result);
+    for (int c = 0; c < 3; c++) {
+      max_error = max_ff(max_error, fabsf(result[c] - expected[c]));
+    }
+  }
+
+  /* Within half a step of the display byte buffer, rounding changes by one step at most. */
+  EXPECT_LT(max_error, 0.5f / 255.0f);
+
+  BLI_color_lut3d_free(lut);
+}
+
+TEST(math_color_lut, FloatAccuracy)
+{
+  ColorLUT3D *lut = BLI_color_lut3d_new(float_lut_size, true);
+  bake(lut, display_transform);
+
+  /* Scene linear colors evenly spread in stops over the domain, plus exact zeros. */
+  RandomNumberGenerator rng(0);
+  float max_error = 0.0f;
+  for (int i = 0; i < 100000; i++) {
+    float rgb[3];
+    for (int c = 0; c < 3; c++) {
+      const float stops = COLOR_LUT3D_LOG_MIN +
+                          rng.get_float() * (COLOR_LUT3D_LOG_MAX - COLOR_LUT3D_LOG_MIN);
+      rgb[c] = (rng.get_int32(16) == 0) ? 0.0f : min_ff(exp2f(stops), lut->domain_max);
+    }
+    float expected[3] = {rgb[0], rgb[1], rgb[2]};
+    float result[3];
+    display_transform(expected);
+    EXPECT_TRUE(BLI_color_lut3d_apply_v3(lut, rgb, result));
+    for (int c = 0; c < 3; c++) {
+      /* Relative for bright values, which are clipped by the display anyway. */
+      max_error = max_ff(max_error, fabsf(result[c] - expected[c]) / max_ff(1.0f, expected[c]));
+    }
+  }
+
+  EXPECT_LT(max_error, 0.5f / 255.0f);
+
+  BLI_color_lut3d_free(lut);
+}
+
+TEST(math_color_lut, FloatDomain)
+{
+  ColorLUT3D *lut = BLI_color_lut3d_new(float_lut_size, true);
+  bake(lut, display_transform);
+
+  const float inside[3] = {0.0f, 1.0f, lut->domain_max};
+  float result[3] = {-1.0f, -1.0f, -1.0f};
+  EXPECT_TRUE(BLI_color_lut3d_apply_v3(lut, inside, result));
+  EXPECT_NEAR(result[0], 0.0f, 1e-6f);
+
+  const float outside[][3] = {
+      {-0.001f, 0.5f, 0.5f},
+      {0.5f, lut->domain_max * 1.001f, 0.5f},
+      {0.5f, 0.5f, NAN},
+      {0.5f, 0.5f, INFINITY},
+  };
+  for (const float *rgb : outside) {
+    float untouched[3] = {-1.0f, -1.0f, -1.0f};
+    EXPECT_FALSE(BLI_color_lut3d_apply_v3(lut, rgb, untouched));
+    EXPECT_EQ(untouched[0], -1.0f);
+  }
+
+  BLI_color_lut3d_free(lut);
+}
+
+}  // namespace blender::tests
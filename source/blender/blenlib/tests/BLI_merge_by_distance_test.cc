@@ -0,0 +1,277 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_disjoint_set.hh"
+#include "BLI_float3.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_merge_by_distance.h"
+#include "BLI_rand.h"
+
+namespace blender::tests {
+
+/* Snap coordinates to a coarse grid so there are plenty of points within merge distance. */
+static Array<float3> random_points(const int points_len, const int round, const uint seed)
+{
+  Array<float3> points(points_len);
+  RNG *rng = BLI_rng_new(seed);
+  for (float3 &co : points) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float f = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+      co[axis] = (float)((int)(f * round)) / (float)round;
+    }
+  }
+  BLI_rng_free(rng);
+  return points;
+}
+
+TEST(merge_by_distance, Empty)
+{
+  int dest_map[1] = {0};
+  EXPECT_EQ(BLI_merge_by_distance_clusters(nullptr, 0, nullptr, 0.1f, 0, dest_map), 0);
+  EXPECT_EQ(BLI_merge_by_distance_duplicates(nullptr, 0, 0.1f, dest_map), 0);
+}
+
+TEST(merge_by_distance, ClustersChain)
+{
+  /* Points closer than the distance only to their direct neighbors still form one cluster. */
+  const float co[5][3] = {{0.0f, 0, 0}, {0.8f, 0, 0}, {1.6f, 0, 0}, {5.0f, 0, 0}, {5.5f, 0, 0}};
+  int dest_map[5];
+  EXPECT_EQ(BLI_merge_by_distance_clusters(co, 5, nullptr, 1.0f, 0, dest_map), 3);
+  EXPECT_EQ(dest_map[0], 0);
+  EXPECT_EQ(dest_map[1], 0);
+  EXPECT_EQ(dest_map[2], 0);
+  EXPECT_EQ(dest_map[3], 3);
+  EXPECT_EQ(dest_map[4], 3);
+}
+
+TEST(merge_by_distance, ClustersMask)
+{
+  const float co[3][3] = {{0.0f, 0, 0}, {0.0f, 0, 0}, {0.0f, 0, 0}};
+  BLI_bitmap *mask = BLI_BITMAP_NEW(3, __func__);
+  BLI_BITMAP_ENABLE(mask, 1);
+  BLI_BITMAP_ENABLE(mask, 2);
+  int dest_map[3];
+  EXPECT_EQ(BLI_merge_by_distance_clusters(co, 3, mask, 0.0f, 0, dest_map), 1);
+  EXPECT_EQ(dest_map[0], -1);
+  EXPECT_EQ(dest_map[1], 1);
+  EXPECT_EQ(dest_map[2], 1);
+  MEM_freeN(mask);
+}
+
+TEST(merge_by_distance, ClustersMatchBruteForce)
+{
+  const int points_len = 2000;
+  const float dist = 0.06f;
+  Array<float3> points = random_points(points_len, 40, 1);
+  const float(*co)[3] = (const float(*)[3])points.data();
+
+  DisjointSet disjoint_set(points_len);
+  Array<bool> linked(points_len, false);
+  for (int i = 0; i < points_len; i++) {
+    for (int j = i + 1; j < points_len; j++) {
+      if (len_squared_v3v3(co[i], co[j]) <= dist * dist) {
+        disjoint_set.join(i, j);
+        linked[i] = linked[j] = true;
+      }
+    }
+  }
+
+  Array<int> dest_map(points_len);
+  const int merged_len = BLI_merge_by_distance_clusters(
+      co, points_len, nullptr, dist, 0, dest_map.data());
+
+  int merged_len_expect = 0;
+  for (int i = 0; i < points_len; i++) {
+    if (!linked[i]) {
+      EXPECT_EQ(dest_map[i], -1);
+      continue;
+    }
+    /* The target is the lowest index of the cluster. */
+    ASSERT_NE(dest_map[i], -1);
+    EXPECT_LE(dest_map[i], i);
+    EXPECT_TRUE(disjoint_set.in_same_set(i, dest_map[i]));
+    EXPECT_EQ(dest_map[dest_map[i]], dest_map[i]);
+    if (dest_map[i] != i) {
+      merged_len_expect++;
+    }
+    else {
+      for (int j = 0; j < i; j++) {
+        EXPECT_FALSE(disjoint_set.in_same_set(i, j));
+      }
+    }
+  }
+  EXPECT_EQ(merged_len, merged_len_expect);
+  EXPECT_GT(merged_len, 0);
+}
+
+TEST(merge_by_distance, ClustersLimitedMatchBruteForce)
+{
+  const int points_len = 1000;
+  const float dist = 0.08f;
+  const int max_interactions = 2;
+  Array<float3> points = random_points(points_len, 20, 3);
+  const float(*co)[3] = (const float(*)[3])points.data();
+
+  /* Every point is linked to its lowest neighbors of higher index. */
+  DisjointSet disjoint_set(points_len);
+  Array<bool> linked(points_len, false);
+  for (int i = 0; i < points_len; i++) {
+    int interactions = 0;
+    for (int j = i + 1; j < points_len && interactions < max_interactions; j++) {
+      if (len_squared_v3v3(co[i], co[j]) <= dist * dist) {
+        disjoint_set.join(i, j);
+        linked[i] = linked[j] = true;
+        interactions++;
+      }
+    }
+  }
+
+  Array<int> dest_map(points_len);
+  BLI_merge_by_distance_clusters(co, points_len, nullptr, dist, max_interactions, dest_map.data());
+
+  for (int i = 0; i < points_len; i++) {
+    if (!linked[i]) {
+      EXPECT_EQ(dest_map[i], -1);
+      continue;
+    }
+    ASSERT_NE(dest_map[i], -1);
+    EXPECT_TRUE(disjoint_set.in_same_set(i, dest_map[i]));
+    for (int j = 0; j < dest_map[i]; j++) {
+      EXPECT_FALSE(disjoint_set.in_same_set(i, j));
+    }
+  }
+}
+
+TEST(merge_by_distance, ClustersCoincident)
+{
+  /* Used to store every pair of neighbors, this many points at one location overflowed. */
+  const int points_len = 100000;
+  Array<float3> points(points_len, float3(1.0f, 2.0f, 3.0f));
+  points[points_len - 1] = float3(2.0f, 2.0f, 3.0f);
+  const float(*co)[3] = (const float(*)[3])points.data();
+
+  Array<int> dest_map(points_len);
+  EXPECT_EQ(BLI_merge_by_distance_clusters(co, points_len, nullptr, 0.1f, 0, dest_map.data()),
+            points_len - 2);
+  EXPECT_EQ(dest_map[0], 0);
+  EXPECT_EQ(dest_map[points_len / 2], 0);
+  EXPECT_EQ(dest_map[points_len - 1], -1);
+
+  EXPECT_EQ(BLI_merge_by_distance_clusters(co, points_len, nullptr, 0.1f, 1, dest_map.data()),
+            points_len - 2);
+  EXPECT_EQ(dest_map[points_len - 2], 0);
+
+  Array<int> duplicates(points_len, -1);
+  EXPECT_EQ(BLI_merge_by_distance_duplicates(co, points_len, 0.1f, duplicates.data()),
+            points_len - 2);
+  EXPECT_EQ(duplicates[0], 0);
+  EXPECT_EQ(duplicates[points_len - 2], 0);
+  EXPECT_EQ(duplicates[points_len - 1], -1);
+}
+
+TEST(merge_by_distance, DuplicatesMatchKDTree)
+{
+  const int points_len = 2000;
+  const float dist = 0.06f;
+  Array<float3> points = random_points(points_len, 40, 2);
+  const float(*co)[3] = (const float(*)[3])points.data();
+
+  Array<int> duplicates_expect(points_len, -1);
+  Array<int> duplicates(points_len, -1);
+  /* Points keeping their own index must never be merged. */
+  duplicates_expect[7] = duplicates[7] = 7;
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+  for (int i = 0; i < points_len; i++) {
+    BLI_kdtree_3d_insert(tree, i, co[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  const int found_expect = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, dist, true, duplicates_expect.data());
+  BLI_kdtree_3d_free(tree);
+
+  const int found = BLI_merge_by_distance_duplicates(co, points_len, dist, duplicates.data());
+
+  EXPECT_EQ(found, found_expect);
+  for (int i = 0; i < points_len; i++) {
+    EXPECT_EQ(duplicates[i], duplicates_expect[i]);
+  }
+}
+
+/* Remove doubles used to visit points in the order of the balanced KD-tree, which decided the
+ * vertex kept from every group. For groups further apart than the distance the groups are the
+ * same, but now the lowest index is kept. */
+TEST(merge_by_distance, DuplicatesMatchKDTreeGroups)
+{
+  const int groups_len = 500;
+  const int group_size = 4;
+  const int points_len = groups_len * group_size;
+  const float dist = 0.01f;
+  Array<float3> centers = random_points(groups_len, 1000000, 4);
+  Array<float3> points(points_len);
+  RNG *rng = BLI_rng_new(5);
+  for (int i = 0; i < points_len; i++) {
+    /* Shuffle group members, so the order of the KD-tree differs from the index order. */
+    points[i] = centers[BLI_rng_get_int(rng) % groups_len];
+  }
+  BLI_rng_free(rng);
+  const float(*co)[3] = (const float(*)[3])points.data();
+
+  Array<int> duplicates_prev(points_len, -1);
+  KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+  for (int i = 0; i < points_len; i++) {
+    BLI_kdtree_3d_insert(tree, i, co[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  const int found_prev = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, dist, false, duplicates_prev.data());
+  BLI_kdtree_3d_free(tree);
+
+  Array<int> duplicates(points_len, -1);
+  const int found = BLI_merge_by_distance_duplicates(co, points_len, dist, duplicates.data());
+
+  EXPECT_EQ(found, found_prev);
+  for (int i = 0; i < points_len; i++) {
+    EXPECT_EQ(duplicates[i] == -1, duplicates_prev[i] == -1);
+    if (duplicates[i] == -1) {
+      continue;
+    }
+    EXPECT_TRUE(equals_v3v3(co[duplicates[i]], co[duplicates_prev[i]]));
+    for (int j = 0; j < duplicates[i]; j++) {
+      EXPECT_FALSE(equals_v3v3(co[i], co[j]));
+    }
+  }
+}
+
+/* Chained points are grouped around the lowest index visited first, while the KD-tree order
+ * used before merged the point at 0.9 into the one at 0.0 and left the point at 1.8 alone. */
+TEST(merge_by_distance, DuplicatesChain)
+{
+  const float co[3][3] = {{0.9f, 0, 0}, {0.0f, 0, 0}, {1.8f, 0, 0}};
+
+  int duplicates[3] = {-1, -1, -1};
+  EXPECT_EQ(BLI_merge_by_distance_duplicates(co, 3, 1.0f, duplicates), 2);
+  EXPECT_EQ(duplicates[0], 0);
+  EXPECT_EQ(duplicates[1], 0);
+  EXPECT_EQ(duplicates[2], 0);
+
+  /* Same as the KD-tree when it visits points in index order. */
+  int duplicates_expect[3] = {-1, -1, -1};
+  KDTree_3d *tree = BLI_kdtree_3d_new(3);
+  for (int i = 0; i < 3; i++) {
+    BLI_kdtree_3d_insert(tree, i, co[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  EXPECT_EQ(BLI_kdtree_3d_calc_duplicates_fast(tree, 1.0f, true, duplicates_expect), 2);
+  BLI_kdtree_3d_free(tree);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(duplicates[i], duplicates_expect[i]);
+  }
+}
+
+}  // namespace blender::tests
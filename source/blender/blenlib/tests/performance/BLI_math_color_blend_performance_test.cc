@@ -0,0 +1,158 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_math_color_blend.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+/* A full HD frame, blended a few times per kernel. */
+#define BLEND_TEST_WIDTH 1920
+#define BLEND_TEST_HEIGHT 1080
+#define BLEND_TEST_ITERATIONS 20
+
+typedef void (*BlendSpanByte)(unsigned char *dst,
+                              const unsigned char *src1,
+                              const unsigned char *src2,
+                              float fac,
+                              int pixels_num);
+typedef void (*BlendSpanFloat)(
+    float *dst, const float *src1, const float *src2, float fac, int pixels_num);
+typedef void (*BlendPixelFloat)(float dst[4], const float src1[4], const float src2[4]);
+
+static void blend_test_print(const char *name, const double time)
+{
+  const double megapixels = (double)BLEND_TEST_WIDTH * BLEND_TEST_HEIGHT * BLEND_TEST_ITERATIONS /
+                            1e6;
+  printf("\t%s: %.1f MP/s\n", name, megapixels / time);
+}
+
+static void blend_test_byte(const char *name, BlendSpanByte blend_fn, const float fac)
+{
+  const int pixels_num = BLEND_TEST_WIDTH * BLEND_TEST_HEIGHT;
+  unsigned char *src1 = (unsigned char *)MEM_mallocN(sizeof(char[4]) * pixels_num, __func__);
+  unsigned char *src2 = (unsigned char *)MEM_mallocN(sizeof(char[4]) * pixels_num, __func__);
+  unsigned char *dst = (unsigned char *)MEM_mallocN(sizeof(char[4]) * pixels_num, __func__);
+  RNG *rng = BLI_rng_new(0);
+  BLI_rng_get_char_n(rng, (char *)src1, sizeof(char[4]) * pixels_num);
+  BLI_rng_get_char_n(rng, (char *)src2, sizeof(char[4]) * pixels_num);
+  BLI_rng_free(rng);
+
+  const double time_start = PIL_check_seconds_timer();
+  for (int iter = 0; iter < BLEND_TEST_ITERATIONS; iter++) {
+    for (int y = 0; y < BLEND_TEST_HEIGHT; y++) {
+      const size_t offset = (size_t)y * BLEND_TEST_WIDTH * 4;
+      blend_fn(dst + offset, src1 + offset, src2 + offset, fac, BLEND_TEST_WIDTH);
+    }
+  }
+  blend_test_print(name, PIL_check_seconds_timer() - time_start);
+
+  MEM_freeN(src1);
+  MEM_freeN(src2);
+  MEM_freeN(dst);
+}
+
+static float *blend_test_pixels_float(RNG *rng, const int pixels_num)
+{
+  float *pixels = (float *)MEM_mallocN(sizeof(float[4]) * pixels_num, __func__);
+  for (int i = 0; i < pixels_num; i++) {
+    /* Premultiplied colors. */
+    pixels[i * 4 + 3] = BLI_rng_get_float(rng);
+    for (int c = 0; c < 3; c++) {
+      pixels[i * 4 + c] = BLI_rng_get_float(rng) * pixels[i * 4 + 3];
+    }
+  }
+  return pixels;
+}
+
+/**
+ * Time \a blend_fn and, when given, the per pixel function \a pixel_fn it replaces, applied the
+ * way the sequencer did before (scaling the alpha of the first input for each pixel).
+ */
+static void blend_test_float(const char *name,
+                             BlendSpanFloat blend_fn,
+                             BlendPixelFloat pixel_fn,
+                             const float fac)
+{
+  const int pixels_num = BLEND_TEST_WIDTH * BLEND_TEST_HEIGHT;
+  RNG *rng = BLI_rng_new(0);
+  float *src1 = blend_test_pixels_float(rng, pixels_num);
+  float *src2 = blend_test_pixels_float(rng, pixels_num);
+  float *dst = (float *)MEM_mallocN(sizeof(float[4]) * pixels_num, __func__);
+  BLI_rng_free(rng);
+
+  double time_start = PIL_check_seconds_timer();
+  for (int iter = 0; iter < BLEND_TEST_ITERATIONS; iter++) {
+    for (int y = 0; y < BLEND_TEST_HEIGHT; y++) {
+      const size_t offset = (size_t)y * BLEND_TEST_WIDTH * 4;
+      blend_fn(dst + offset, src1 + offset, src2 + offset, fac, BLEND_TEST_WIDTH);
+    }
+  }
+  blend_test_print(name, PIL_check_seconds_timer() - time_start);
+
+  if (pixel_fn) {
+    time_start = PIL_check_seconds_timer();
+    for (int iter = 0; iter < BLEND_TEST_ITERATIONS; iter++) {
+      for (int i = 0; i < pixels_num; i++) {
+        float *rt1 = &src1[i * 4];
+        const float alpha = rt1[3];
+        rt1[3] = alpha * fac;
+        pixel_fn(&dst[i * 4], rt1, &src2[i * 4]);
+        rt1[3] = alpha;
+        dst[i * 4 + 3] = alpha;
+      }
+    }
+    blend_test_print("\tper pixel", PIL_check_seconds_timer() - time_start);
+  }
+
+  MEM_freeN(src1);
+  MEM_freeN(src2);
+  MEM_freeN(dst);
+}
+
+static void blend_test_cross_byte(unsigned char *dst,
+                                  const unsigned char *src1,
+                                  const unsigned char *src2,
+                                  float fac,
+                                  int pixels_num)
+{
+  blend_color_cross_byte_n(dst, src1, src2, (int)(256.0f * fac), pixels_num);
+}
+
+TEST(math_color_blend, TransitionsByte)
+{
+  printf("\n========== STARTING %s ==========\n", "Byte transitions");
+  blend_test_byte("Cross", blend_test_cross_byte, 0.5f);
+  blend_test_byte("Alpha over", blend_color_alphaover_byte_n, 0.5f);
+  blend_test_byte("Alpha under", blend_color_alphaunder_byte_n, 0.5f);
+  printf("========== ENDED %s ==========\n\n", "Byte transitions");
+}
+
+TEST(math_color_blend, TransitionsFloat)
+{
+  printf("\n========== STARTING %s ==========\n", "Float transitions");
+  blend_test_float("Cross", blend_color_cross_float_n, NULL, 0.5f);
+  blend_test_float("Alpha over", blend_color_alphaover_float_n, NULL, 0.5f);
+  blend_test_float("Alpha under", blend_color_alphaunder_float_n, NULL, 0.5f);
+  printf("========== ENDED %s ==========\n\n", "Float transitions");
+}
+
+TEST(math_color_blend, BlendModesFloat)
+{
+  printf("\n========== STARTING %s ==========\n", "Float blend modes");
+  blend_test_float("Add", blend_color_add_float_n, blend_color_add_float, 0.5f);
+  blend_test_float("Subtract", blend_color_sub_float_n, blend_color_sub_float, 0.5f);
+  blend_test_float("Multiply", blend_color_mul_float_n, blend_color_mul_float, 0.5f);
+  blend_test_float("Lighten", blend_color_lighten_float_n, blend_color_lighten_float, 0.5f);
+  blend_test_float("Darken", blend_color_darken_float_n, blend_color_darken_float, 0.5f);
+  blend_test_float("Screen", blend_color_screen_float_n, blend_color_screen_float, 0.5f);
+  blend_test_float(
+      "Difference", blend_color_difference_float_n, blend_color_difference_float, 0.5f);
+  blend_test_float("Exclusion", blend_color_exclusion_float_n, blend_color_exclusion_float, 0.5f);
+  printf("========== ENDED %s ==========\n\n", "Float blend modes");
+}
@@ -0,0 +1,155 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_math_color_lut.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+/* A full HD frame, transformed a few times. */
+#define LUT_TEST_WIDTH 1920
+#define LUT_TEST_HEIGHT 1080
+#define LUT_TEST_ITERATIONS 10
+
+/* Sizes used for the display transform of byte and float buffers. */
+#define LUT_TEST_BYTE_SIZE 52
+#define LUT_TEST_FLOAT_SIZE 65
+
+static void lut_test_print(const char *name, const double time)
+{
+  const double megapixels = (double)LUT_TEST_WIDTH * LUT_TEST_HEIGHT * LUT_TEST_ITERATIONS / 1e6;
+  printf("\t%s: %.1f MP/s\n", name, megapixels / time);
+}
+
+/* Display transform of the fallback color management configuration, with an exposure. Real
+ * OpenColorIO view transforms are more expensive. */
+static void lut_test_transform(float rgb[3])
+{
+  for (int c = 0; c < 3; c++) {
+    rgb[c] = linearrgb_to_srgb(rgb[c] * 2.0f);
+  }
+}
+
+static ColorLUT3D *lut_test_bake(const int size, const bool use_log_shaper)
+{
+  const double time_start = PIL_check_seconds_timer();
+  ColorLUT3D *lut = BLI_color_lut3d_new(size, use_log_shaper);
+  for (int i = 0; i < size * size * size; i++) {
+    lut_test_transform(lut->table[i]);
+  }
+  printf("\tbake %d^3 nodes: %.2f ms\n", size, (PIL_check_seconds_timer() - time_start) * 1e3);
+  return lut;
+}
+
+/* Random colors are the worst case for the LUT, every pixel reads nodes from another part of
+ * the table. Images usually change smoothly, which the gradient is closer to. */
+static float lut_test_value(RNG *rng, const bool use_random, const int x, const int y, const int c)
+{
+  if (use_random) {
+    return BLI_rng_get_float(rng);
+  }
+  const float gradient[3] = {(float)x / LUT_TEST_WIDTH, (float)y / LUT_TEST_HEIGHT, 0.5f};
+  return clamp_f(gradient[c] + (BLI_rng_get_float(rng) - 0.5f) * 0.02f, 0.0f, 1.0f);
+}
+
+static void lut_test_float(const char *name, const bool use_random)
+{
+  const int pixels_num = LUT_TEST_WIDTH * LUT_TEST_HEIGHT;
+  float(*src)[3] = (float(*)[3])MEM_malloc_arrayN(pixels_num, sizeof(*src), __func__);
+  float(*dst)[3] = (float(*)[3])MEM_malloc_arrayN(pixels_num, sizeof(*dst), __func__);
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < pixels_num; i++) {
+    for (int c = 0; c < 3; c++) {
+      /* Scene linear values from 8 stops below to 4 stops above 1. */
+      const float value = lut_test_value(
+          rng, use_random, i % LUT_TEST_WIDTH, i / LUT_TEST_WIDTH, c);
+      src[i][c] = exp2f(-8.0f + value * 12.0f);
+    }
+  }
+  BLI_rng_free(rng);
+
+  printf("%s\n", name);
+
+  double time_start = PIL_check_seconds_timer();
+  for (int iter = 0; iter < LUT_TEST_ITERATIONS; iter++) {
+    for (int i = 0; i < pixels_num; i++) {
+      copy_v3_v3(dst[i], src[i]);
+      lut_test_transform(dst[i]);
+    }
+  }
+  lut_test_print("exact", PIL_check_seconds_timer() - time_start);
+
+  ColorLUT3D *lut = lut_test_bake(LUT_TEST_FLOAT_SIZE, true);
+  time_start = PIL_check_seconds_timer();
+  for (int iter = 0; iter < LUT_TEST_ITERATIONS; iter++) {
+    for (int i = 0; i < pixels_num; i++) {
+      BLI_color_lut3d_apply_v3(lut, src[i], dst[i]);
+    }
+  }
+  lut_test_print("LUT", PIL_check_seconds_timer() - time_start);
+  BLI_color_lut3d_free(lut);
+
+  MEM_freeN(src);
+  MEM_freeN(dst);
+}
+
+static void lut_test_byte(const char *name, const bool use_random)
+{
+  const int pixels_num = LUT_TEST_WIDTH * LUT_TEST_HEIGHT;
+  unsigned char(*src)[4] = (unsigned char(*)[4])MEM_malloc_arrayN(
+      pixels_num, sizeof(*src), __func__);
+  float(*dst)[3] = (float(*)[3])MEM_malloc_arrayN(pixels_num, sizeof(*dst), __func__);
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < pixels_num; i++) {
+    for (int c = 0; c < 4; c++) {
+      const float value = lut_test_value(
+          rng, use_random, i % LUT_TEST_WIDTH, i / LUT_TEST_WIDTH, min_ii(c, 2));
+      src[i][c] = unit_float_to_uchar_clamp(value);
+    }
+  }
+  BLI_rng_free(rng);
+
+  printf("%s\n", name);
+
+  /* The exact path converts bytes to scene linear before the display transform. */
+  double time_start = PIL_check_seconds_timer();
+  for (int iter = 0; iter < LUT_TEST_ITERATIONS; iter++) {
+    for (int i = 0; i < pixels_num; i++) {
+      for (int c = 0; c < 3; c++) {
+        dst[i][c] = srgb_to_linearrgb((float)src[i][c] * (1.0f / 255.0f));
+      }
+      lut_test_transform(dst[i]);
+    }
+  }
+  lut_test_print("exact", PIL_check_seconds_timer() - time_start);
+
+  ColorLUT3D *lut = lut_test_bake(LUT_TEST_BYTE_SIZE, false);
+  time_start = PIL_check_seconds_timer();
+  for (int iter = 0; iter < LUT_TEST_ITERATIONS; iter++) {
+    for (int i = 0; i < pixels_num; i++) {
+      BLI_color_lut3d_apply_uchar3(lut, src[i], dst[i]);
+    }
+  }
+  lut_test_print("LUT", PIL_check_seconds_timer() - time_start);
+  BLI_color_lut3d_free(lut);
+
+  MEM_freeN(src);
+  MEM_freeN(dst);
+}
+
+TEST(math_color_lut, FloatDisplayTransform)
+{
+  lut_test_float("gradient", false);
+  lut_test_float("random", true);
+}
+
+TEST(math_color_lut, ByteDisplayTransform)
+{
+  lut_test_byte("gradient", false);
+  lut_test_byte("random", true);
+}
@@ -0,0 +1,92 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_merge_by_distance.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+/* Roughly one point in ten has a double within merge distance. */
+static float (*merge_test_points_create(const int points_len))[3]
+{
+  float(*co)[3] = (float(*)[3])MEM_malloc_arrayN(points_len, sizeof(*co), __func__);
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < points_len; i++) {
+    if (i > 0 && BLI_rng_get_float(rng) < 0.1f) {
+      const int other = BLI_rng_get_int(rng) % i;
+      for (int axis = 0; axis < 3; axis++) {
+        co[i][axis] = co[other][axis] + (BLI_rng_get_float(rng) - 0.5f) * 1e-4f;
+      }
+    }
+    else {
+      BLI_rng_get_float_unit_v3(rng, co[i]);
+      mul_v3_fl(co[i], BLI_rng_get_float(rng) * 100.0f);
+    }
+  }
+  BLI_rng_free(rng);
+  return co;
+}
+
+static void merge_by_distance_test(const char *id, const int points_len)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+  BLI_threadapi_init();
+
+  const float dist = 1e-3f;
+  float(*co)[3] = merge_test_points_create(points_len);
+  int *duplicates = (int *)MEM_malloc_arrayN(points_len, sizeof(int), __func__);
+
+  {
+    copy_vn_i(duplicates, points_len, -1);
+    const double init_time = PIL_check_seconds_timer();
+    KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+    for (int i = 0; i < points_len; i++) {
+      BLI_kdtree_3d_insert(tree, i, co[i]);
+    }
+    BLI_kdtree_3d_balance(tree);
+    const int found = BLI_kdtree_3d_calc_duplicates_fast(tree, dist, true, duplicates);
+    BLI_kdtree_3d_free(tree);
+    printf("\tKD-tree duplicates: %d found in %fs\n", found, PIL_check_seconds_timer() - init_time);
+  }
+
+  {
+    copy_vn_i(duplicates, points_len, -1);
+    const double init_time = PIL_check_seconds_timer();
+    const int found = BLI_merge_by_distance_duplicates(co, points_len, dist, duplicates);
+    printf("\tGrid duplicates: %d found in %fs\n", found, PIL_check_seconds_timer() - init_time);
+  }
+
+  {
+    const double init_time = PIL_check_seconds_timer();
+    const int merged = BLI_merge_by_distance_clusters(co, points_len, NULL, dist, 0, duplicates);
+    printf("\tGrid clusters: %d merged in %fs\n", merged, PIL_check_seconds_timer() - init_time);
+  }
+
+  MEM_freeN(duplicates);
+  MEM_freeN(co);
+
+  BLI_threadapi_exit();
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(merge_by_distance, Points100k)
+{
+  merge_by_distance_test("Merge by distance - 100000 points", 100000);
+}
+
+TEST(merge_by_distance, Points1M)
+{
+  merge_by_distance_test("Merge by distance - 1000000 points", 1000000);
+}
+
+TEST(merge_by_distance, Points10M)
+{
+  merge_by_distance_test("Merge by distance - 10000000 points", 10000000);
+}
@@ -3586,6 +3586,8 @@ static void lib_link_image(BlendLibReader *UNUSED(reader), Image *ima)
 
 static void direct_link_image(BlendDataReader *reader, Image *ima)
 {
+  ima->content_version = 0;
+
   BLO_read_list(reader, &ima->tiles);
 
   BLO_read_list(reader, &(ima->renderslots));
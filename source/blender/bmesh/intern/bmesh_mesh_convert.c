@@ -81,6 +81,7 @@
 #include "BLI_alloca.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -992,6 +993,123 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   BKE_mesh_runtime_clear_geometry(me);
 }
 
+typedef struct BMToMeEvalData {
+  BMesh *bm;
+  Mesh *me;
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  /** Original index layers to fill in, NULL when the BMesh already has them. */
+  int *vert_origindex;
+  int *edge_origindex;
+  int *poly_origindex;
+} BMToMeEvalData;
+
+static void bm_to_me_for_eval_vert_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeEvalData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMVert *eve = bm->vtable[i];
+  MVert *mv = &me->mvert[i];
+
+  copy_v3_v3(mv->co, eve->co);
+
+  BM_elem_index_set(eve, i); /* set_inline */
+
+  normal_float_to_short_v3(mv->no, eve->no);
+
+  mv->flag = BM_vert_flag_to_mflag(eve);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eve, data->cd_vert_bweight_offset);
+  }
+
+  if (data->vert_origindex) {
+    data->vert_origindex[i] = i;
+  }
+
+  CustomData_from_bmesh_block(&bm->vdata, &me->vdata, eve->head.data, i);
+}
+
+static void bm_to_me_for_eval_edge_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeEvalData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMEdge *eed = bm->etable[i];
+  MEdge *med = &me->medge[i];
+
+  BM_elem_index_set(eed, i); /* set_inline */
+
+  med->v1 = BM_elem_index_get(eed->v1);
+  med->v2 = BM_elem_index_get(eed->v2);
+
+  med->flag = BM_edge_flag_to_mflag(eed);
+
+  /* Handle this differently to editmode switching,
+   * only enable draw for single user edges rather then calculating angle. */
+  if ((med->flag & ME_EDGEDRAW) == 0) {
+    if (eed->l && eed->l == eed->l->radial_next) {
+      med->flag |= ME_EDGEDRAW;
+    }
+  }
+
+  if (data->cd_edge_crease_offset != -1) {
+    med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, data->cd_edge_crease_offset);
+  }
+  if (data->cd_edge_bweight_offset != -1) {
+    med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, data->cd_edge_bweight_offset);
+  }
+
+  CustomData_from_bmesh_block(&bm->edata, &me->edata, eed->head.data, i);
+  if (data->edge_origindex) {
+    data->edge_origindex[i] = i;
+  }
+}
+
+/* Expects #MPoly.loopstart and #MPoly.totloop to be set already. */
+static void bm_to_me_for_eval_face_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeEvalData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMFace *efa = bm->ftable[i];
+  MPoly *mp = &me->mpoly[i];
+  BMLoop *l_iter, *l_first;
+
+  BM_elem_index_set(efa, i); /* set_inline */
+
+  mp->flag = BM_face_flag_to_mflag(efa);
+  mp->mat_nr = efa->mat_nr;
+
+  int j = mp->loopstart;
+  MLoop *mloop = &me->mloop[j];
+  l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
+  do {
+    mloop->v = BM_elem_index_get(l_iter->v);
+    mloop->e = BM_elem_index_get(l_iter->e);
+    CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+
+    BM_elem_index_set(l_iter, j); /* set_inline */
+
+    j++;
+    mloop++;
+  } while ((l_iter = l_iter->next) != l_first);
+
+  CustomData_from_bmesh_block(&bm->pdata, &me->pdata, efa->head.data, i);
+
+  if (data->poly_origindex) {
+    data->poly_origindex[i] = i;
+  }
+}
+
 /**
  * A version of #BM_mesh_bm_to_me intended for getting the mesh
  * to pass to the modifier stack for evaluation,
@@ -1008,6 +1126,8 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
  * - Uses #CD_MASK_DERIVEDMESH instead of #CD_MASK_MESH.
  *
  * \note Was `cddm_from_bmesh_ex` in 2.7x, removed `MFace` support.
+ * \note The element tables are built when needed, a BMesh converted from multiple threads
+ * at once must have them built beforehand.
  */
 void BM_mesh_bm_to_me_for_eval(BMesh *bm, Mesh *me, const CustomData_MeshMasks *cd_mask_extra)
 {
@@ -1044,117 +1164,88 @@ void BM_mesh_bm_to_me_for_eval(BMesh *bm, Mesh *me, const CustomData_MeshMasks *
 
   BKE_mesh_update_customdata_pointers(me, false);
 
-  BMIter iter;
-  BMVert *eve;
-  BMEdge *eed;
-  BMFace *efa;
-  MVert *mvert = me->mvert;
-  MEdge *medge = me->medge;
-  MLoop *mloop = me->mloop;
-  MPoly *mpoly = me->mpoly;
-  int *index, add_orig;
-  unsigned int i, j;
-
-  const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-  const int cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-  const int cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE);
-
   me->runtime.deformed_only = true;
 
-  /* Don't add origindex layer if one already exists. */
-  add_orig = !CustomData_has_layer(&bm->pdata, CD_ORIGINDEX);
-
-  index = CustomData_get_layer(&me->vdata, CD_ORIGINDEX);
-
-  BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
-    MVert *mv = &mvert[i];
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
-    copy_v3_v3(mv->co, eve->co);
+  BMToMeEvalData data = {
+      .bm = bm,
+      .me = me,
+      .cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT),
+      .cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT),
+      .cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE),
+  };
 
-    BM_elem_index_set(eve, i); /* set_inline */
-
-    normal_float_to_short_v3(mv->no, eve->no);
-
-    mv->flag = BM_vert_flag_to_mflag(eve);
-
-    if (cd_vert_bweight_offset != -1) {
-      mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eve, cd_vert_bweight_offset);
-    }
-
-    if (add_orig) {
-      *index++ = i;
-    }
-
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, eve->head.data, i);
+  /* Don't add origindex layer if one already exists. */
+  if (!CustomData_has_layer(&bm->pdata, CD_ORIGINDEX)) {
+    data.vert_origindex = CustomData_get_layer(&me->vdata, CD_ORIGINDEX);
+    data.edge_origindex = CustomData_get_layer(&me->edata, CD_ORIGINDEX);
+    data.poly_origindex = CustomData_get_layer(&me->pdata, CD_ORIGINDEX);
   }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  index = CustomData_get_layer(&me->edata, CD_ORIGINDEX);
-  BM_ITER_MESH_INDEX (eed, &iter, bm, BM_EDGES_OF_MESH, i) {
-    MEdge *med = &medge[i];
-
-    BM_elem_index_set(eed, i); /* set_inline */
 
-    med->v1 = BM_elem_index_get(eed->v1);
-    med->v2 = BM_elem_index_get(eed->v2);
-
-    med->flag = BM_edge_flag_to_mflag(eed);
+  /* Loops are written per face, so the offsets of each face into the loop array
+   * have to be known up front. */
+  MPoly *mpoly = me->mpoly;
+  int loopstart = 0;
+  for (int i = 0; i < bm->totface; i++) {
+    mpoly[i].loopstart = loopstart;
+    mpoly[i].totloop = bm->ftable[i]->len;
+    loopstart += bm->ftable[i]->len;
+  }
+  BLI_assert(loopstart == bm->totloop);
 
-    /* Handle this differently to editmode switching,
-     * only enable draw for single user edges rather then calculating angle. */
-    if ((med->flag & ME_EDGEDRAW) == 0) {
-      if (eed->l && eed->l == eed->l->radial_next) {
-        med->flag |= ME_EDGEDRAW;
-      }
-    }
+  /* Edges read vertex indices and loops read edge indices, so the passes run one after the other,
+   * each one being threaded over its own elements. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
 
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, cd_edge_bweight_offset);
-    }
+  settings.use_threading = bm->totvert >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totvert, &data, bm_to_me_for_eval_vert_cb, &settings);
+  bm->elem_index_dirty &= ~BM_VERT;
 
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, eed->head.data, i);
-    if (add_orig) {
-      *index++ = i;
-    }
-  }
+  settings.use_threading = bm->totedge >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totedge, &data, bm_to_me_for_eval_edge_cb, &settings);
   bm->elem_index_dirty &= ~BM_EDGE;
 
-  index = CustomData_get_layer(&me->pdata, CD_ORIGINDEX);
-  j = 0;
-  BM_ITER_MESH_INDEX (efa, &iter, bm, BM_FACES_OF_MESH, i) {
-    BMLoop *l_iter;
-    BMLoop *l_first;
-    MPoly *mp = &mpoly[i];
-
-    BM_elem_index_set(efa, i); /* set_inline */
+  settings.use_threading = bm->totface >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totface, &data, bm_to_me_for_eval_face_cb, &settings);
+  bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP);
 
-    mp->totloop = efa->len;
-    mp->flag = BM_face_flag_to_mflag(efa);
-    mp->loopstart = j;
-    mp->mat_nr = efa->mat_nr;
+  me->cd_flag = BM_mesh_cd_flag_from_bmesh(bm);
+}
 
-    l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
-    do {
-      mloop->v = BM_elem_index_get(l_iter->v);
-      mloop->e = BM_elem_index_get(l_iter->e);
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+static void bm_to_me_for_eval_vert_coords_cb(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeEvalData *data = userdata;
+  BMVert *eve = data->bm->vtable[i];
+  MVert *mv = &data->me->mvert[i];
 
-      BM_elem_index_set(l_iter, j); /* set_inline */
+  copy_v3_v3(mv->co, eve->co);
+  normal_float_to_short_v3(mv->no, eve->no);
+}
 
-      j++;
-      mloop++;
-    } while ((l_iter = l_iter->next) != l_first);
+/**
+ * Refresh vertex locations and normals of a mesh previously created by
+ * #BM_mesh_bm_to_me_for_eval, for edits known not to change anything else
+ * (topology, flags or custom-data).
+ */
+void BM_mesh_bm_to_me_for_eval_vert_coords(BMesh *bm, Mesh *me)
+{
+  BLI_assert(me->totvert == bm->totvert);
 
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, efa->head.data, i);
+  BM_mesh_elem_table_ensure(bm, BM_VERT);
 
-    if (add_orig) {
-      *index++ = i;
-    }
-  }
-  bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP);
+  BMToMeEvalData data = {
+      .bm = bm,
+      .me = me,
+  };
 
-  me->cd_flag = BM_mesh_cd_flag_from_bmesh(bm);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = bm->totvert >= BM_OMP_LIMIT;
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, bm->totvert, &data, bm_to_me_for_eval_vert_coords_cb, &settings);
 }
@@ -70,3 +70,4 @@ void BM_mesh_bm_to_me_for_eval(BMesh *bm,
                                struct Mesh *me,
                                const struct CustomData_MeshMasks *cd_mask_extra)
     ATTR_NONNULL(1, 2);
+void BM_mesh_bm_to_me_for_eval_vert_coords(BMesh *bm, struct Mesh *me) ATTR_NONNULL();
@@ -219,8 +219,10 @@ extern "C" {
  *
  * </pre>
  *
- * \see ExecutionGroup.execute Execute a complete ExecutionGroup.
+ * \see ExecutionSystem.executeGroups Execute all output ExecutionGroups of a priority.
  * Halts until finished or breaked by user
+ * \see ExecutionGroup.scheduleChunks Schedules the chunks of an output ExecutionGroup,
+ * called every time a chunk has finished
  * \see ExecutionGroup.scheduleChunkWhenPossible Tries to schedule a single chunk,
  * checks if all input data is available. Can trigger dependent chunks to be calculated
  * \see ExecutionGroup.scheduleAreaWhenPossible
@@ -237,11 +239,15 @@ extern "C" {
  * \section workscheduler WorkScheduler
  * the WorkScheduler is implemented as a static class. the responsibility of the WorkScheduler
  * is to balance WorkPackages to the available and free devices.
- * the work-scheduler can work in 2 states.
+ * the work-scheduler can work in 3 states.
  * For witching these between the state you need to recompile blender
  *
+ * \subsection taskthread Task scheduler
+ * When building with TBB every WorkPackage is executed as a task in a BLI_task pool.
+ * Idle worker threads steal the tasks, and share them with the rest of blender.
+ *
  * \subsection multithread Multi threaded
- * Default the work-scheduler will place all work as WorkPackage in a queue.
+ * Without TBB the work-scheduler will place all work as WorkPackage in a queue.
  * For every CPUcore a working thread is created.
  * These working threads will ask the WorkScheduler if there is work
  * for a specific Device.
@@ -356,8 +362,11 @@ void COM_deinitialize(void);
 /**
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
+ *
+ * Results of complex operations are kept between executions, they need to be cleared when
+ * data read by the compositor changes outside of the node tree, e.g. new render results.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 #ifdef __cplusplus
 }
@@ -68,7 +68,6 @@ typedef enum CompositorPriority {
 // workscheduler threading models
 /**
  * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
- * This is the default option.
  */
 #define COM_TM_QUEUE 1
 
@@ -79,9 +78,21 @@ typedef enum CompositorPriority {
 #define COM_TM_NOTHREAD 0
 
 /**
- * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
+ * COM_TM_TASK is a multi-threaded model, which executes every chunk as a task in the BLI_task
+ * scheduler, sharing its worker threads with the rest of Blender.
+ * This is the default option when building with TBB.
  */
-#define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#define COM_TM_TASK 2
+
+/**
+ * COM_CURRENT_THREADING_MODEL can be one of the above.
+ * Without TBB the task scheduler runs tasks in the waiting thread, so COM_TM_QUEUE is used.
+ */
+#ifdef WITH_TBB
+#  define COM_CURRENT_THREADING_MODEL COM_TM_TASK
+#else
+#  define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#endif
 // chunk order
 /**
  * \brief The order of chunks to be scheduled
@@ -102,6 +113,12 @@ typedef enum OrderOfChunks {
 
 #define COM_RULE_OF_THIRDS_DIVIDER 100.0f
 
+/**
+ * \brief Maximum number of pixels read at once by #SocketReader.readRow.
+ * Rows of this length fit on the stack, so operations can read their inputs into local arrays.
+ */
+#define COM_ROW_LENGTH 64
+
 #define COM_NUM_CHANNELS_VALUE 1
 #define COM_NUM_CHANNELS_VECTOR 3
 #define COM_NUM_CHANNELS_COLOR 4
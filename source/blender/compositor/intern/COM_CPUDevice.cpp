@@ -18,6 +18,8 @@
 
 #include "COM_CPUDevice.h"
 
+#include "PIL_time.h"
+
 CPUDevice::CPUDevice(int thread_id) : Device(), m_thread_id(thread_id)
 {
 }
@@ -26,11 +28,12 @@ void CPUDevice::execute(WorkPackage *work)
 {
   const unsigned int chunkNumber = work->getChunkNumber();
   ExecutionGroup *executionGroup = work->getExecutionGroup();
+  const double startTime = PIL_check_seconds_timer();
   rcti rect;
 
   executionGroup->determineChunkRect(&rect, chunkNumber);
 
   executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
 
-  executionGroup->finalizeChunkExecution(chunkNumber, NULL);
+  executionGroup->finalizeChunkExecution(chunkNumber, NULL, PIL_check_seconds_timer() - startTime);
 }
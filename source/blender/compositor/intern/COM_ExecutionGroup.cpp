@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <math.h>
 #include <sstream>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "atomic_ops.h"
@@ -46,6 +47,9 @@ ExecutionGroup::ExecutionGroup()
   this->m_isOutput = false;
   this->m_complex = false;
   this->m_chunkExecutionStates = NULL;
+  this->m_chunkExecutionTimes = NULL;
+  this->m_chunkOrder = NULL;
+  this->m_chunkOrderStartIndex = 0;
   this->m_bTree = NULL;
   this->m_height = 0;
   this->m_width = 0;
@@ -113,6 +117,27 @@ bool ExecutionGroup::addOperation(NodeOperation *operation)
   return true;
 }
 
+void ExecutionGroup::setChunksExecuted()
+{
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+  }
+  this->m_chunksFinished = this->m_numberOfChunks;
+}
+
+bool ExecutionGroup::isChunksExecuted() const
+{
+  if (this->m_numberOfChunks == 0) {
+    return false;
+  }
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return false;
+    }
+  }
+  return true;
+}
+
 NodeOperation *ExecutionGroup::getOutputOperation() const
 {
   return this
@@ -124,16 +149,22 @@ void ExecutionGroup::initExecution()
   if (this->m_chunkExecutionStates != NULL) {
     MEM_freeN(this->m_chunkExecutionStates);
   }
+  if (this->m_chunkExecutionTimes != NULL) {
+    MEM_freeN(this->m_chunkExecutionTimes);
+  }
   unsigned int index;
   determineNumberOfChunks();
 
   this->m_chunkExecutionStates = NULL;
+  this->m_chunkExecutionTimes = NULL;
   if (this->m_numberOfChunks != 0) {
     this->m_chunkExecutionStates = (ChunkExecutionState *)MEM_mallocN(
         sizeof(ChunkExecutionState) * this->m_numberOfChunks, __func__);
     for (index = 0; index < this->m_numberOfChunks; index++) {
       this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
     }
+    this->m_chunkExecutionTimes = (double *)MEM_callocN(
+        sizeof(double) * this->m_numberOfChunks, __func__);
   }
 
   unsigned int maxNumber = 0;
@@ -156,6 +187,10 @@ void ExecutionGroup::deinitExecution()
     MEM_freeN(this->m_chunkExecutionStates);
     this->m_chunkExecutionStates = NULL;
   }
+  if (this->m_chunkExecutionTimes != NULL) {
+    MEM_freeN(this->m_chunkExecutionTimes);
+    this->m_chunkExecutionTimes = NULL;
+  }
   this->m_numberOfChunks = 0;
   this->m_numberOfXChunks = 0;
   this->m_numberOfYChunks = 0;
@@ -192,18 +227,18 @@ void ExecutionGroup::determineNumberOfChunks()
  * this method is called for the top execution groups. containing the compositor node or the
  * preview node or the viewer node)
  */
-void ExecutionGroup::execute(ExecutionSystem *graph)
+bool ExecutionGroup::executionStart(ExecutionSystem *graph)
 {
   const CompositorContext &context = graph->getContext();
   const bNodeTree *bTree = context.getbNodeTree();
   if (this->m_width == 0 || this->m_height == 0) {
-    return;
+    return false;
   }  /// \note Break out... no pixels to calculate.
   if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-    return;
+    return false;
   }  /// \note Early break out for blur and preview nodes.
   if (this->m_numberOfChunks == 0) {
-    return;
+    return false;
   }  /// \note Early break out.
   unsigned int chunkNumber;
 
@@ -319,56 +354,90 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       break;
   }
 
+  this->m_chunkOrder = chunkOrder;
+  this->m_chunkOrderStartIndex = 0;
+
   DebugInfo::execution_group_started(this);
   DebugInfo::graphviz(graph);
 
-  bool breaked = false;
-  bool finished = false;
-  unsigned int startIndex = 0;
+  return true;
+}
+
+bool ExecutionGroup::scheduleChunks(ExecutionSystem *graph)
+{
+  const bNodeTree *bTree = this->m_bTree;
+  const unsigned int *chunkOrder = this->m_chunkOrder;
   const int maxNumberEvaluated = BLI_system_thread_count() * 2;
+  bool startEvaluated = false;
+  bool finished = true;
+  int numberEvaluated = 0;
+  unsigned int index;
 
-  while (!finished && !breaked) {
-    bool startEvaluated = false;
-    finished = true;
-    int numberEvaluated = 0;
-
-    for (index = startIndex;
-         index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated;
-         index++) {
-      chunkNumber = chunkOrder[index];
-      int yChunk = chunkNumber / this->m_numberOfXChunks;
-      int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-      const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-      if (state == COM_ES_NOT_SCHEDULED) {
-        scheduleChunkWhenPossible(graph, xChunk, yChunk);
-        finished = false;
-        startEvaluated = true;
-        numberEvaluated++;
-
-        if (bTree->update_draw) {
-          bTree->update_draw(bTree->udh);
-        }
-      }
-      else if (state == COM_ES_SCHEDULED) {
-        finished = false;
-        startEvaluated = true;
-        numberEvaluated++;
-      }
-      else if (state == COM_ES_EXECUTED && !startEvaluated) {
-        startIndex = index + 1;
+  for (index = this->m_chunkOrderStartIndex;
+       index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated;
+       index++) {
+    const unsigned int chunkNumber = chunkOrder[index];
+    int yChunk = chunkNumber / this->m_numberOfXChunks;
+    int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
+    const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
+    if (state == COM_ES_NOT_SCHEDULED) {
+      scheduleChunkWhenPossible(graph, xChunk, yChunk);
+      finished = false;
+      startEvaluated = true;
+      numberEvaluated++;
+
+      if (bTree->update_draw) {
+        bTree->update_draw(bTree->udh);
       }
     }
-
-    WorkScheduler::finish();
-
-    if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-      breaked = true;
+    else if (state == COM_ES_SCHEDULED) {
+      finished = false;
+      startEvaluated = true;
+      numberEvaluated++;
+    }
+    else if (state == COM_ES_EXECUTED && !startEvaluated) {
+      this->m_chunkOrderStartIndex = index + 1;
     }
   }
+
+  return finished;
+}
+
+void ExecutionGroup::executionFinish(ExecutionSystem *graph)
+{
   DebugInfo::execution_group_finished(this);
   DebugInfo::graphviz(graph);
 
-  MEM_freeN(chunkOrder);
+  MEM_freeN(this->m_chunkOrder);
+  this->m_chunkOrder = NULL;
+}
+
+void ExecutionGroup::printChunkStatistics() const
+{
+  unsigned int numberExecuted = 0;
+  double totalTime = 0.0;
+  double maxTime = 0.0;
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] == COM_ES_EXECUTED) {
+      numberExecuted++;
+      totalTime += this->m_chunkExecutionTimes[index];
+      maxTime = max_dd(maxTime, this->m_chunkExecutionTimes[index]);
+    }
+  }
+  if (numberExecuted == 0) {
+    return;
+  }
+  printf("Compositor: group %p (%ux%u, chunk size %u): %u/%u chunks, %.3fs total, "
+         "%.3fms average, %.3fms max\n",
+         this,
+         this->m_width,
+         this->m_height,
+         this->m_chunkSize,
+         numberExecuted,
+         this->m_numberOfChunks,
+         totalTime,
+         totalTime * 1000.0 / numberExecuted,
+         maxTime * 1000.0);
 }
 
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
@@ -403,8 +472,11 @@ MemoryBuffer *ExecutionGroup::constructConsolidatedMemoryBuffer(MemoryProxy *mem
   return result;
 }
 
-void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
+void ExecutionGroup::finalizeChunkExecution(int chunkNumber,
+                                            MemoryBuffer **memoryBuffers,
+                                            double executionTime)
 {
+  this->m_chunkExecutionTimes[chunkNumber] = executionTime;
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
   }
@@ -28,8 +28,10 @@
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
+#include <string>
 #include <vector>
 
+using std::string;
 using std::vector;
 
 class ExecutionSystem;
@@ -158,6 +160,21 @@ class ExecutionGroup {
    */
   ChunkExecutionState *m_chunkExecutionStates;
 
+  /**
+   * \brief time in seconds it took to calculate each chunk, used for statistics.
+   */
+  double *m_chunkExecutionTimes;
+
+  /**
+   * \brief order in which the chunks are scheduled, only valid during execution.
+   */
+  unsigned int *m_chunkOrder;
+
+  /**
+   * \brief index in m_chunkOrder before which all chunks have been executed.
+   */
+  unsigned int m_chunkOrderStartIndex;
+
   /**
    * \brief indicator when this ExecutionGroup has valid Operations in its vector for Execution
    * \note When building the ExecutionGroup Operations are added via recursion.
@@ -181,6 +198,12 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief key of the result of this ExecutionGroup in the ResultCache.
+   * empty when the result can't be cached.
+   */
+  string m_resultCacheKey;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -332,6 +355,26 @@ class ExecutionGroup {
    */
   NodeOperation *getOutputOperation() const;
 
+  void setResultCacheKey(const string &key)
+  {
+    this->m_resultCacheKey = key;
+  }
+  const string &getResultCacheKey() const
+  {
+    return this->m_resultCacheKey;
+  }
+
+  /**
+   * \brief mark all chunks as executed, without calculating them.
+   * \note used when the output buffer is restored from the ResultCache
+   */
+  void setChunksExecuted();
+
+  /**
+   * \brief have all chunks of this ExecutionGroup been calculated
+   */
+  bool isChunksExecuted() const;
+
   /**
    * \brief compose multiple chunks into a single chunk
    * \return Memorybuffer *consolidated chunk
@@ -372,8 +415,11 @@ class ExecutionGroup {
    * \brief after a chunk is executed the needed resources can be freed or unlocked.
    * \param chunknumber:
    * \param memorybuffers:
+   * \param executionTime: time in seconds it took to calculate the chunk
    */
-  void finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers);
+  void finalizeChunkExecution(int chunkNumber,
+                              MemoryBuffer **memoryBuffers,
+                              double executionTime);
 
   /**
    * \brief deinitExecution is called just after execution the whole graph.
@@ -382,9 +428,7 @@ class ExecutionGroup {
   void deinitExecution();
 
   /**
-   * \brief schedule an ExecutionGroup
-   * \note this method will return when all chunks have been calculated, or the execution has
-   * breaked (by user)
+   * \brief start the execution of an output ExecutionGroup
    *
    * first the order of the chunks will be determined. This is determined by finding the
    * ViewerOperation and get the relevant information from it.
@@ -392,12 +436,39 @@ class ExecutionGroup {
    *   - CenterX
    *   - CenterY
    *
-   * After determining the order of the chunks the chunks will be scheduled
+   * After determining the order of the chunks the chunks can be scheduled with scheduleChunks.
    *
    * \see ViewerOperation
    * \param system:
+   * \return [true:false]
+   * true: the execution is started
+   * false: there is nothing to calculate, scheduleChunks and executionFinish must not be called
+   */
+  bool executionStart(ExecutionSystem *system);
+
+  /**
+   * \brief schedule the chunks of an output ExecutionGroup whose input chunks are available
+   * \note this method doesn't wait for the scheduled chunks. The ExecutionSystem calls it for
+   * all output groups of a priority every time a chunk has finished, so the chunks of
+   * independent groups are calculated at the same time.
+   * \param system:
+   * \return [true:false]
+   * true: all chunks have been calculated
+   * false: chunks are still waiting to be scheduled or calculated
+   */
+  bool scheduleChunks(ExecutionSystem *system);
+
+  /**
+   * \brief finish the execution of an output ExecutionGroup
+   * \param system:
+   */
+  void executionFinish(ExecutionSystem *system);
+
+  /**
+   * \brief print the number of calculated chunks and their calculation times
+   * \note only valid between initExecution and deinitExecution
    */
-  void execute(ExecutionSystem *system);
+  void printChunkStatistics() const;
 
   /**
    * \brief this method determines the MemoryProxy's where this execution group depends on.
@@ -21,6 +21,7 @@
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
+#include "BKE_global.h"
 #include "BKE_node.h"
 
 #include "BLT_translation.h"
@@ -31,6 +32,7 @@
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -177,6 +179,8 @@ void ExecutionSystem::execute()
     executionGroup->initExecution();
   }
 
+  ResultCache::restore(this);
+
   WorkScheduler::start(this->m_context);
 
   executeGroups(COM_PRIORITY_HIGH);
@@ -188,6 +192,16 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  if (!editingtree->test_break(editingtree->tbh)) {
+    ResultCache::store(this);
+  }
+
+  if (G.debug & G_DEBUG) {
+    for (index = 0; index < this->m_groups.size(); index++) {
+      this->m_groups[index]->printChunkStatistics();
+    }
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -201,13 +215,45 @@ void ExecutionSystem::execute()
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
+  const bNodeTree *bTree = this->m_context.getbNodeTree();
   unsigned int index;
+  vector<ExecutionGroup *> outputGroups;
   vector<ExecutionGroup *> executionGroups;
-  this->findOutputExecutionGroup(&executionGroups, priority);
+  this->findOutputExecutionGroup(&outputGroups, priority);
+
+  for (index = 0; index < outputGroups.size(); index++) {
+    ExecutionGroup *group = outputGroups[index];
+    if (group->executionStart(this)) {
+      executionGroups.push_back(group);
+    }
+  }
+
+  /* Schedule the chunks of all output groups together, so chunks of independent groups are
+   * calculated at the same time. New chunks are scheduled as soon as any chunk has finished,
+   * instead of waiting for all scheduled chunks. */
+  bool breaked = false;
+  bool finished = false;
+  while (!finished && !breaked) {
+    finished = true;
+    for (index = 0; index < executionGroups.size(); index++) {
+      if (!executionGroups[index]->scheduleChunks(this)) {
+        finished = false;
+      }
+    }
+
+    if (!finished) {
+      WorkScheduler::wait_for_progress();
+    }
+
+    if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+      breaked = true;
+    }
+  }
+
+  WorkScheduler::finish();
 
   for (index = 0; index < executionGroups.size(); index++) {
-    ExecutionGroup *group = executionGroups[index];
-    group->execute(this);
+    executionGroups[index]->executionFinish(this);
   }
 }
 
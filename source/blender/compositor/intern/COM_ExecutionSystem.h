@@ -190,6 +190,8 @@ class ExecutionSystem {
 
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
+  /* allow the ResultCache class to look at the execution groups */
+  friend class ResultCache;
 
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionSystem")
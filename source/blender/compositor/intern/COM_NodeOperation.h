@@ -118,6 +118,19 @@ class NodeOperation : public SocketReader {
    */
   const bNodeTree *m_btree;
 
+  /**
+   * \brief the node this operation is created for, NULL for operations added by the
+   * NodeOperationBuilder itself (conversions, buffers, constants).
+   * \see ResultCache
+   */
+  const bNode *m_bnode;
+
+  /**
+   * \brief the order in which m_bnode created this operation. Together with the settings of
+   * m_bnode it identifies the settings of this operation.
+   */
+  int m_bnodeOperationIndex;
+
   /**
    * \brief set to truth when resolution for this operation is set
    */
@@ -187,6 +200,19 @@ class NodeOperation : public SocketReader {
   {
     this->m_btree = tree;
   }
+  void setbNode(const bNode *node, int operationIndex)
+  {
+    this->m_bnode = node;
+    this->m_bnodeOperationIndex = operationIndex;
+  }
+  const bNode *getbNode() const
+  {
+    return this->m_bnode;
+  }
+  int getbNodeOperationIndex() const
+  {
+    return this->m_bnodeOperationIndex;
+  }
   virtual void initExecution();
 
   /**
@@ -19,6 +19,8 @@
 #include "COM_OpenCLDevice.h"
 #include "COM_WorkScheduler.h"
 
+#include "PIL_time.h"
+
 typedef enum COM_VendorID { NVIDIA = 0x10DE, AMD = 0x1002 } COM_VendorID;
 const cl_image_format IMAGE_FORMAT_COLOR = {
     CL_RGBA,
@@ -63,6 +65,7 @@ void OpenCLDevice::execute(WorkPackage *work)
 {
   const unsigned int chunkNumber = work->getChunkNumber();
   ExecutionGroup *executionGroup = work->getExecutionGroup();
+  const double startTime = PIL_check_seconds_timer();
   rcti rect;
 
   executionGroup->determineChunkRect(&rect, chunkNumber);
@@ -74,7 +77,8 @@ void OpenCLDevice::execute(WorkPackage *work)
 
   delete outputBuffer;
 
-  executionGroup->finalizeChunkExecution(chunkNumber, inputBuffers);
+  executionGroup->finalizeChunkExecution(
+      chunkNumber, inputBuffers, PIL_check_seconds_timer() - startTime);
 }
 cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel,
                                                                int parameterIndex,
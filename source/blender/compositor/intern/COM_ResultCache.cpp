@@ -0,0 +1,573 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include "COM_ResultCache.h"
+
+#include <map>
+#include <string.h>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "BLI_hash_md5.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_ID.h"
+#include "DNA_camera_types.h"
+#include "DNA_color_types.h"
+#include "DNA_genfile.h"
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sdna_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_camera.h"
+#include "BKE_image.h"
+#include "BKE_node.h"
+
+#include "COM_ExecutionGroup.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+#include "COM_NodeOperation.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+typedef struct ResultCacheEntry {
+  std::string key;
+  MemoryBuffer *buffer;
+  size_t size;
+  /** Value of g_cache_clock when the entry was stored or restored. */
+  unsigned int last_used;
+} ResultCacheEntry;
+
+static ThreadMutex g_cache_mutex = BLI_MUTEX_INITIALIZER;
+static std::vector<ResultCacheEntry> g_cache_entries;
+static size_t g_cache_size = 0;
+static unsigned int g_cache_clock = 0;
+/** Incremented by ResultCache::clear, results of executions that started before are dropped. */
+static unsigned int g_cache_generation = 0;
+/** Generation of the cache when the last ResultCache::restore was done. */
+static unsigned int g_restore_generation = 0;
+
+/* -------------------------------------------------------------------- */
+/** \name Hashing
+ * \{ */
+
+/** Clear the pointers of a DNA struct, including the ones of nested structs. */
+static void dna_struct_clear_pointers(const SDNA *sdna, int struct_nr, char *data)
+{
+  const short *sp = sdna->structs[struct_nr];
+  const int members_len = sp[1];
+  for (int member = 0; member < members_len; member++) {
+    const short type = sp[2 + member * 2];
+    const short name = sp[3 + member * 2];
+    const char *member_name = sdna->names[name];
+    const int size = DNA_elem_size_nr(sdna, type, name);
+    if (member_name[0] == '*' || (member_name[0] == '(' && member_name[1] == '*')) {
+      memset(data, 0, size);
+    }
+    else {
+      const int member_struct_nr = DNA_struct_find_nr(sdna, sdna->types[type]);
+      if (member_struct_nr != -1) {
+        for (int a = 0; a < sdna->names_array_len[name]; a++) {
+          dna_struct_clear_pointers(sdna, member_struct_nr, data + a * sdna->types_size[type]);
+        }
+      }
+    }
+    data += size;
+  }
+}
+
+/**
+ * Build up the data of a digest. An empty digest means the data can't be cached.
+ * Pointers are never added, their values differ between sessions and reused addresses would
+ * give false matches.
+ */
+class Digest {
+ private:
+  std::string m_data;
+
+ public:
+  void add(const void *data, size_t size)
+  {
+    m_data.append((const char *)data, size);
+  }
+  template<typename T> void add(const T &value)
+  {
+    add(&value, sizeof(T));
+  }
+  void add_string(const char *str)
+  {
+    if (str) {
+      add(str, strlen(str) + 1);
+    }
+  }
+  /** Add a DNA struct with its pointers cleared, returns false for unknown structs. */
+  bool add_dna_struct(const char *struct_name, const void *data)
+  {
+    const SDNA *sdna = DNA_sdna_current_get();
+    const int struct_nr = DNA_struct_find_nr(sdna, struct_name);
+    if (struct_nr == -1) {
+      return false;
+    }
+    const size_t size = sdna->types_size[sdna->structs[struct_nr][0]];
+    const size_t offset = m_data.size();
+    m_data.append((const char *)data, size);
+    dna_struct_clear_pointers(sdna, struct_nr, &m_data[offset]);
+    return true;
+  }
+  /** Datablocks are identified by name, names are unique within a library. */
+  void add_id(const ID *id)
+  {
+    if (id == NULL) {
+      add(-1);
+      return;
+    }
+    add_string(id->name);
+    add_string(id->lib ? id->lib->filepath : "");
+  }
+  void add_curvemapping(const CurveMapping *cumap)
+  {
+    if (cumap == NULL) {
+      return;
+    }
+    /* Only the settings and curve points, the tables are derived from them. */
+    CurveMapping settings = *cumap;
+    for (int a = 0; a < CM_TOT; a++) {
+      settings.cm[a].curve = NULL;
+      settings.cm[a].table = NULL;
+      settings.cm[a].premultable = NULL;
+    }
+    add(settings);
+    for (int a = 0; a < CM_TOT; a++) {
+      const CurveMap *cuma = &cumap->cm[a];
+      if (cuma->curve) {
+        add(cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+      }
+    }
+  }
+
+  /** MD5 of the collected data, fixed size so digests can be combined cheaply. */
+  std::string md5() const
+  {
+    char result[16];
+    BLI_hash_md5_buffer(m_data.data(), m_data.size(), result);
+    return std::string(result, sizeof(result));
+  }
+};
+
+class DigestBuilder {
+ private:
+  const Scene *m_scene;
+  std::string m_context_digest;
+  std::map<const bNode *, std::string> m_node_digests;
+  std::map<NodeOperation *, std::string> m_operation_digests;
+
+  static bool node_is_cacheable(const bNode *node)
+  {
+    switch (node->type) {
+      /* Data that can change without the node tree being changed. */
+      case CMP_NODE_MOVIECLIP:
+      case CMP_NODE_MOVIEDISTORTION:
+      case CMP_NODE_STABILIZE2D:
+      case CMP_NODE_TRACKPOS:
+      case CMP_NODE_KEYINGSCREEN:
+      case CMP_NODE_PLANETRACKDEFORM:
+      case CMP_NODE_MASK:
+      case CMP_NODE_TEXTURE:
+      case CMP_NODE_TIME:
+      case CMP_NODE_CRYPTOMATTE:
+        return false;
+      case CMP_NODE_IMAGE: {
+        Image *ima = (Image *)node->id;
+        if (ima && (ELEM(ima->type, IMA_TYPE_R_RESULT, IMA_TYPE_COMPOSITE) ||
+                    BKE_image_is_dirty(ima))) {
+          return false;
+        }
+        return true;
+      }
+      default:
+        return true;
+    }
+  }
+
+  static bool add_sockets(Digest &digest, const ListBase *sockets)
+  {
+    LISTBASE_FOREACH (const bNodeSocket *, sock, sockets) {
+      digest.add(sock->type);
+      if (sock->default_value == NULL) {
+        continue;
+      }
+      switch (sock->type) {
+        case SOCK_FLOAT:
+          digest.add(*(const bNodeSocketValueFloat *)sock->default_value);
+          break;
+        case SOCK_INT:
+          digest.add(*(const bNodeSocketValueInt *)sock->default_value);
+          break;
+        case SOCK_BOOLEAN:
+          digest.add(*(const bNodeSocketValueBoolean *)sock->default_value);
+          break;
+        case SOCK_VECTOR:
+          digest.add(*(const bNodeSocketValueVector *)sock->default_value);
+          break;
+        case SOCK_RGBA:
+          digest.add(*(const bNodeSocketValueRGBA *)sock->default_value);
+          break;
+        default:
+          /* Values of other socket types are not used by the compositor. */
+          return false;
+      }
+    }
+    return true;
+  }
+
+  /** The scene camera is used by defocus to convert depth to blur radius. */
+  void add_camera(Digest &digest, const Scene *scene)
+  {
+    Object *camera_object = scene ? scene->camera : NULL;
+    if (camera_object == NULL || camera_object->type != OB_CAMERA) {
+      digest.add(-1);
+      return;
+    }
+    const Camera *camera = (const Camera *)camera_object->data;
+    digest.add(camera->lens);
+    digest.add(camera->sensor_fit);
+    digest.add(camera->sensor_x);
+    digest.add(camera->sensor_y);
+    digest.add(BKE_camera_object_dof_distance(camera_object));
+  }
+
+  const std::string &node_digest(const bNode *node)
+  {
+    std::map<const bNode *, std::string>::iterator it = m_node_digests.find(node);
+    if (it != m_node_digests.end()) {
+      return it->second;
+    }
+
+    std::string &result = m_node_digests[node];
+    if (!node_is_cacheable(node)) {
+      return result;
+    }
+
+    Digest digest;
+    digest.add(node->type);
+    digest.add(node->custom1);
+    digest.add(node->custom2);
+    digest.add(node->custom3);
+    digest.add(node->custom4);
+    digest.add_id(node->id);
+    if (node->storage) {
+      if (ELEM(node->type, CMP_NODE_CURVE_RGB, CMP_NODE_CURVE_VEC, CMP_NODE_HUECORRECT)) {
+        digest.add_curvemapping((const CurveMapping *)node->storage);
+      }
+      else if (!digest.add_dna_struct(node->typeinfo->storagename, node->storage)) {
+        return result;
+      }
+    }
+    if (node->type == CMP_NODE_IMAGE && node->id) {
+      Image *ima = (Image *)node->id;
+      /* Changes when the buffers are reloaded or modified. */
+      digest.add(BKE_image_content_version(ima));
+      digest.add(ima->source);
+      digest.add(ima->type);
+      digest.add_string(ima->filepath);
+      digest.add(ima->gen_x);
+      digest.add(ima->gen_y);
+      digest.add(ima->gen_type);
+      digest.add(ima->gen_flag);
+      digest.add(ima->gen_depth);
+      digest.add(ima->gen_color);
+      digest.add_string(ima->colorspace_settings.name);
+      digest.add(ima->alpha_mode);
+    }
+    if (node->type == CMP_NODE_DEFOCUS) {
+      add_camera(digest, node->id ? (const Scene *)node->id : m_scene);
+    }
+    if (!add_sockets(digest, &node->inputs) || !add_sockets(digest, &node->outputs)) {
+      return result;
+    }
+
+    result = digest.md5();
+    return result;
+  }
+
+ public:
+  DigestBuilder(const CompositorContext &context) : m_scene(context.getScene())
+  {
+    Digest digest;
+    digest.add_id(m_scene ? &m_scene->id : NULL);
+    if (context.getRenderData()) {
+      digest.add_dna_struct("RenderData", context.getRenderData());
+    }
+    digest.add(context.getQuality());
+    digest.add(context.getFramenumber());
+    digest.add(context.isFastCalculation());
+    digest.add_string(context.getViewName());
+    const ColorManagedViewSettings *view_settings = context.getViewSettings();
+    if (view_settings) {
+      digest.add_string(view_settings->look);
+      digest.add_string(view_settings->view_transform);
+      digest.add(view_settings->flag);
+      digest.add(view_settings->exposure);
+      digest.add(view_settings->gamma);
+      digest.add_curvemapping(view_settings->curve_mapping);
+    }
+    const ColorManagedDisplaySettings *display_settings = context.getDisplaySettings();
+    if (display_settings) {
+      digest.add_string(display_settings->display_device);
+    }
+    m_context_digest = digest.md5();
+  }
+
+  /**
+   * Digest of the result of an operation, combining the digests of everything it reads from.
+   * Empty when the result can't be cached.
+   */
+  const std::string &operation_digest(NodeOperation *operation)
+  {
+    std::map<NodeOperation *, std::string>::iterator it = m_operation_digests.find(operation);
+    if (it != m_operation_digests.end()) {
+      return it->second;
+    }
+    /* Inserting an empty digest first also guards against cycles. */
+    std::string &result = m_operation_digests[operation];
+
+    if (operation->isReadBufferOperation()) {
+      ReadBufferOperation *read_operation = (ReadBufferOperation *)operation;
+      WriteBufferOperation *write_operation =
+          read_operation->getMemoryProxy()->getWriteBufferOperation();
+      if (write_operation == NULL) {
+        return result;
+      }
+      Digest digest;
+      digest.add("ReadBuffer", 10);
+      digest.add(operation->getWidth());
+      digest.add(operation->getHeight());
+      const std::string &write_digest = operation_digest(write_operation);
+      if (write_digest.empty()) {
+        return result;
+      }
+      digest.add(write_digest.data(), write_digest.size());
+      result = digest.md5();
+      return result;
+    }
+
+    Digest digest;
+    const char *type_name = typeid(*operation).name();
+    digest.add_string(type_name);
+    digest.add(operation->getWidth());
+    digest.add(operation->getHeight());
+
+    const bNode *node = operation->getbNode();
+    if (node) {
+      const std::string &digest_node = node_digest(node);
+      if (digest_node.empty()) {
+        return result;
+      }
+      digest.add(digest_node.data(), digest_node.size());
+      digest.add(operation->getbNodeOperationIndex());
+    }
+
+    if (operation->isSetOperation()) {
+      float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      operation->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+      digest.add(value);
+    }
+
+    for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+      NodeOperationOutput *link = operation->getInputSocket(index)->getLink();
+      if (link == NULL) {
+        digest.add(-1);
+        continue;
+      }
+      NodeOperation *input_operation = &link->getOperation();
+      const std::string &input_digest = operation_digest(input_operation);
+      if (input_digest.empty()) {
+        return result;
+      }
+      digest.add(input_digest.data(), input_digest.size());
+      for (unsigned int output = 0; output < input_operation->getNumberOfOutputSockets();
+           output++) {
+        if (input_operation->getOutputSocket(output) == link) {
+          digest.add(output);
+          break;
+        }
+      }
+    }
+
+    result = digest.md5();
+    return result;
+  }
+
+  /** Key of the result of a group, empty when it can't be cached. */
+  std::string group_key(ExecutionGroup *group)
+  {
+    if (!group->isComplex()) {
+      return std::string();
+    }
+    NodeOperation *output = group->getOutputOperation();
+    if (!output->isWriteBufferOperation()) {
+      return std::string();
+    }
+    const std::string digest = operation_digest(output);
+    if (digest.empty()) {
+      return digest;
+    }
+    return m_context_digest + digest;
+  }
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache
+ * \{ */
+
+static void cache_entry_free(ResultCacheEntry &entry)
+{
+  delete entry.buffer;
+  g_cache_size -= entry.size;
+}
+
+static ResultCacheEntry *cache_lookup(const std::string &key)
+{
+  for (size_t index = 0; index < g_cache_entries.size(); index++) {
+    if (g_cache_entries[index].key == key) {
+      return &g_cache_entries[index];
+    }
+  }
+  return NULL;
+}
+
+/** Memory budget in bytes, the cache limit of the preferences. */
+static size_t cache_memory_limit()
+{
+  return ((size_t)U.memcachelimit) * 1024 * 1024;
+}
+
+/** Free least recently used entries until `size` more bytes fit in the budget. */
+static void cache_make_room(size_t size)
+{
+  const size_t limit = cache_memory_limit();
+  while (!g_cache_entries.empty() && g_cache_size + size > limit) {
+    size_t oldest = 0;
+    for (size_t index = 1; index < g_cache_entries.size(); index++) {
+      if (g_cache_entries[index].last_used < g_cache_entries[oldest].last_used) {
+        oldest = index;
+      }
+    }
+    cache_entry_free(g_cache_entries[oldest]);
+    g_cache_entries.erase(g_cache_entries.begin() + oldest);
+  }
+}
+
+static size_t buffer_size(MemoryBuffer *buffer)
+{
+  return sizeof(float) * buffer->get_num_channels() * buffer->getWidth() * buffer->getHeight();
+}
+
+void ResultCache::restore(ExecutionSystem *system)
+{
+  DigestBuilder builder(system->getContext());
+
+  BLI_mutex_lock(&g_cache_mutex);
+  g_restore_generation = g_cache_generation;
+  for (unsigned int index = 0; index < system->m_groups.size(); index++) {
+    ExecutionGroup *group = system->m_groups[index];
+    group->setResultCacheKey(builder.group_key(group));
+    if (group->getResultCacheKey().empty()) {
+      continue;
+    }
+
+    ResultCacheEntry *entry = cache_lookup(group->getResultCacheKey());
+    if (entry == NULL) {
+      continue;
+    }
+    WriteBufferOperation *write_operation = (WriteBufferOperation *)group->getOutputOperation();
+    MemoryBuffer *buffer = write_operation->getMemoryProxy()->getBuffer();
+    if (buffer == NULL || buffer->getWidth() != entry->buffer->getWidth() ||
+        buffer->getHeight() != entry->buffer->getHeight() ||
+        buffer->get_num_channels() != entry->buffer->get_num_channels()) {
+      continue;
+    }
+    memcpy(buffer->getBuffer(), entry->buffer->getBuffer(), entry->size);
+    entry->last_used = ++g_cache_clock;
+    group->setChunksExecuted();
+  }
+  BLI_mutex_unlock(&g_cache_mutex);
+}
+
+void ResultCache::store(ExecutionSystem *system)
+{
+  BLI_mutex_lock(&g_cache_mutex);
+  if (g_restore_generation != g_cache_generation) {
+    /* Cache was cleared during execution, the inputs may have changed. */
+    BLI_mutex_unlock(&g_cache_mutex);
+    return;
+  }
+  for (unsigned int index = 0; index < system->m_groups.size(); index++) {
+    ExecutionGroup *group = system->m_groups[index];
+    const std::string &key = group->getResultCacheKey();
+    if (key.empty() || !group->isChunksExecuted() || cache_lookup(key)) {
+      continue;
+    }
+    WriteBufferOperation *write_operation = (WriteBufferOperation *)group->getOutputOperation();
+    MemoryBuffer *buffer = write_operation->getMemoryProxy()->getBuffer();
+    if (buffer == NULL) {
+      continue;
+    }
+    const size_t size = buffer_size(buffer);
+    if (size > cache_memory_limit()) {
+      continue;
+    }
+    cache_make_room(size);
+
+    ResultCacheEntry entry;
+    entry.key = key;
+    entry.buffer = new MemoryBuffer(write_operation->getMemoryProxy()->getDataType(),
+                                    buffer->getRect());
+    entry.buffer->copyContentFrom(buffer);
+    entry.size = size;
+    entry.last_used = ++g_cache_clock;
+    g_cache_entries.push_back(entry);
+    g_cache_size += size;
+  }
+  BLI_mutex_unlock(&g_cache_mutex);
+}
+
+void ResultCache::clear()
+{
+  BLI_mutex_lock(&g_cache_mutex);
+  for (size_t index = 0; index < g_cache_entries.size(); index++) {
+    cache_entry_free(g_cache_entries[index]);
+  }
+  g_cache_entries.clear();
+  BLI_assert(g_cache_size == 0);
+  g_cache_generation++;
+  BLI_mutex_unlock(&g_cache_mutex);
+}
+
+/** \} */
@@ -0,0 +1,57 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+class ExecutionSystem;
+
+/**
+ * \brief Cache of the results of complex ExecutionGroups between executions.
+ *
+ * Every ExecutionGroup that writes its result to a WriteBufferOperation gets a key, a hash of
+ * the node settings, socket values and resolutions of all operations it depends on. Images are
+ * keyed on their content version (see BKE_image_content_version) and defocus on the scene
+ * camera. When an earlier execution stored a result with the same key the buffer is copied from
+ * the cache and the group (including everything upstream of it) is not executed again.
+ *
+ * Only results of complex groups are cached, those are the expensive ones (blur, defocus,
+ * glare...) and their buffers are already kept for the whole execution.
+ * Operations reading data that can change without the node tree changing (movie clips, masks,
+ * textures, dirty images) make the dependent results uncacheable. Render results are handled
+ * by clearing the cache when they change (see COM_clearCaches), the cache is also cleared when
+ * a file is loaded. Memory usage is limited by the cache limit of the preferences.
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief compute the cache keys of the execution groups and restore cached results.
+   * \note needs to be called after the operations and execution groups are initialized.
+   */
+  static void restore(ExecutionSystem *system);
+
+  /**
+   * \brief store the results of the fully calculated cacheable execution groups.
+   * \note needs to be called before the operations are deinitialized.
+   */
+  static void store(ExecutionSystem *system);
+
+  /**
+   * \brief free all cached results.
+   */
+  static void clear();
+};
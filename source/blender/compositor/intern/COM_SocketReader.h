@@ -94,6 +94,24 @@ class SocketReader {
   {
   }
 
+  /**
+   * \brief calculate a row of pixels with nearest sampling
+   * \note this method is called for non-complex, the default implementation calls
+   * executePixelSampled for every pixel. Pixel-wise operations can override it to process
+   * the whole row at once, reading their inputs with readRow.
+   * \param output: is an array of len * 4 floats to store the result, only the channels of the
+   * output data type of each pixel are written
+   * \param x: the x-coordinate of the first pixel of the row in image space
+   * \param y: the y-coordinate of the row in image space
+   * \param len: the number of pixels to calculate, at most COM_ROW_LENGTH
+   */
+  virtual void executeRow(float *output, int x, int y, int len)
+  {
+    for (int i = 0; i < len; i++, output += 4) {
+      executePixelSampled(output, x + i, y, COM_PS_NEAREST);
+    }
+  }
+
  public:
   inline void readSampled(float result[4], float x, float y, PixelSampler sampler)
   {
@@ -107,6 +125,10 @@ class SocketReader {
   {
     executePixelFiltered(result, x, y, dx, dy);
   }
+  inline void readRow(float *result, int x, int y, int len)
+  {
+    executeRow(result, x, y, len);
+  }
 
   virtual void *initializeTileData(rcti * /*rect*/)
   {
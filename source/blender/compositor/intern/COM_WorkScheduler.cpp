@@ -29,17 +29,24 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "PIL_time.h"
 
 #include "BKE_global.h"
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+#  include <tbb/task_arena.h>
+#endif
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
 #  ifndef DEBUG /* test this so we dont get warnings in debug builds */
 #    warning COM_CURRENT_THREADING_MODEL COM_TM_NOTHREAD is activated. Use only for debugging.
 #  endif
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-/* do nothing - default */
+/* do nothing - default without TBB */
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/* do nothing - default with TBB */
 #else
 #  error COM_CURRENT_THREADING_MODEL No threading model selected
 #endif
@@ -54,6 +61,24 @@ static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
 /// \brief all scheduled work for the cpu
 static ThreadQueue *g_cpuqueue;
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/// \brief task pool executing all scheduled work for the cpu
+static TaskPool *g_cpupool;
+/// \brief arena limiting the task pool to the number of threads of the render settings
+static tbb::task_arena *g_cpuarena = NULL;
+/// \brief work scheduled but not pushed to the task pool yet, only used by the scheduling thread
+static vector<WorkPackage *> g_cpu_scheduled;
+#endif
+
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+/// \brief number of scheduled and finished work packages, protected by g_progress_mutex
+static unsigned int g_work_scheduled = 0;
+static unsigned int g_work_finished = 0;
+/// \brief number of finished work packages at the last WorkScheduler::wait_for_progress
+static unsigned int g_work_finished_seen = 0;
+static ThreadMutex g_progress_mutex = BLI_MUTEX_INITIALIZER;
+static ThreadCondition g_progress_cond;
+
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -71,6 +96,16 @@ static bool g_openclInitialized = false;
 #  endif
 #endif
 
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+static void work_finished()
+{
+  BLI_mutex_lock(&g_progress_mutex);
+  g_work_finished++;
+  BLI_condition_notify_all(&g_progress_cond);
+  BLI_mutex_unlock(&g_progress_mutex);
+}
+#endif
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
@@ -80,11 +115,44 @@ void *WorkScheduler::thread_execute_cpu(void *data)
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
     device->execute(work);
     delete work;
+    work_finished();
   }
 
   return NULL;
 }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+void WorkScheduler::thread_execute_task(TaskPool *__restrict /*pool*/, void *data)
+{
+  WorkPackage *work = (WorkPackage *)data;
+  CPUDevice device(BLI_task_parallel_thread_id(NULL));
+  device.execute(work);
+  work_finished();
+}
+
+static void work_package_free(TaskPool *__restrict /*pool*/, void *data)
+{
+  WorkPackage *work = (WorkPackage *)data;
+  delete work;
+}
 
+/* Entering the arena hands the calling thread over to it, do it once for all chunks scheduled
+ * together rather than for every chunk. Scheduling is always followed by waiting for progress
+ * or finishing, which push the scheduled work. */
+void WorkScheduler::push_scheduled_tasks()
+{
+  if (g_cpu_scheduled.empty()) {
+    return;
+  }
+  g_cpuarena->execute([] {
+    for (WorkPackage *package : g_cpu_scheduled) {
+      BLI_task_pool_push(g_cpupool, thread_execute_task, package, false, work_package_free);
+    }
+  });
+  g_cpu_scheduled.clear();
+}
+#endif
+
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 void *WorkScheduler::thread_execute_gpu(void *data)
 {
   Device *device = (Device *)data;
@@ -93,6 +161,7 @@ void *WorkScheduler::thread_execute_gpu(void *data)
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
     device->execute(work);
     delete work;
+    work_finished();
   }
 
   return NULL;
@@ -106,30 +175,45 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
   CPUDevice device(0);
   device.execute(package);
   delete package;
-#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#else
+  BLI_mutex_lock(&g_progress_mutex);
+  g_work_scheduled++;
+  BLI_mutex_unlock(&g_progress_mutex);
+
 #  ifdef COM_OPENCL_ENABLED
   if (group->isOpenCL() && g_openclActive) {
     BLI_thread_queue_push(g_gpuqueue, package);
+    return;
   }
-  else {
-    BLI_thread_queue_push(g_cpuqueue, package);
-  }
-#  else
+#  endif
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   BLI_thread_queue_push(g_cpuqueue, package);
+#  else
+  g_cpu_scheduled.push_back(package);
 #  endif
 #endif
 }
 
 void WorkScheduler::start(CompositorContext &context)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   unsigned int index;
+  g_work_scheduled = 0;
+  g_work_finished = 0;
+  g_work_finished_seen = 0;
+  BLI_condition_init(&g_progress_cond);
+#endif
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   g_cpuqueue = BLI_thread_queue_init();
   BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
   for (index = 0; index < g_cpudevices.size(); index++) {
     Device *device = g_cpudevices[index];
     BLI_threadpool_insert(&g_cputhreads, device);
   }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  g_cpupool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+#endif
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   if (context.getHasActiveOpenCLDevices()) {
     g_gpuqueue = BLI_thread_queue_init();
@@ -148,20 +232,38 @@ void WorkScheduler::start(CompositorContext &context)
 }
 void WorkScheduler::finish()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_wait_finish(g_gpuqueue);
-    BLI_thread_queue_wait_finish(g_cpuqueue);
-  }
-  else {
-    BLI_thread_queue_wait_finish(g_cpuqueue);
   }
+#  endif
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  BLI_thread_queue_wait_finish(g_cpuqueue);
 #  else
-  BLI_thread_queue_wait_finish(cpuqueue);
+  push_scheduled_tasks();
+  g_cpuarena->execute([] { BLI_task_pool_work_and_wait(g_cpupool); });
 #  endif
 #endif
 }
+void WorkScheduler::wait_for_progress()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  push_scheduled_tasks();
+  if (BLI_task_scheduler_num_threads() <= 1) {
+    /* Tasks are only executed by the waiting thread. */
+    g_cpuarena->execute([] { BLI_task_pool_work_and_wait(g_cpupool); });
+  }
+#endif
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+  BLI_mutex_lock(&g_progress_mutex);
+  while (g_work_finished == g_work_finished_seen && g_work_finished != g_work_scheduled) {
+    BLI_condition_wait(&g_progress_cond, &g_progress_mutex);
+  }
+  g_work_finished_seen = g_work_finished;
+  BLI_mutex_unlock(&g_progress_mutex);
+#endif
+}
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
@@ -169,6 +271,12 @@ void WorkScheduler::stop()
   BLI_threadpool_end(&g_cputhreads);
   BLI_thread_queue_free(g_cpuqueue);
   g_cpuqueue = NULL;
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  BLI_task_pool_free(g_cpupool);
+  g_cpupool = NULL;
+#endif
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+  BLI_condition_end(&g_progress_cond);
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
@@ -182,7 +290,7 @@ void WorkScheduler::stop()
 
 bool WorkScheduler::hasGPUDevices()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   return !g_gpudevices.empty();
 #  else
@@ -193,7 +301,7 @@ bool WorkScheduler::hasGPUDevices()
 #endif
 }
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 static void CL_CALLBACK clContextError(const char *errinfo,
                                        const void * /*private_info*/,
                                        size_t /*cb*/,
@@ -232,7 +340,21 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
     BLI_thread_local_create(g_thread_device);
     g_cpuInitialized = true;
   }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  /* The task scheduler manages its own threads, the arena limits how many of them execute
+   * compositor work. No slot is reserved for the calling thread, it only waits for progress. */
+  if (g_cpuarena && g_cpuarena->max_concurrency() != num_cpu_threads) {
+    delete g_cpuarena;
+    g_cpuarena = NULL;
+  }
+  if (!g_cpuarena) {
+    g_cpuarena = new tbb::task_arena(num_cpu_threads, 0);
+  }
+#else
+  UNUSED_VARS(num_cpu_threads);
+#endif
 
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   /* deinitialize OpenCL GPU's */
   if (use_opencl && !g_openclInitialized) {
@@ -340,7 +462,14 @@ void WorkScheduler::deinitialize()
     BLI_thread_local_delete(g_thread_device);
     g_cpuInitialized = false;
   }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  if (g_cpuarena) {
+    delete g_cpuarena;
+    g_cpuarena = NULL;
+  }
+#endif
 
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   /* deinitialize OpenCL GPU's */
   if (g_openclInitialized) {
@@ -368,6 +497,10 @@ void WorkScheduler::deinitialize()
 
 int WorkScheduler::current_thread_id()
 {
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  return BLI_task_parallel_thread_id(NULL);
+#else
   CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
   return device->thread_id();
+#endif
 }
@@ -20,6 +20,7 @@
 
 #include "COM_ExecutionGroup.h"
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "COM_Device.h"
@@ -42,7 +43,18 @@ class WorkScheduler {
    * inside this loop new work is queried and being executed
    */
   static void *thread_execute_cpu(void *data);
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  /**
+   * \brief task executing a single work package on the cpu
+   */
+  static void thread_execute_task(TaskPool *__restrict pool, void *data);
 
+  /**
+   * \brief push the work packages scheduled since the previous call to the task pool
+   */
+  static void push_scheduled_tasks();
+#endif
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   /**
    * \brief main thread loop for gpudevices
    * inside this loop new work is queried and being executed
@@ -101,6 +113,13 @@ class WorkScheduler {
    */
   static void finish();
 
+  /**
+   * \brief wait until a work package has been completed since the previous call.
+   * Returns immediately when all scheduled work is completed.
+   * \see ExecutionSystem.executeGroups
+   */
+  static void wait_for_progress();
+
   /**
    * \brief Are there OpenCL capable GPU devices initialized?
    * the result of this method is stored in the CompositorContext
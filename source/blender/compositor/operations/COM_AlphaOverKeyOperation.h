@@ -34,5 +34,8 @@ class AlphaOverKeyOperation : public MixBaseOperation {
   /**
    * the inner loop of this program
    */
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
@@ -37,7 +37,10 @@ class AlphaOverMixedOperation : public MixBaseOperation {
   /**
    * the inner loop of this program
    */
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 
   void setX(float x)
   {
@@ -19,9 +19,14 @@
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 #include "RE_pipeline.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
@@ -39,6 +44,39 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
   this->m_inputBoundingBoxReader = NULL;
 
   this->m_extend_bounds = false;
+
+  this->m_bokehKernel = NULL;
+  this->m_bokehKernelRadius = 0;
+}
+
+int BokehBlurOperation::getPixelSize() const
+{
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  return this->m_size * max_dim / 100.0f;
+}
+
+void BokehBlurOperation::updateBokehKernel()
+{
+  const int radius = getPixelSize();
+  if (this->m_bokehKernel || radius < 2 || radius > COM_BLUR_BOKEH_PIXELS) {
+    return;
+  }
+
+  const int kernel_size = radius * 2;
+  float *kernel = (float *)MEM_mallocN_aligned(
+      sizeof(float) * COM_NUM_CHANNELS_COLOR * kernel_size * kernel_size, 16, __func__);
+  const float m = this->m_bokehDimension / radius;
+  float *kernel_pixel = kernel;
+  for (int dy = -radius; dy < radius; dy++) {
+    for (int dx = -radius; dx < radius; dx++) {
+      const float u = this->m_bokehMidX - dx * m;
+      const float v = this->m_bokehMidY - dy * m;
+      this->m_inputBokehProgram->readSampled(kernel_pixel, u, v, COM_PS_NEAREST);
+      kernel_pixel += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+  this->m_bokehKernelRadius = radius;
+  this->m_bokehKernel = kernel;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -47,6 +85,7 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
   if (!this->m_sizeavailable) {
     updateSize();
   }
+  updateBokehKernel();
   void *buffer = getInputOperation(0)->initializeTileData(NULL);
   unlockMutex();
   return buffer;
@@ -84,8 +123,7 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
     int bufferwidth = inputBuffer->getWidth();
     int bufferstartx = inputBuffer->getRect()->xmin;
     int bufferstarty = inputBuffer->getRect()->ymin;
-    const float max_dim = max(this->getWidth(), this->getHeight());
-    int pixelSize = this->m_size * max_dim / 100.0f;
+    int pixelSize = getPixelSize();
     zero_v4(color_accum);
 
     if (pixelSize < 2) {
@@ -107,17 +145,54 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
     int step = getStep();
     int offsetadd = getOffsetAdd() * COM_NUM_CHANNELS_COLOR;
 
-    float m = this->m_bokehDimension / pixelSize;
-    for (int ny = miny; ny < maxy; ny += step) {
-      int bufferindex = ((minx - bufferstartx) * COM_NUM_CHANNELS_COLOR) +
-                        ((ny - bufferstarty) * COM_NUM_CHANNELS_COLOR * bufferwidth);
-      for (int nx = minx; nx < maxx; nx += step) {
-        float u = this->m_bokehMidX - (nx - x) * m;
-        float v = this->m_bokehMidY - (ny - y) * m;
-        this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
-        madd_v4_v4v4(color_accum, bokeh, &buffer[bufferindex]);
-        add_v4_v4(multiplier_accum, bokeh);
-        bufferindex += offsetadd;
+    if (this->m_bokehKernel && this->m_bokehKernelRadius == pixelSize) {
+      const int kernel_size = pixelSize * 2;
+#ifdef __SSE2__
+      __m128 color_accum_r = _mm_setzero_ps();
+      __m128 multiplier_accum_r = _mm_setzero_ps();
+#endif
+      for (int ny = miny; ny < maxy; ny += step) {
+        int bufferindex = ((minx - bufferstartx) * COM_NUM_CHANNELS_COLOR) +
+                          ((ny - bufferstarty) * COM_NUM_CHANNELS_COLOR * bufferwidth);
+        const float *kernel_row = &this->m_bokehKernel[(ny - y + pixelSize) * kernel_size *
+                                                       COM_NUM_CHANNELS_COLOR];
+        const int kernel_step = step * COM_NUM_CHANNELS_COLOR;
+        int kernel_index = (minx - x + pixelSize) * COM_NUM_CHANNELS_COLOR;
+        for (int nx = minx; nx < maxx; nx += step) {
+#ifdef __SSE2__
+          const __m128 bokeh_r = _mm_load_ps(&kernel_row[kernel_index]);
+          color_accum_r = _mm_add_ps(color_accum_r,
+                                     _mm_mul_ps(bokeh_r, _mm_load_ps(&buffer[bufferindex])));
+          multiplier_accum_r = _mm_add_ps(multiplier_accum_r, bokeh_r);
+#else
+          madd_v4_v4v4(color_accum, &kernel_row[kernel_index], &buffer[bufferindex]);
+          add_v4_v4(multiplier_accum, &kernel_row[kernel_index]);
+#endif
+          kernel_index += kernel_step;
+          bufferindex += offsetadd;
+        }
+      }
+#ifdef __SSE2__
+      float ATTR_ALIGN(16) color_sum[4], multiplier_sum[4];
+      _mm_store_ps(color_sum, color_accum_r);
+      _mm_store_ps(multiplier_sum, multiplier_accum_r);
+      add_v4_v4(color_accum, color_sum);
+      add_v4_v4(multiplier_accum, multiplier_sum);
+#endif
+    }
+    else {
+      float m = this->m_bokehDimension / pixelSize;
+      for (int ny = miny; ny < maxy; ny += step) {
+        int bufferindex = ((minx - bufferstartx) * COM_NUM_CHANNELS_COLOR) +
+                          ((ny - bufferstarty) * COM_NUM_CHANNELS_COLOR * bufferwidth);
+        for (int nx = minx; nx < maxx; nx += step) {
+          float u = this->m_bokehMidX - (nx - x) * m;
+          float v = this->m_bokehMidY - (ny - y) * m;
+          this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+          madd_v4_v4v4(color_accum, bokeh, &buffer[bufferindex]);
+          add_v4_v4(multiplier_accum, bokeh);
+          bufferindex += offsetadd;
+        }
       }
     }
     output[0] = color_accum[0] * (1.0f / multiplier_accum[0]);
@@ -133,6 +208,11 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
   deinitMutex();
+  if (this->m_bokehKernel) {
+    MEM_freeN(this->m_bokehKernel);
+    this->m_bokehKernel = NULL;
+    this->m_bokehKernelRadius = 0;
+  }
   this->m_inputProgram = NULL;
   this->m_inputBokehProgram = NULL;
   this->m_inputBoundingBoxReader = NULL;
@@ -34,6 +34,16 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   float m_bokehDimension;
   bool m_extend_bounds;
 
+  /**
+   * Bokeh sampled for every offset of the blur radius, so the inner loop doesn't need to sample
+   * the bokeh input. Only used when the radius is at most #COM_BLUR_BOKEH_PIXELS.
+   */
+  float *m_bokehKernel;
+  int m_bokehKernelRadius;
+
+  int getPixelSize() const;
+  void updateBokehKernel();
+
  public:
   BokehBlurOperation();
 
@@ -18,6 +18,7 @@
 
 #include <limits.h>
 
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "COM_FastGaussianBlurOperation.h"
 #include "MEM_guardedalloc.h"
@@ -110,40 +111,34 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
   return this->m_iirgaus;
 }
 
-void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
-                                          float sigma,
-                                          unsigned int chan,
-                                          unsigned int xy)
-{
-  double q, q2, sc, cf[4], tsM[9], tsu[3], tsv[3];
+/* Coefficients of the recursive filter, see "Recursive Gabor Filtering" by Young/VanVliet. */
+typedef struct IIRGaussCoefficients {
+  double cf[4];
+  /* Triggs/Sdika border corrections. */
+  double tsM[9];
+} IIRGaussCoefficients;
+
+typedef struct IIRGaussData {
+  const IIRGaussCoefficients *coefficients;
+  float *buffer;
+  unsigned int chan;
+  /** Number of elements in a line and offset between them. */
+  unsigned int line_length;
+  unsigned int line_stride;
+  /** Offset between the starts of two lines. */
+  unsigned int lines_stride;
+} IIRGaussData;
+
+/* Intermediate buffers of each thread. */
+typedef struct IIRGaussTLS {
   double *X, *Y, *W;
-  const unsigned int src_width = src->getWidth();
-  const unsigned int src_height = src->getHeight();
-  unsigned int x, y, sz;
-  unsigned int i;
-  float *buffer = src->getBuffer();
-  const unsigned int num_channels = src->get_num_channels();
+} IIRGaussTLS;
 
-  // <0.5 not valid, though can have a possibly useful sort of sharpening effect
-  if (sigma < 0.5f) {
-    return;
-  }
-
-  if ((xy < 1) || (xy > 3)) {
-    xy = 3;
-  }
-
-  // XXX The YVV macro defined below explicitly expects sources of at least 3x3 pixels,
-  //     so just skipping blur along faulty direction if src's def is below that limit!
-  if (src_width < 3) {
-    xy &= ~1;
-  }
-  if (src_height < 3) {
-    xy &= ~2;
-  }
-  if (xy < 1) {
-    return;
-  }
+static void IIR_gauss_coefficients(float sigma, IIRGaussCoefficients *r_coefficients)
+{
+  double q, q2, sc;
+  double *cf = r_coefficients->cf;
+  double *tsM = r_coefficients->tsM;
 
   // see "Recursive Gabor Filtering" by Young/VanVliet
   // all factors here in double.prec.
@@ -183,76 +178,143 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
   tsM[7] = sc * (cf[1] * cf[2] + cf[3] * cf[2] * cf[2] - cf[1] * cf[3] * cf[3] -
                  cf[3] * cf[3] * cf[3] - cf[3] * cf[2] + cf[3]);
   tsM[8] = sc * (cf[3] * (cf[1] + cf[3] * cf[2]));
+}
+
+/* Forward and backward pass of the filter over one line, expects at least 3 elements. */
+static void IIR_gauss_line(const IIRGaussCoefficients *coefficients,
+                           const double *X,
+                           double *Y,
+                           double *W,
+                           const unsigned int L)
+{
+  const double *cf = coefficients->cf;
+  const double *tsM = coefficients->tsM;
+  double tsu[3], tsv[3];
+  unsigned int i;
+
+  W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0];
+  W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0];
+  W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0];
+  for (i = 3; i < L; i++) {
+    W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3];
+  }
+  tsu[0] = W[L - 1] - X[L - 1];
+  tsu[1] = W[L - 2] - X[L - 1];
+  tsu[2] = W[L - 3] - X[L - 1];
+  tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1];
+  tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1];
+  tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1];
+  Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2];
+  Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1];
+  Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0];
+  /* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */
+  for (i = L - 4; i != UINT_MAX; i--) {
+    Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3];
+  }
+}
+
+static void IIR_gauss_line_task(void *__restrict userdata,
+                                const int line,
+                                const TaskParallelTLS *__restrict tls)
+{
+  const IIRGaussData *data = (const IIRGaussData *)userdata;
+  IIRGaussTLS *tls_data = (IIRGaussTLS *)tls->userdata_chunk;
+  const unsigned int L = data->line_length;
+
+  if (tls_data->X == NULL) {
+    tls_data->X = (double *)MEM_mallocN(sizeof(double) * L, "IIR_gauss X buf");
+    tls_data->Y = (double *)MEM_mallocN(sizeof(double) * L, "IIR_gauss Y buf");
+    tls_data->W = (double *)MEM_mallocN(sizeof(double) * L, "IIR_gauss W buf");
+  }
+  double *X = tls_data->X;
+
+  float *line_buffer = data->buffer + line * data->lines_stride + data->chan;
+  unsigned int offset = 0;
+  for (unsigned int i = 0; i < L; i++, offset += data->line_stride) {
+    X[i] = line_buffer[offset];
+  }
+  IIR_gauss_line(data->coefficients, X, tls_data->Y, tls_data->W, L);
+  offset = 0;
+  for (unsigned int i = 0; i < L; i++, offset += data->line_stride) {
+    line_buffer[offset] = tls_data->Y[i];
+  }
+}
+
+static void IIR_gauss_line_free(const void *__restrict /*userdata*/, void *__restrict chunk)
+{
+  IIRGaussTLS *tls_data = (IIRGaussTLS *)chunk;
+  if (tls_data->X) {
+    MEM_freeN(tls_data->X);
+    MEM_freeN(tls_data->Y);
+    MEM_freeN(tls_data->W);
+  }
+}
+
+/* Filter all lines of one direction, lines are independent so they are done in parallel. */
+static void IIR_gauss_lines(IIRGaussData *data, const unsigned int lines_num)
+{
+  IIRGaussTLS tls_data = {NULL, NULL, NULL};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 8;
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = IIR_gauss_line_free;
+  BLI_task_parallel_range(0, lines_num, data, IIR_gauss_line_task, &settings);
+}
+
+void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
+                                          float sigma,
+                                          unsigned int chan,
+                                          unsigned int xy)
+{
+  IIRGaussCoefficients coefficients;
+  const unsigned int src_width = src->getWidth();
+  const unsigned int src_height = src->getHeight();
+  float *buffer = src->getBuffer();
+  const unsigned int num_channels = src->get_num_channels();
+
+  // <0.5 not valid, though can have a possibly useful sort of sharpening effect
+  if (sigma < 0.5f) {
+    return;
+  }
+
+  if ((xy < 1) || (xy > 3)) {
+    xy = 3;
+  }
+
+  // XXX IIR_gauss_line explicitly expects sources of at least 3x3 pixels,
+  //     so just skipping blur along faulty direction if src's def is below that limit!
+  if (src_width < 3) {
+    xy &= ~1;
+  }
+  if (src_height < 3) {
+    xy &= ~2;
+  }
+  if (xy < 1) {
+    return;
+  }
+
+  IIR_gauss_coefficients(sigma, &coefficients);
+
+  IIRGaussData data;
+  data.coefficients = &coefficients;
+  data.buffer = buffer;
+  data.chan = chan;
 
-#define YVV(L) \
-  { \
-    W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0]; \
-    W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0]; \
-    W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0]; \
-    for (i = 3; i < L; i++) { \
-      W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3]; \
-    } \
-    tsu[0] = W[L - 1] - X[L - 1]; \
-    tsu[1] = W[L - 2] - X[L - 1]; \
-    tsu[2] = W[L - 3] - X[L - 1]; \
-    tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1]; \
-    tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1]; \
-    tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1]; \
-    Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2]; \
-    Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1]; \
-    Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0]; \
-    /* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */ \
-    for (i = L - 4; i != UINT_MAX; i--) { \
-      Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3]; \
-    } \
-  } \
-  (void)0
-
-  // intermediate buffers
-  sz = max(src_width, src_height);
-  X = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss X buf");
-  Y = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss Y buf");
-  W = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss W buf");
   if (xy & 1) {  // H
-    int offset;
-    for (y = 0; y < src_height; y++) {
-      const int yx = y * src_width;
-      offset = yx * num_channels + chan;
-      for (x = 0; x < src_width; x++) {
-        X[x] = buffer[offset];
-        offset += num_channels;
-      }
-      YVV(src_width);
-      offset = yx * num_channels + chan;
-      for (x = 0; x < src_width; x++) {
-        buffer[offset] = Y[x];
-        offset += num_channels;
-      }
-    }
+    data.line_length = src_width;
+    data.line_stride = num_channels;
+    data.lines_stride = src_width * num_channels;
+    IIR_gauss_lines(&data, src_height);
   }
   if (xy & 2) {  // V
-    int offset;
-    const int add = src_width * num_channels;
-
-    for (x = 0; x < src_width; x++) {
-      offset = x * num_channels + chan;
-      for (y = 0; y < src_height; y++) {
-        X[y] = buffer[offset];
-        offset += add;
-      }
-      YVV(src_height);
-      offset = x * num_channels + chan;
-      for (y = 0; y < src_height; y++) {
-        buffer[offset] = Y[y];
-        offset += add;
-      }
-    }
+    data.line_length = src_height;
+    data.line_stride = src_width * num_channels;
+    data.lines_stride = num_channels;
+    IIR_gauss_lines(&data, src_width);
   }
-
-  MEM_freeN(X);
-  MEM_freeN(W);
-  MEM_freeN(Y);
-#undef YVV
 }
 
 ///
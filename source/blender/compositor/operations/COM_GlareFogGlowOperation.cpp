@@ -17,6 +17,7 @@
  */
 
 #include "COM_GlareFogGlowOperation.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"
 
 /*
@@ -122,6 +123,59 @@ static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
     }
   }
 }
+//------------------------------------------------------------------------------
+
+typedef struct FHT2DData {
+  fREAL *data;
+  unsigned int Mx, Nx, Ny;
+  unsigned int inverse;
+} FHT2DData;
+
+static void FHT2D_row_task(void *__restrict userdata,
+                           const int j,
+                           const TaskParallelTLS *__restrict /*tls*/)
+{
+  const FHT2DData *fht = (const FHT2DData *)userdata;
+  FHT(&fht->data[fht->Nx * j], fht->Mx, fht->inverse);
+}
+
+/* Rows are independent, transform them in parallel. */
+static void FHT2D_rows(
+    fREAL *data, unsigned int Mx, unsigned int Nx, unsigned int rows, unsigned int inverse)
+{
+  FHT2DData fht = {data, Mx, Nx, rows, inverse};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  BLI_task_parallel_range(0, rows, &fht, FHT2D_row_task, &settings);
+}
+
+static void FHT2D_finalize_task(void *__restrict userdata,
+                                const int j,
+                                const TaskParallelTLS *__restrict /*tls*/)
+{
+  const FHT2DData *fht = (const FHT2DData *)userdata;
+  fREAL *data = fht->data;
+  const unsigned int Nx = fht->Nx, Ny = fht->Ny, Mx = fht->Mx;
+  /* Only touches rows j and Ny - j, so iterations don't overlap. */
+  unsigned int jm = (Ny - j) & (Ny - 1);
+  unsigned int ji = j << Mx;
+  unsigned int jmi = jm << Mx;
+  for (unsigned int i = 0; i <= (Nx >> 1); i++) {
+    unsigned int im = (Nx - i) & (Nx - 1);
+    fREAL A = data[ji + i];
+    fREAL B = data[jmi + i];
+    fREAL C = data[ji + im];
+    fREAL D = data[jmi + im];
+    fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+    data[ji + i] = A - E;
+    data[jmi + i] = B + E;
+    data[ji + im] = C + E;
+    data[jmi + im] = D - E;
+  }
+}
+
 //------------------------------------------------------------------------------
 /* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
  * nzp -> the row where zero pad data starts,
@@ -136,9 +190,7 @@ static void FHT2D(
 
   // rows (forward transform skips 0 pad data)
   maxy = inverse ? Ny : nzp;
-  for (j = 0; j < maxy; j++) {
-    FHT(&data[Nx * j], Mx, inverse);
-  }
+  FHT2D_rows(data, Mx, Nx, maxy, inverse);
 
   // transpose data
   if (Nx == Ny) {  // square
@@ -171,32 +223,51 @@ static void FHT2D(
   SWAP(unsigned int, Mx, My);
 
   // now columns == transposed rows
-  for (j = 0; j < Ny; j++) {
-    FHT(&data[Nx * j], Mx, inverse);
-  }
+  FHT2D_rows(data, Mx, Nx, Ny, inverse);
 
   // finalize
-  for (j = 0; j <= (Ny >> 1); j++) {
-    unsigned int jm = (Ny - j) & (Ny - 1);
-    unsigned int ji = j << Mx;
-    unsigned int jmi = jm << Mx;
-    for (i = 0; i <= (Nx >> 1); i++) {
-      unsigned int im = (Nx - i) & (Nx - 1);
-      fREAL A = data[ji + i];
-      fREAL B = data[jmi + i];
-      fREAL C = data[ji + im];
-      fREAL D = data[jmi + im];
-      fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
-      data[ji + i] = A - E;
-      data[jmi + i] = B + E;
-      data[ji + im] = C + E;
-      data[jmi + im] = D - E;
-    }
-  }
+  FHT2DData fht = {data, Mx, Nx, Ny, inverse};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  BLI_task_parallel_range(0, (Ny >> 1) + 1, &fht, FHT2D_finalize_task, &settings);
 }
 
 //------------------------------------------------------------------------------
 
+typedef struct FHTConvolveData {
+  fREAL *d1;
+  const fREAL *d2;
+  unsigned int M, N;
+} FHTConvolveData;
+
+static void fht_convolve_task(void *__restrict userdata,
+                              const int i,
+                              const TaskParallelTLS *__restrict /*tls*/)
+{
+  const FHTConvolveData *conv = (const FHTConvolveData *)userdata;
+  fREAL *d1 = conv->d1;
+  const fREAL *d2 = conv->d2;
+  const unsigned int M = conv->M;
+  const unsigned int m = 1 << M, n = 1 << conv->N;
+  const unsigned int n2 = 1 << (conv->N - 1);
+  /* Only touches columns i and m - i, so iterations don't overlap. */
+  const unsigned int k = m - i;
+  for (unsigned int j = 1; j < n2; j++) {
+    const unsigned int L = n - j;
+    const unsigned int mj = j << M;
+    const unsigned int mL = L << M;
+    fREAL a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+    fREAL b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+    d1[i + mj] = (b + a) * (fREAL)0.5;
+    d1[k + mL] = (b - a) * (fREAL)0.5;
+    a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+    b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+    d1[i + mL] = (b + a) * (fREAL)0.5;
+    d1[k + mj] = (b - a) * (fREAL)0.5;
+  }
+}
+
 /* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height */
 static void fht_convolve(fREAL *d1, const fREAL *d2, unsigned int M, unsigned int N)
 {
@@ -234,22 +305,12 @@ static void fht_convolve(fREAL *d1, const fREAL *d2, unsigned int M, unsigned in
     d1[m2 + mj] = (b + a) * (fREAL)0.5;
     d1[m2 + mL] = (b - a) * (fREAL)0.5;
   }
-  for (i = 1; i < m2; i++) {
-    k = m - i;
-    for (j = 1; j < n2; j++) {
-      L = n - j;
-      mj = j << M;
-      mL = L << M;
-      a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
-      b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
-      d1[i + mj] = (b + a) * (fREAL)0.5;
-      d1[k + mL] = (b - a) * (fREAL)0.5;
-      a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
-      b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
-      d1[i + mL] = (b + a) * (fREAL)0.5;
-      d1[k + mj] = (b - a) * (fREAL)0.5;
-    }
-  }
+
+  FHTConvolveData conv = {d1, d2, M, N};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  BLI_task_parallel_range(1, m2, &conv, fht_convolve_task, &settings);
 }
 //------------------------------------------------------------------------------
 
@@ -18,14 +18,70 @@
 
 #include "COM_GlareStreaksOperation.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+
+typedef struct StreakPassData {
+  MemoryBuffer *tsrc;
+  MemoryBuffer *tdst;
+  const GlareStreaksOperation *operation;
+  int n;
+  float vxp, vyp;
+  float wt;
+  /* Colormodulation amount relative to current pass. */
+  float cmo;
+} StreakPassData;
+
+static void streak_pass_row(void *__restrict userdata,
+                            const int y,
+                            const TaskParallelTLS *__restrict /*tls*/)
+{
+  const StreakPassData *data = (const StreakPassData *)userdata;
+  MemoryBuffer *tsrc = data->tsrc;
+  const int width = tsrc->getWidth();
+  const float vxp = data->vxp, vyp = data->vyp;
+  const float wt = data->wt, cmo = data->cmo;
+  float c1[4], c2[4], c3[4], c4[4];
+
+  if (data->operation->isBraked()) {
+    return;
+  }
+
+  float *tdstcol = &data->tdst->getBuffer()[y * width * COM_NUM_CHANNELS_COLOR];
+  for (int x = 0; x < width; x++, tdstcol += 4) {
+    // first pass no offset, always same for every pass, exact copy,
+    // otherwise results in uneven brightness, only need once
+    if (data->n == 0) {
+      tsrc->read(c1, x, y);
+    }
+    else {
+      c1[0] = c1[1] = c1[2] = 0;
+    }
+    tsrc->readBilinear(c2, x + vxp, y + vyp);
+    tsrc->readBilinear(c3, x + vxp * 2.0f, y + vyp * 2.0f);
+    tsrc->readBilinear(c4, x + vxp * 3.0f, y + vyp * 3.0f);
+    // modulate color to look vaguely similar to a color spectrum
+    c2[1] *= cmo;
+    c2[2] *= cmo;
+
+    c3[0] *= cmo;
+    c3[1] *= cmo;
+
+    c4[0] *= cmo;
+    c4[2] *= cmo;
+
+    tdstcol[0] = 0.5f * (tdstcol[0] + c1[0] + wt * (c2[0] + wt * (c3[0] + wt * c4[0])));
+    tdstcol[1] = 0.5f * (tdstcol[1] + c1[1] + wt * (c2[1] + wt * (c3[1] + wt * c4[1])));
+    tdstcol[2] = 0.5f * (tdstcol[2] + c1[2] + wt * (c2[2] + wt * (c3[2] + wt * c4[2])));
+    tdstcol[3] = 1.0f;
+  }
+}
 
 void GlareStreaksOperation::generateGlare(float *data,
                                           MemoryBuffer *inputTile,
                                           NodeGlare *settings)
 {
-  int x, y, n;
+  int n;
   unsigned int nump = 0;
-  float c1[4], c2[4], c3[4], c4[4];
   float a, ang = DEG2RADF(360.0f) / (float)settings->streaks;
 
   int size = inputTile->getWidth() * inputTile->getHeight();
@@ -38,49 +94,30 @@ void GlareStreaksOperation::generateGlare(float *data,
   tdst->clear();
   memset(data, 0, size4 * sizeof(float));
 
+  StreakPassData pass_data;
+  pass_data.tsrc = tsrc;
+  pass_data.tdst = tdst;
+  pass_data.operation = this;
+
+  /* Every pass only reads from tsrc and writes to its own pixel in tdst,
+   * so the rows of a pass are done in parallel. */
+  TaskParallelSettings task_settings;
+  BLI_parallel_range_settings_defaults(&task_settings);
+  task_settings.min_iter_per_thread = 8;
+
   for (a = 0.0f; a < DEG2RADF(360.0f) && (!breaked); a += ang) {
     const float an = a + settings->angle_ofs;
     const float vx = cos((double)an), vy = sin((double)an);
     for (n = 0; n < settings->iter && (!breaked); n++) {
       const float p4 = pow(4.0, (double)n);
-      const float vxp = vx * p4, vyp = vy * p4;
-      const float wt = pow((double)settings->fade, (double)p4);
-      const float cmo = 1.0f -
-                        (float)pow((double)settings->colmod,
-                                   (double)n +
-                                       1);  // colormodulation amount relative to current pass
-      float *tdstcol = tdst->getBuffer();
-      for (y = 0; y < tsrc->getHeight() && (!breaked); y++) {
-        for (x = 0; x < tsrc->getWidth(); x++, tdstcol += 4) {
-          // first pass no offset, always same for every pass, exact copy,
-          // otherwise results in uneven brightness, only need once
-          if (n == 0) {
-            tsrc->read(c1, x, y);
-          }
-          else {
-            c1[0] = c1[1] = c1[2] = 0;
-          }
-          tsrc->readBilinear(c2, x + vxp, y + vyp);
-          tsrc->readBilinear(c3, x + vxp * 2.0f, y + vyp * 2.0f);
-          tsrc->readBilinear(c4, x + vxp * 3.0f, y + vyp * 3.0f);
-          // modulate color to look vaguely similar to a color spectrum
-          c2[1] *= cmo;
-          c2[2] *= cmo;
-
-          c3[0] *= cmo;
-          c3[1] *= cmo;
-
-          c4[0] *= cmo;
-          c4[2] *= cmo;
-
-          tdstcol[0] = 0.5f * (tdstcol[0] + c1[0] + wt * (c2[0] + wt * (c3[0] + wt * c4[0])));
-          tdstcol[1] = 0.5f * (tdstcol[1] + c1[1] + wt * (c2[1] + wt * (c3[1] + wt * c4[1])));
-          tdstcol[2] = 0.5f * (tdstcol[2] + c1[2] + wt * (c2[2] + wt * (c3[2] + wt * c4[2])));
-          tdstcol[3] = 1.0f;
-        }
-        if (isBraked()) {
-          breaked = true;
-        }
+      pass_data.n = n;
+      pass_data.vxp = vx * p4;
+      pass_data.vyp = vy * p4;
+      pass_data.wt = pow((double)settings->fade, (double)p4);
+      pass_data.cmo = 1.0f - (float)pow((double)settings->colmod, (double)n + 1);
+      BLI_task_parallel_range(0, tsrc->getHeight(), &pass_data, streak_pass_row, &task_settings);
+      if (isBraked()) {
+        breaked = true;
       }
       memcpy(tsrc->getBuffer(), tdst->getBuffer(), sizeof(float) * size4);
     }
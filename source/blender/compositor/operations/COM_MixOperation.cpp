@@ -52,6 +52,29 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
   this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
   this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
 
+  executeMix(output, inputValue, inputColor1, inputColor2);
+}
+
+void MixBaseOperation::executeRow(float *output, int x, int y, int len)
+{
+  float inputColor1[COM_ROW_LENGTH * 4];
+  float inputColor2[COM_ROW_LENGTH * 4];
+  float inputValue[COM_ROW_LENGTH * 4];
+
+  this->m_inputValueOperation->readRow(inputValue, x, y, len);
+  this->m_inputColor1Operation->readRow(inputColor1, x, y, len);
+  this->m_inputColor2Operation->readRow(inputColor2, x, y, len);
+
+  for (int i = 0; i < len * 4; i += 4) {
+    executeMix(&output[i], &inputValue[i], &inputColor1[i], &inputColor2[i]);
+  }
+}
+
+void MixBaseOperation::executeMix(float output[4],
+                                  float inputValue[4],
+                                  float inputColor1[4],
+                                  float inputColor2[4])
+{
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -102,16 +125,11 @@ MixAddOperation::MixAddOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixAddOperation::executeMix(float output[4],
+                                 float inputValue[4],
+                                 float inputColor1[4],
+                                 float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -131,19 +149,13 @@ MixBlendOperation::MixBlendOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixBlendOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixBlendOperation::executeMix(float output[4],
+                                   float inputValue[4],
+                                   float inputColor1[4],
+                                   float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float value;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
   value = inputValue[0];
 
   if (this->useValueAlphaMultiply()) {
@@ -165,20 +177,13 @@ MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixColorBurnOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MixColorBurnOperation::executeMix(float output[4],
+                                       float inputValue[4],
+                                       float inputColor1[4],
+                                       float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float tmp;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -248,19 +253,11 @@ MixColorOperation::MixColorOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixColorOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixColorOperation::executeMix(float output[4],
+                                   float inputValue[4],
+                                   float inputColor1[4],
+                                   float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -293,19 +290,11 @@ MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDarkenOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixDarkenOperation::executeMix(float output[4],
+                                    float inputValue[4],
+                                    float inputColor1[4],
+                                    float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -326,19 +315,11 @@ MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDifferenceOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MixDifferenceOperation::executeMix(float output[4],
+                                        float inputValue[4],
+                                        float inputColor1[4],
+                                        float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -359,19 +340,11 @@ MixDivideOperation::MixDivideOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDivideOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixDivideOperation::executeMix(float output[4],
+                                    float inputValue[4],
+                                    float inputColor1[4],
+                                    float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -409,20 +382,13 @@ MixDodgeOperation::MixDodgeOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDodgeOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixDodgeOperation::executeMix(float output[4],
+                                   float inputValue[4],
+                                   float inputColor1[4],
+                                   float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float tmp;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -497,19 +463,13 @@ MixGlareOperation::MixGlareOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixGlareOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixGlareOperation::executeMix(float output[4],
+                                   float inputValue[4],
+                                   float inputColor1[4],
+                                   float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float value;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
   value = inputValue[0];
   float mf = 2.0f - 2.0f * fabsf(value - 0.5f);
 
@@ -538,16 +498,11 @@ MixHueOperation::MixHueOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixHueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixHueOperation::executeMix(float output[4],
+                                 float inputValue[4],
+                                 float inputColor1[4],
+                                 float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -580,19 +535,11 @@ MixLightenOperation::MixLightenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixLightenOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MixLightenOperation::executeMix(float output[4],
+                                     float inputValue[4],
+                                     float inputColor1[4],
+                                     float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -631,19 +578,11 @@ MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixLinearLightOperation::executePixelSampled(float output[4],
-                                                  float x,
-                                                  float y,
-                                                  PixelSampler sampler)
+void MixLinearLightOperation::executeMix(float output[4],
+                                         float inputValue[4],
+                                         float inputColor1[4],
+                                         float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -679,19 +618,11 @@ MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixMultiplyOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MixMultiplyOperation::executeMix(float output[4],
+                                      float inputValue[4],
+                                      float inputColor1[4],
+                                      float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -712,19 +643,11 @@ MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixOverlayOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MixOverlayOperation::executeMix(float output[4],
+                                     float inputValue[4],
+                                     float inputColor1[4],
+                                     float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -762,19 +685,11 @@ MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSaturationOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MixSaturationOperation::executeMix(float output[4],
+                                        float inputValue[4],
+                                        float inputColor1[4],
+                                        float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -804,19 +719,11 @@ MixScreenOperation::MixScreenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixScreenOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixScreenOperation::executeMix(float output[4],
+                                    float inputValue[4],
+                                    float inputColor1[4],
+                                    float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -838,19 +745,11 @@ MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSoftLightOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MixSoftLightOperation::executeMix(float output[4],
+                                       float inputValue[4],
+                                       float inputColor1[4],
+                                       float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -884,19 +783,11 @@ MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSubtractOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MixSubtractOperation::executeMix(float output[4],
+                                      float inputValue[4],
+                                      float inputColor1[4],
+                                      float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -916,19 +807,11 @@ MixValueOperation::MixValueOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixValueOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixValueOperation::executeMix(float output[4],
+                                   float inputValue[4],
+                                   float inputColor1[4],
+                                   float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -53,6 +53,16 @@ class MixBaseOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int len);
+
+  /**
+   * Blend a single pixel, shared by #executePixelSampled and #executeRow.
+   * The input colors may be modified in place.
+   */
+  virtual void executeMix(float output[4],
+                          float inputValue[4],
+                          float inputColor1[4],
+                          float inputColor2[4]);
 
   /**
    * Initialize the execution
@@ -83,113 +93,170 @@ class MixBaseOperation : public NodeOperation {
 class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
  public:
   MixColorBurnOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixColorOperation : public MixBaseOperation {
  public:
   MixColorOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixDivideOperation : public MixBaseOperation {
  public:
   MixDivideOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixDodgeOperation : public MixBaseOperation {
  public:
   MixDodgeOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixGlareOperation : public MixBaseOperation {
  public:
   MixGlareOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixHueOperation : public MixBaseOperation {
  public:
   MixHueOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
  public:
   MixLinearLightOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
  public:
   MixOverlayOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixSaturationOperation : public MixBaseOperation {
  public:
   MixSaturationOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
  public:
   MixSoftLightOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
 
 class MixValueOperation : public MixBaseOperation {
  public:
   MixValueOperation();
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeMix(float output[4],
+                  float inputValue[4],
+                  float inputColor1[4],
+                  float inputColor2[4]);
 };
@@ -74,6 +74,24 @@ void ReadBufferOperation::executePixelSampled(float output[4],
   }
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int len)
+{
+  if (m_single_value) {
+    /* write buffer has a single value stored at (0,0) */
+    float value[4];
+    const size_t value_size = sizeof(float) * m_buffer->get_num_channels();
+    m_buffer->read(value, 0, 0);
+    for (int i = 0; i < len; i++, output += 4) {
+      memcpy(output, value, value_size);
+    }
+  }
+  else {
+    for (int i = 0; i < len; i++, output += 4) {
+      m_buffer->read(output, x + i, y);
+    }
+  }
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4],
                                              float x,
                                              float y,
@@ -34,6 +34,15 @@ void SetVectorOperation::executePixelSampled(float output[4],
   output[2] = this->m_z;
 }
 
+void SetVectorOperation::executeRow(float *output, int /*x*/, int /*y*/, int len)
+{
+  for (int i = 0; i < len; i++, output += 4) {
+    output[0] = this->m_x;
+    output[1] = this->m_y;
+    output[2] = this->m_z;
+  }
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2],
                                              unsigned int preferredResolution[2])
 {
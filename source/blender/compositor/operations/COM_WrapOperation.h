@@ -30,6 +30,11 @@ class WrapOperation : public ReadBufferOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int len)
+  {
+    /* Wrapped coordinates, not a plain buffer read. */
+    NodeOperation::executeRow(output, x, y, len);
+  }
 
   void setWrapping(int wrapping_type);
   float getWrappedOriginalXPos(float x);
@@ -1896,9 +1896,32 @@ typedef struct PosNorLoop {
 
 typedef struct MeshExtract_PosNor_Data {
   PosNorLoop *vbo_data;
+  /**
+   * Only for #MR_EXTRACT_MESH: position, packed normal and paint mode flag per vertex,
+   * so loops only have to copy whole #PosNorLoop items.
+   */
+  PosNorLoop *vert_data;
   GPUPackedNormal packed_nor[];
 } MeshExtract_PosNor_Data;
 
+typedef struct ExtractPosNorVertData {
+  const MVert *mvert;
+  PosNorLoop *vert_data;
+} ExtractPosNorVertData;
+
+static void extract_pos_nor_vert_data_cb(void *__restrict userdata,
+                                         const int v,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ExtractPosNorVertData *data = userdata;
+  const MVert *mv = &data->mvert[v];
+  PosNorLoop *vert = &data->vert_data[v];
+  copy_v3_v3(vert->pos, mv->co);
+  vert->nor = GPU_normal_convert_i10_s3(mv->no);
+  /* Flag for paint mode overlay. */
+  vert->nor.w = (mv->flag & ME_HIDE) ? -1 : ((mv->flag & SELECT) ? 1 : 0);
+}
+
 static void *extract_pos_nor_init(const MeshRenderData *mr,
                                   struct MeshBatchCache *UNUSED(cache),
                                   void *buf)
@@ -1914,10 +1937,30 @@ static void *extract_pos_nor_init(const MeshRenderData *mr,
   GPU_vertbuf_init_with_format(vbo, &format);
   GPU_vertbuf_data_alloc(vbo, mr->loop_len + mr->loop_loose_len);
 
+  if (mr->extract_type == MR_EXTRACT_MESH) {
+    MeshExtract_PosNor_Data *data = MEM_mallocN(sizeof(*data), __func__);
+    data->vbo_data = (PosNorLoop *)vbo->data;
+    data->vert_data = MEM_mallocN(sizeof(*data->vert_data) * mr->vert_len, __func__);
+
+    /* Same heuristic as the extraction tasks, see #extract_task_create. */
+    const int chunk_size = 8192;
+    ExtractPosNorVertData vert_data = {
+        .mvert = mr->mvert,
+        .vert_data = data->vert_data,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = mr->vert_len > chunk_size;
+    settings.min_iter_per_thread = chunk_size;
+    BLI_task_parallel_range(0, mr->vert_len, &vert_data, extract_pos_nor_vert_data_cb, &settings);
+    return data;
+  }
+
   /* Pack normals per vert, reduce amount of computation. */
   size_t packed_nor_len = sizeof(GPUPackedNormal) * mr->vert_len;
   MeshExtract_PosNor_Data *data = MEM_mallocN(sizeof(*data) + packed_nor_len, __func__);
   data->vbo_data = (PosNorLoop *)vbo->data;
+  data->vert_data = NULL;
 
   /* Quicker than doing it for each loop. */
   if (mr->extract_type == MR_EXTRACT_BMESH) {
@@ -1953,11 +1996,39 @@ static void extract_pos_nor_iter_poly_bm(const MeshRenderData *mr,
   EXTRACT_POLY_AND_LOOP_FOREACH_BM_END(l);
 }
 
+/* Batch version of #extract_pos_nor_iter_poly_mesh, all per vertex data is already packed. */
+static void extract_pos_nor_iter_poly_mesh_batch(const MeshRenderData *mr,
+                                                 const ExtractPolyMesh_Params *params,
+                                                 MeshExtract_PosNor_Data *data)
+{
+  const PosNorLoop *vert_data = data->vert_data;
+  const MLoop *mloop = mr->mloop;
+  EXTRACT_POLY_FOREACH_MESH_BEGIN(mp, mp_index, params, mr)
+  {
+    PosNorLoop *vert = &data->vbo_data[mp->loopstart];
+    const MLoop *ml = &mloop[mp->loopstart];
+    const int totloop = mp->totloop;
+    for (int i = 0; i < totloop; i++) {
+      vert[i] = vert_data[ml[i].v];
+    }
+    if (mp->flag & ME_HIDE) {
+      for (int i = 0; i < totloop; i++) {
+        vert[i].nor.w = -1;
+      }
+    }
+  }
+  EXTRACT_POLY_FOREACH_MESH_END;
+}
+
 static void extract_pos_nor_iter_poly_mesh(const MeshRenderData *mr,
                                            const ExtractPolyMesh_Params *params,
                                            void *_data)
 {
   MeshExtract_PosNor_Data *data = _data;
+  if (data->vert_data) {
+    extract_pos_nor_iter_poly_mesh_batch(mr, params, data);
+    return;
+  }
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
     PosNorLoop *vert = &data->vbo_data[ml_index];
@@ -1980,6 +2051,18 @@ static void extract_pos_nor_iter_poly_mesh(const MeshRenderData *mr,
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_END;
 }
 
+/* Vertex normal without paint mode flag, for loose geometry. */
+BLI_INLINE GPUPackedNormal extract_pos_nor_vert_nor_get(const MeshExtract_PosNor_Data *data,
+                                                        const int v)
+{
+  if (data->vert_data) {
+    GPUPackedNormal nor = data->vert_data[v].nor;
+    nor.w = 0;
+    return nor;
+  }
+  return data->packed_nor[v];
+}
+
 static void extract_pos_nor_iter_ledge_bm(const MeshRenderData *mr,
                                           const ExtractLEdgeBMesh_Params *params,
                                           void *_data)
@@ -2008,8 +2091,8 @@ static void extract_pos_nor_iter_ledge_mesh(const MeshRenderData *mr,
     PosNorLoop *vert = &data->vbo_data[ml_index];
     copy_v3_v3(vert[0].pos, mr->mvert[med->v1].co);
     copy_v3_v3(vert[1].pos, mr->mvert[med->v2].co);
-    vert[0].nor = data->packed_nor[med->v1];
-    vert[1].nor = data->packed_nor[med->v2];
+    vert[0].nor = extract_pos_nor_vert_nor_get(data, med->v1);
+    vert[1].nor = extract_pos_nor_vert_nor_get(data, med->v2);
   }
   EXTRACT_LEDGE_FOREACH_MESH_END;
 }
@@ -2042,7 +2125,7 @@ static void extract_pos_nor_iter_lvert_mesh(const MeshRenderData *mr,
     const int v_index = mr->lverts[lvert_index];
     PosNorLoop *vert = &data->vbo_data[ml_index];
     copy_v3_v3(vert->pos, mv->co);
-    vert->nor = data->packed_nor[v_index];
+    vert->nor = extract_pos_nor_vert_nor_get(data, v_index);
   }
   EXTRACT_LVERT_FOREACH_MESH_END;
 }
@@ -2050,8 +2133,10 @@ static void extract_pos_nor_iter_lvert_mesh(const MeshRenderData *mr,
 static void extract_pos_nor_finish(const MeshRenderData *UNUSED(mr),
                                    struct MeshBatchCache *UNUSED(cache),
                                    void *UNUSED(vbo),
-                                   void *data)
+                                   void *_data)
 {
+  MeshExtract_PosNor_Data *data = _data;
+  MEM_SAFE_FREE(data->vert_data);
   MEM_freeN(data);
 }
 
@@ -2210,10 +2295,54 @@ static void extract_lnor_iter_poly_bm(const MeshRenderData *mr,
   }
 }
 
+/**
+ * Batch version of #extract_lnor_iter_poly_mesh, the flag is the same for all loops of a
+ * polygon and flat shaded polygons only have to pack their normal once.
+ */
+static void extract_lnor_iter_poly_mesh_batch(const MeshRenderData *mr,
+                                              const ExtractPolyMesh_Params *params,
+                                              GPUPackedNormal *lnor_data)
+{
+  const MLoop *mloop = mr->mloop;
+  const MVert *mvert = mr->mvert;
+  const float(*loop_normals)[3] = mr->loop_normals;
+  EXTRACT_POLY_FOREACH_MESH_BEGIN(mp, mp_index, params, mr)
+  {
+    const int ml_start = mp->loopstart;
+    const int ml_end = ml_start + mp->totloop;
+    /* Flag for paint mode overlay. */
+    const int w = (mp->flag & ME_HIDE) ? -1 : ((mp->flag & ME_FACE_SEL) ? 1 : 0);
+    if (loop_normals) {
+      for (int ml_index = ml_start; ml_index < ml_end; ml_index++) {
+        lnor_data[ml_index] = GPU_normal_convert_i10_v3(loop_normals[ml_index]);
+        lnor_data[ml_index].w = w;
+      }
+    }
+    else if (mp->flag & ME_SMOOTH) {
+      for (int ml_index = ml_start; ml_index < ml_end; ml_index++) {
+        lnor_data[ml_index] = GPU_normal_convert_i10_s3(mvert[mloop[ml_index].v].no);
+        lnor_data[ml_index].w = w;
+      }
+    }
+    else {
+      GPUPackedNormal nor = GPU_normal_convert_i10_v3(mr->poly_normals[mp_index]);
+      nor.w = w;
+      for (int ml_index = ml_start; ml_index < ml_end; ml_index++) {
+        lnor_data[ml_index] = nor;
+      }
+    }
+  }
+  EXTRACT_POLY_FOREACH_MESH_END;
+}
+
 static void extract_lnor_iter_poly_mesh(const MeshRenderData *mr,
                                         const ExtractPolyMesh_Params *params,
                                         void *data)
 {
+  if (mr->extract_type == MR_EXTRACT_MESH) {
+    extract_lnor_iter_poly_mesh_batch(mr, params, data);
+    return;
+  }
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
     GPUPackedNormal *lnor_data = &((GPUPackedNormal *)data)[ml_index];
@@ -2258,6 +2387,29 @@ static const MeshExtract extract_lnor = {
 /** \name Extract UV  layers
  * \{ */
 
+/* Number of loops copied by each task, copies are too cheap to be done in parallel per loop. */
+#define EXTRACT_UV_CHUNK_SIZE 8192
+
+typedef struct ExtractUVMeshData {
+  const MLoopUV *layer_data;
+  float (*uv_data)[2];
+  int loop_len;
+} ExtractUVMeshData;
+
+static void extract_uv_mesh_chunk_cb(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ExtractUVMeshData *data = userdata;
+  const int ml_start = chunk * EXTRACT_UV_CHUNK_SIZE;
+  const int ml_end = min_ii(ml_start + EXTRACT_UV_CHUNK_SIZE, data->loop_len);
+  const MLoopUV *layer_data = data->layer_data;
+  float(*uv_data)[2] = data->uv_data;
+  for (int ml_index = ml_start; ml_index < ml_end; ml_index++) {
+    copy_v2_v2(uv_data[ml_index], layer_data[ml_index].uv);
+  }
+}
+
 static void *extract_uv_init(const MeshRenderData *mr, struct MeshBatchCache *cache, void *buf)
 {
   GPUVertFormat format = {0};
@@ -2331,10 +2483,22 @@ static void *extract_uv_init(const MeshRenderData *mr, struct MeshBatchCache *ca
         }
       }
       else {
-        MLoopUV *layer_data = CustomData_get_layer_n(cd_ldata, CD_MLOOPUV, i);
-        for (int ml_index = 0; ml_index < mr->loop_len; ml_index++, uv_data++, layer_data++) {
-          memcpy(uv_data, layer_data->uv, sizeof(*uv_data));
-        }
+        ExtractUVMeshData uv_mesh_data = {
+            .layer_data = CustomData_get_layer_n(cd_ldata, CD_MLOOPUV, i),
+            .uv_data = uv_data,
+            .loop_len = mr->loop_len,
+        };
+        const int chunk_len = (mr->loop_len + EXTRACT_UV_CHUNK_SIZE - 1) / EXTRACT_UV_CHUNK_SIZE;
+        TaskParallelSettings settings;
+        BLI_parallel_range_settings_defaults(&settings);
+        settings.use_threading = chunk_len > 1;
+        settings.min_iter_per_thread = 1;
+        BLI_task_parallel_range(0,
+                                chunk_len,
+                                &uv_mesh_data,
+                                extract_uv_mesh_chunk_cb,
+                                &settings);
+        uv_data += mr->loop_len;
       }
     }
   }
@@ -5126,6 +5290,10 @@ static const MeshExtract extract_fdot_idx = {
  * \{ */
 typedef struct ExtractUserData {
   void *user_data;
+#ifdef DEBUG_TIME
+  /** CPU time spent in the extractor summed over all its tasks, in microseconds. */
+  uint64_t time_usec;
+#endif
 } ExtractUserData;
 
 typedef enum ExtractTaskDataType {
@@ -5271,10 +5439,60 @@ BLI_INLINE void mesh_extract_iter(const MeshRenderData *mr,
   }
 }
 
+#ifdef DEBUG_TIME
+/* Extractors for which the loops per second are reported. */
+static const char *extract_debug_name_get(const MeshExtract *extract)
+{
+  if (extract == &extract_pos_nor) {
+    return "pos_nor";
+  }
+  if (extract == &extract_lnor) {
+    return "lnor";
+  }
+  if (extract == &extract_lnor_hq) {
+    return "lnor_hq";
+  }
+  if (extract == &extract_uv) {
+    return "uv";
+  }
+  return NULL;
+}
+
+static void extract_debug_time_add(ExtractTaskData *data, const double start)
+{
+  const uint64_t time_usec = (uint64_t)((PIL_check_seconds_timer() - start) * 1e6);
+  atomic_add_and_fetch_uint64(&data->user_data->time_usec, time_usec);
+}
+
+static void extract_debug_time_print(ExtractTaskData *data)
+{
+  const char *name = extract_debug_name_get(data->extract);
+  const double time = (double)data->user_data->time_usec * 1e-6;
+  if (name == NULL || time <= 0.0) {
+    return;
+  }
+  const MeshRenderData *mr = data->mr;
+  printf("  extract %s (%s): %d loops in %.2fms, %.1fM loops/s\n",
+         name,
+         (mr->extract_type == MR_EXTRACT_BMESH) ?
+             "bmesh" :
+             ((mr->extract_type == MR_EXTRACT_MAPPED) ? "mapped" : "mesh"),
+         mr->loop_len,
+         time * 1000.0,
+         (double)mr->loop_len / time * 1e-6);
+}
+#endif
+
 static void extract_init(ExtractTaskData *data)
 {
   if (data->tasktype == EXTRACT_MESH_EXTRACT) {
+#ifdef DEBUG_TIME
+    const double start = PIL_check_seconds_timer();
+#endif
     data->user_data->user_data = data->extract->init(data->mr, data->cache, data->buf);
+#ifdef DEBUG_TIME
+    extract_debug_time_add(data, start);
+#endif
   }
 }
 
@@ -5282,18 +5500,29 @@ static void extract_run(void *__restrict taskdata)
 {
   ExtractTaskData *data = (ExtractTaskData *)taskdata;
   if (data->tasktype == EXTRACT_MESH_EXTRACT) {
+#ifdef DEBUG_TIME
+    const double start = PIL_check_seconds_timer();
+#endif
     mesh_extract_iter(data->mr,
                       data->iter_type,
                       data->start,
                       data->end,
                       data->extract,
                       data->user_data->user_data);
+#ifdef DEBUG_TIME
+    extract_debug_time_add(data, start);
+#endif
 
     /* If this is the last task, we do the finish function. */
     int remainin_tasks = atomic_sub_and_fetch_int32(data->task_counter, 1);
     if (remainin_tasks == 0 && data->extract->finish != NULL) {
       data->extract->finish(data->mr, data->cache, data->buf, data->user_data->user_data);
     }
+#ifdef DEBUG_TIME
+    if (remainin_tasks == 0) {
+      extract_debug_time_print(data);
+    }
+#endif
   }
   else if (data->tasktype == EXTRACT_LINES_LOOSE) {
     extract_lines_loose_subbuffer(data->mr, data->cache);
@@ -5773,8 +6002,12 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   avg_fps = avg_fps * 0.95 + (end - end_prev) * 0.05;
   avg_rdata = avg_rdata * 0.95 + (rdata_end - rdata_start) * 0.05;
 
-  printf(
-      "rdata %.0fms iter %.0fms (frame %.0fms)\n", avg_rdata * 1000, avg * 1000, avg_fps * 1000);
+  /* Buffers kept from a previous extraction (see #BKE_MESH_BATCH_DIRTY_DEFORM) are not counted. */
+  printf("rdata %.0fms iter %.0fms (frame %.0fms) buffers %d\n",
+         avg_rdata * 1000,
+         avg * 1000,
+         avg_fps * 1000,
+         counter_used);
 
   end_prev = end;
 #endif
@@ -626,6 +626,55 @@ static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
   cache->batch_ready &= ~MBC_EDITUV;
 }
 
+/**
+ * Only vertex positions changed, discard the buffers depending on them and keep the ones
+ * that only depend on topology, selection or custom-data, so they are not extracted again.
+ *
+ * \note Buffers using the triangulation are discarded too
+ * since the tessellation of n-gons depends on vertex positions.
+ */
+static void mesh_batch_cache_discard_deform(MeshBatchCache *cache)
+{
+  FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edge_fac);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.tan);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_area);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_angle);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.mesh_analysis);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_pos);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.skin_roots);
+    GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.tris);
+    GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.lines_adjacency);
+    GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.edituv_tris);
+  }
+  /* Nearly all batches use the positions, keep the UV editor ones that don't. */
+  GPUBatch *edituv_edges = cache->batch.edituv_edges;
+  GPUBatch *edituv_verts = cache->batch.edituv_verts;
+  GPUBatch *edituv_fdots = cache->batch.edituv_fdots;
+  GPUBatch *wire_loops_uvs = cache->batch.wire_loops_uvs;
+  cache->batch.edituv_edges = NULL;
+  cache->batch.edituv_verts = NULL;
+  cache->batch.edituv_fdots = NULL;
+  cache->batch.wire_loops_uvs = NULL;
+
+  for (int i = 0; i < sizeof(cache->batch) / sizeof(void *); i++) {
+    GPUBatch **batch = (GPUBatch **)&cache->batch;
+    GPU_BATCH_DISCARD_SAFE(batch[i]);
+  }
+  mesh_batch_cache_discard_surface_batches(cache);
+
+  cache->batch.edituv_edges = edituv_edges;
+  cache->batch.edituv_verts = edituv_verts;
+  cache->batch.edituv_fdots = edituv_fdots;
+  cache->batch.wire_loops_uvs = wire_loops_uvs;
+
+  cache->batch_ready &= (MBC_EDITUV_EDGES | MBC_EDITUV_VERTS | MBC_EDITUV_FACEDOTS |
+                         MBC_WIRE_LOOPS_UVS);
+}
+
 void DRW_mesh_batch_cache_dirty_tag(Mesh *me, int mode)
 {
   MeshBatchCache *cache = me->runtime.batch_cache;
@@ -671,6 +720,9 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, int mode)
     case BKE_MESH_BATCH_DIRTY_ALL:
       cache->is_dirty = true;
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      mesh_batch_cache_discard_deform(cache);
+      break;
     case BKE_MESH_BATCH_DIRTY_SHADING:
       mesh_batch_cache_discard_shaded_tri(cache);
       mesh_batch_cache_discard_uvedit(cache);
@@ -333,6 +333,9 @@ void EDBM_mesh_make(Object *ob, const int select_mode, const bool add_key_index)
 
   /* we need to flush selection because the mode may have changed from when last in editmode */
   EDBM_selectmode_flush(me->edit_mesh);
+
+  /* Evaluation converts the edit-mesh from multiple threads, it can't build the tables there. */
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 }
 
 /**
@@ -1445,6 +1448,8 @@ void EDBM_update_generic(Mesh *mesh, const bool do_tessellation, const bool is_d
     /* in debug mode double check we didn't need to recalculate */
     BLI_assert(BM_mesh_elem_table_check(em->bm) == true);
   }
+  /* Build the tables here rather than from evaluation threads converting the edit-mesh. */
+  BM_mesh_elem_table_ensure(em->bm, BM_VERT | BM_EDGE | BM_FACE);
   if (em->bm->spacearr_dirty & BM_SPACEARR_BMO_SET) {
     BM_lnorspace_invalidate(em->bm, false);
     em->bm->spacearr_dirty &= ~BM_SPACEARR_BMO_SET;
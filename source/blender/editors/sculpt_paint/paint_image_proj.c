@@ -35,6 +35,7 @@
 #endif
 
 #include "BLI_blenlib.h"
+#include "BLI_buffer.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_math_bits.h"
@@ -134,8 +135,13 @@ BLI_INLINE uchar f_to_char(const float val)
 //#define PROJ_DEBUG_PAINT 1
 //#define PROJ_DEBUG_NOSEAMBLEED 1
 //#define PROJ_DEBUG_PRINT_CLIP 1
+//#define PROJ_DEBUG_PRINT_TIME 1
 #define PROJ_DEBUG_WINCLIP 1
 
+#ifdef PROJ_DEBUG_PRINT_TIME
+#  include "PIL_time.h"
+#endif
+
 #ifndef PROJ_DEBUG_NOSEAMBLEED
 /* projectFaceSeamFlags options */
 //#define PROJ_FACE_IGNORE  (1<<0)  /* When the face is hidden, backfacing or occluded */
@@ -2012,7 +2018,7 @@ static ProjPixel *project_paint_uvpixel_init(const ProjPaintState *ps,
       sub_v2_v2v2(co, projPixel->projCoSS, ps->cloneOffset);
 
       /* no need to initialize the bucket, we're only checking buckets faces and for this
-       * the faces are already initialized in project_paint_delayed_face_init(...) */
+       * the faces are already initialized in project_paint_delayed_faces_init(...) */
       if (ibuf->rect_float) {
         if (!project_paint_PickColor(ps, co, ((ProjPixelClone *)projPixel)->clonepx.f, NULL, 1)) {
           /* zero alpha - ignore */
@@ -3558,7 +3564,7 @@ static void project_bucket_init(const ProjPaintState *ps,
  * will have its pixels calculated when it might not be needed later, (at the moment at least)
  * obviously it shouldn't have bugs though */
 
-static bool project_bucket_face_isect(ProjPaintState *ps,
+static bool project_bucket_face_isect(const ProjPaintState *ps,
                                       int bucket_x,
                                       int bucket_y,
                                       const MLoopTri *lt)
@@ -3612,10 +3618,29 @@ static bool project_bucket_face_isect(ProjPaintState *ps,
 /* Add faces to the bucket but don't initialize its pixels
  * TODO - when painting occluded, sort the faces on their min-Z
  * and only add faces that faces that are not occluded */
-static void project_paint_delayed_face_init(ProjPaintState *ps,
-                                            const MLoopTri *lt,
-                                            const int tri_index)
+/* Triangles are assigned to buckets in parallel blocks, the buckets are then linked in
+ * triangle order so their face lists don't depend on threading. */
+#define PROJ_FACE_INIT_BLOCK_SIZE 1024
+
+typedef struct ProjPaintBucketFace {
+  int bucket_index;
+  int tri_index;
+} ProjPaintBucketFace;
+
+typedef struct ProjPaintFaceInitData {
+  const ProjPaintState *ps;
+  const int *tri_indices;
+  int tri_indices_len;
+  /* #ProjPaintBucketFace for each block of #PROJ_FACE_INIT_BLOCK_SIZE triangles. */
+  BLI_Buffer *block_faces;
+} ProjPaintFaceInitData;
+
+/* Find the buckets a triangle intersects, appending #ProjPaintBucketFace to r_faces. */
+static void project_paint_face_buckets_find(const ProjPaintState *ps,
+                                            const int tri_index,
+                                            BLI_Buffer *r_faces)
 {
+  const MLoopTri *lt = &ps->mlooptri_eval[tri_index];
   const int lt_vtri[3] = {PS_LOOPTRI_AS_VERT_INDEX_3(ps, lt)};
   float min[2], max[2], *vCoSS;
   /* for ps->bucketRect indexing */
@@ -3623,8 +3648,6 @@ static void project_paint_delayed_face_init(ProjPaintState *ps,
   int fidx, bucket_x, bucket_y;
   /* for early loop exit */
   int has_x_isect = -1, has_isect = 0;
-  /* just use the first thread arena since threading has not started yet */
-  MemArena *arena = ps->arena_mt[0];
 
   INIT_MINMAX2(min, max);
 
@@ -3640,11 +3663,11 @@ static void project_paint_delayed_face_init(ProjPaintState *ps,
     has_x_isect = 0;
     for (bucket_x = bucketMin[0]; bucket_x < bucketMax[0]; bucket_x++) {
       if (project_bucket_face_isect(ps, bucket_x, bucket_y, lt)) {
-        int bucket_index = bucket_x + (bucket_y * ps->buckets_x);
-        BLI_linklist_prepend_arena(&ps->bucketFaces[bucket_index],
-                                   /* cast to a pointer to shut up the compiler */
-                                   POINTER_FROM_INT(tri_index),
-                                   arena);
+        const ProjPaintBucketFace bucket_face = {
+            .bucket_index = bucket_x + (bucket_y * ps->buckets_x),
+            .tri_index = tri_index,
+        };
+        BLI_buffer_append(r_faces, ProjPaintBucketFace, bucket_face);
 
         has_x_isect = has_isect = 1;
       }
@@ -3671,6 +3694,68 @@ static void project_paint_delayed_face_init(ProjPaintState *ps,
 #endif
 }
 
+static void project_paint_delayed_faces_init_cb(void *__restrict userdata,
+                                                const int block,
+                                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ProjPaintFaceInitData *data = userdata;
+  const int start = block * PROJ_FACE_INIT_BLOCK_SIZE;
+  const int end = min_ii(start + PROJ_FACE_INIT_BLOCK_SIZE, data->tri_indices_len);
+
+  for (int i = start; i < end; i++) {
+    project_paint_face_buckets_find(data->ps, data->tri_indices[i], &data->block_faces[block]);
+  }
+}
+
+/**
+ * Add the triangles to the face lists of the buckets they intersect,
+ * their pixels are initialized once a bucket is painted on.
+ */
+static void project_paint_delayed_faces_init(ProjPaintState *ps,
+                                             const int *tri_indices,
+                                             const int tri_indices_len)
+{
+  /* just use the first thread arena since threading has not started yet */
+  MemArena *arena = ps->arena_mt[0];
+  const int blocks_len = (tri_indices_len + PROJ_FACE_INIT_BLOCK_SIZE - 1) /
+                         PROJ_FACE_INIT_BLOCK_SIZE;
+
+  if (blocks_len == 0) {
+    return;
+  }
+
+  ProjPaintFaceInitData data = {
+      .ps = ps,
+      .tri_indices = tri_indices,
+      .tri_indices_len = tri_indices_len,
+      .block_faces = MEM_mallocN(sizeof(BLI_Buffer) * blocks_len, __func__),
+  };
+  for (int i = 0; i < blocks_len; i++) {
+    BLI_buffer_field_init(&data.block_faces[i], ProjPaintBucketFace);
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (blocks_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, blocks_len, &data, project_paint_delayed_faces_init_cb, &settings);
+
+  for (int i = 0; i < blocks_len; i++) {
+    BLI_Buffer *block_faces = &data.block_faces[i];
+    for (int j = 0; j < block_faces->count; j++) {
+      const ProjPaintBucketFace *bucket_face = &BLI_buffer_at(
+          block_faces, ProjPaintBucketFace, j);
+      BLI_linklist_prepend_arena(&ps->bucketFaces[bucket_face->bucket_index],
+                                 /* cast to a pointer to shut up the compiler */
+                                 POINTER_FROM_INT(bucket_face->tri_index),
+                                 arena);
+    }
+    BLI_buffer_field_free(block_faces);
+  }
+
+  MEM_freeN(data.block_faces);
+}
+
 static void proj_paint_state_viewport_init(ProjPaintState *ps, const char symmetry_flag)
 {
   float mat[3][3];
@@ -3783,54 +3868,95 @@ static void proj_paint_state_viewport_init(ProjPaintState *ps, const char symmet
   add_v3_v3(ps->viewPos, ps->obmat_imat[3]);
 }
 
-static void proj_paint_state_screen_coords_init(ProjPaintState *ps, const int diameter)
-{
-  const MVert *mv;
-  float *projScreenCo;
-  float projMargin;
-  int a;
+typedef struct ProjPaintScreenCoordsData {
+  const ProjPaintState *ps;
+  float (*screenCoords)[4];
+} ProjPaintScreenCoordsData;
 
-  INIT_MINMAX2(ps->screenMin, ps->screenMax);
+typedef struct ProjPaintScreenBounds {
+  float min[2], max[2];
+} ProjPaintScreenBounds;
 
-  ps->screenCoords = MEM_mallocN(sizeof(float) * ps->totvert_eval * 4, "ProjectPaint ScreenVerts");
-  projScreenCo = *ps->screenCoords;
+static void proj_paint_state_screen_coords_init_cb(void *__restrict userdata,
+                                                   const int a,
+                                                   const TaskParallelTLS *__restrict tls)
+{
+  ProjPaintScreenCoordsData *data = userdata;
+  const ProjPaintState *ps = data->ps;
+  ProjPaintScreenBounds *bounds = tls->userdata_chunk;
+  float *projScreenCo = data->screenCoords[a];
+  const MVert *mv = &ps->mvert_eval[a];
 
   if (ps->is_ortho) {
-    for (a = 0, mv = ps->mvert_eval; a < ps->totvert_eval; a++, mv++, projScreenCo += 4) {
-      mul_v3_m4v3(projScreenCo, ps->projectMat, mv->co);
+    mul_v3_m4v3(projScreenCo, ps->projectMat, mv->co);
 
-      /* screen space, not clamped */
-      projScreenCo[0] = (float)(ps->winx * 0.5f) + (ps->winx * 0.5f) * projScreenCo[0];
-      projScreenCo[1] = (float)(ps->winy * 0.5f) + (ps->winy * 0.5f) * projScreenCo[1];
-      minmax_v2v2_v2(ps->screenMin, ps->screenMax, projScreenCo);
-    }
+    /* screen space, not clamped */
+    projScreenCo[0] = (float)(ps->winx * 0.5f) + (ps->winx * 0.5f) * projScreenCo[0];
+    projScreenCo[1] = (float)(ps->winy * 0.5f) + (ps->winy * 0.5f) * projScreenCo[1];
+    minmax_v2v2_v2(bounds->min, bounds->max, projScreenCo);
   }
   else {
-    for (a = 0, mv = ps->mvert_eval; a < ps->totvert_eval; a++, mv++, projScreenCo += 4) {
-      copy_v3_v3(projScreenCo, mv->co);
-      projScreenCo[3] = 1.0f;
-
-      mul_m4_v4(ps->projectMat, projScreenCo);
-
-      if (projScreenCo[3] > ps->clip_start) {
-        /* screen space, not clamped */
-        projScreenCo[0] = (float)(ps->winx * 0.5f) +
-                          (ps->winx * 0.5f) * projScreenCo[0] / projScreenCo[3];
-        projScreenCo[1] = (float)(ps->winy * 0.5f) +
-                          (ps->winy * 0.5f) * projScreenCo[1] / projScreenCo[3];
-        /* Use the depth for bucket point occlusion */
-        projScreenCo[2] = projScreenCo[2] / projScreenCo[3];
-        minmax_v2v2_v2(ps->screenMin, ps->screenMax, projScreenCo);
-      }
-      else {
-        /* TODO - deal with cases where 1 side of a face goes behind the view ?
-         *
-         * After some research this is actually very tricky, only option is to
-         * clip the derived mesh before painting, which is a Pain */
-        projScreenCo[0] = FLT_MAX;
-      }
+    copy_v3_v3(projScreenCo, mv->co);
+    projScreenCo[3] = 1.0f;
+
+    mul_m4_v4(ps->projectMat, projScreenCo);
+
+    if (projScreenCo[3] > ps->clip_start) {
+      /* screen space, not clamped */
+      projScreenCo[0] = (float)(ps->winx * 0.5f) +
+                        (ps->winx * 0.5f) * projScreenCo[0] / projScreenCo[3];
+      projScreenCo[1] = (float)(ps->winy * 0.5f) +
+                        (ps->winy * 0.5f) * projScreenCo[1] / projScreenCo[3];
+      /* Use the depth for bucket point occlusion */
+      projScreenCo[2] = projScreenCo[2] / projScreenCo[3];
+      minmax_v2v2_v2(bounds->min, bounds->max, projScreenCo);
+    }
+    else {
+      /* TODO - deal with cases where 1 side of a face goes behind the view ?
+       *
+       * After some research this is actually very tricky, only option is to
+       * clip the derived mesh before painting, which is a Pain */
+      projScreenCo[0] = FLT_MAX;
     }
   }
+}
+
+static void proj_paint_state_screen_coords_init_reduce(const void *__restrict UNUSED(userdata),
+                                                       void *__restrict chunk_join,
+                                                       void *__restrict chunk)
+{
+  ProjPaintScreenBounds *join = chunk_join;
+  const ProjPaintScreenBounds *bounds = chunk;
+  for (int i = 0; i < 2; i++) {
+    join->min[i] = min_ff(join->min[i], bounds->min[i]);
+    join->max[i] = max_ff(join->max[i], bounds->max[i]);
+  }
+}
+
+static void proj_paint_state_screen_coords_init(ProjPaintState *ps, const int diameter)
+{
+  float projMargin;
+
+  ps->screenCoords = MEM_mallocN(sizeof(float) * ps->totvert_eval * 4, "ProjectPaint ScreenVerts");
+
+  ProjPaintScreenCoordsData data = {
+      .ps = ps,
+      .screenCoords = ps->screenCoords,
+  };
+  ProjPaintScreenBounds bounds;
+  INIT_MINMAX2(bounds.min, bounds.max);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (ps->totvert_eval > 10000);
+  settings.userdata_chunk = &bounds;
+  settings.userdata_chunk_size = sizeof(bounds);
+  settings.func_reduce = proj_paint_state_screen_coords_init_reduce;
+  BLI_task_parallel_range(
+      0, ps->totvert_eval, &data, proj_paint_state_screen_coords_init_cb, &settings);
+
+  copy_v2_v2(ps->screenMin, bounds.min);
+  copy_v2_v2(ps->screenMax, bounds.max);
 
   /* If this border is not added we get artifacts for faces that
    * have a parallel edge and at the bounds of the 2D projected verts eg
@@ -3946,40 +4072,49 @@ static void proj_paint_state_thread_init(ProjPaintState *ps, const bool reset_th
   }
 }
 
+static void proj_paint_state_vert_flags_init_cb(void *__restrict userdata,
+                                                const int a,
+                                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ProjPaintState *ps = userdata;
+  const MVert *mv = &ps->mvert_eval[a];
+  float viewDirPersp[3];
+  float no[3];
+
+  normal_short_to_float_v3(no, mv->no);
+  if (UNLIKELY(ps->is_flip_object)) {
+    negate_v3(no);
+  }
+
+  if (ps->is_ortho) {
+    if (dot_v3v3(ps->viewDir, no) <= ps->normal_angle__cos) {
+      /* 1 vert of this face is towards us */
+      ps->vertFlags[a] |= PROJ_VERT_CULL;
+    }
+  }
+  else {
+    sub_v3_v3v3(viewDirPersp, ps->viewPos, mv->co);
+    normalize_v3(viewDirPersp);
+    if (UNLIKELY(ps->is_flip_object)) {
+      negate_v3(viewDirPersp);
+    }
+    if (dot_v3v3(viewDirPersp, no) <= ps->normal_angle__cos) {
+      /* 1 vert of this face is towards us */
+      ps->vertFlags[a] |= PROJ_VERT_CULL;
+    }
+  }
+}
+
 static void proj_paint_state_vert_flags_init(ProjPaintState *ps)
 {
   if (ps->do_backfacecull && ps->do_mask_normal) {
-    float viewDirPersp[3];
-    const MVert *mv;
-    float no[3];
-    int a;
-
     ps->vertFlags = MEM_callocN(sizeof(char) * ps->totvert_eval, "paint-vertFlags");
 
-    for (a = 0, mv = ps->mvert_eval; a < ps->totvert_eval; a++, mv++) {
-      normal_short_to_float_v3(no, mv->no);
-      if (UNLIKELY(ps->is_flip_object)) {
-        negate_v3(no);
-      }
-
-      if (ps->is_ortho) {
-        if (dot_v3v3(ps->viewDir, no) <= ps->normal_angle__cos) {
-          /* 1 vert of this face is towards us */
-          ps->vertFlags[a] |= PROJ_VERT_CULL;
-        }
-      }
-      else {
-        sub_v3_v3v3(viewDirPersp, ps->viewPos, mv->co);
-        normalize_v3(viewDirPersp);
-        if (UNLIKELY(ps->is_flip_object)) {
-          negate_v3(viewDirPersp);
-        }
-        if (dot_v3v3(viewDirPersp, no) <= ps->normal_angle__cos) {
-          /* 1 vert of this face is towards us */
-          ps->vertFlags[a] |= PROJ_VERT_CULL;
-        }
-      }
-    }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (ps->totvert_eval > 10000);
+    BLI_task_parallel_range(
+        0, ps->totvert_eval, ps, proj_paint_state_vert_flags_init_cb, &settings);
   }
   else {
     ps->vertFlags = NULL;
@@ -4285,6 +4420,11 @@ static void project_paint_prepare_all_faces(ProjPaintState *ps,
   int image_index = -1, tri_index;
   int prev_poly = -1;
 
+  /* Triangles to add to the buckets once all are checked. */
+  int *face_init_tris = MEM_malloc_arrayN(
+      max_ii(ps->totlooptri_eval, 1), sizeof(int), "paint-face_init_tris");
+  int face_init_tris_len = 0;
+
   BLI_assert(ps->image_tot == 0);
 
   for (tri_index = 0, lt = ps->mlooptri_eval; tri_index < ps->totlooptri_eval; tri_index++, lt++) {
@@ -4425,11 +4565,14 @@ static void project_paint_prepare_all_faces(ProjPaintState *ps,
       if (image_index != -1) {
         /* Initialize the faces screen pixels */
         /* Add this to a list to initialize later */
-        project_paint_delayed_face_init(ps, lt, tri_index);
+        face_init_tris[face_init_tris_len++] = tri_index;
       }
     }
   }
 
+  project_paint_delayed_faces_init(ps, face_init_tris, face_init_tris_len);
+  MEM_freeN(face_init_tris);
+
   /* build an array of images we use*/
   if (ps->is_shared_user == false) {
     project_paint_build_proj_ima(ps, arena, &used_images);
@@ -5936,6 +6079,10 @@ void *paint_proj_new_stroke(bContext *C, Object *ob, const float mouse[2], int m
 
   /* allocate and initialize spatial data structures */
 
+#ifdef PROJ_DEBUG_PRINT_TIME
+  const double time_start = PIL_check_seconds_timer();
+#endif
+
   for (i = 0; i < ps_handle->ps_views_tot; i++) {
     ProjPaintState *ps = ps_handle->ps_views[i];
 
@@ -5956,6 +6103,12 @@ void *paint_proj_new_stroke(bContext *C, Object *ob, const float mouse[2], int m
     paint_proj_begin_clone(ps, mouse);
   }
 
+#ifdef PROJ_DEBUG_PRINT_TIME
+  printf("Projection paint stroke start: %d view(s) in %fs\n",
+         ps_handle->ps_views_tot,
+         PIL_check_seconds_timer() - time_start);
+#endif
+
   paint_brush_init_tex(ps_handle->brush);
 
   return ps_handle;
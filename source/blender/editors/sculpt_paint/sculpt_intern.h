@@ -544,6 +544,8 @@ typedef struct SculptUndoNode {
 
   char idname[MAX_ID_NAME]; /* name instead of pointer*/
   void *node;               /* only during push, not valid afterwards! */
+  /* Names are only unique per library, used to find the object back when the push ends. */
+  uint ob_session_uuid;
 
   float (*co)[3];
   float (*orig_co)[3];
@@ -563,6 +565,10 @@ typedef struct SculptUndoNode {
   int totgrid;  /* to restore into right location */
   int *grids;   /* to restore into right location */
   BLI_bitmap **grid_hidden;
+  /* When set, only these elements are stored (offsets into the node's grids, see
+   * #sculpt_undo_compact_nodes), otherwise all elements of all grids are. */
+  int *grid_elems;
+  int totgrid_elem;
 
   /* bmesh */
   struct BMLogEntry *bm_entry;
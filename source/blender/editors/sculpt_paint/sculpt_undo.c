@@ -45,6 +45,7 @@
 #include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_key.h"
+#include "BKE_lib_id.h"
 #include "BKE_main.h"
 #include "BKE_mesh.h"
 #include "BKE_multires.h"
@@ -280,11 +281,21 @@ static bool sculpt_undo_restore_coords(bContext *C, Depsgraph *depsgraph, Sculpt
     BKE_subdiv_ccg_key_top_level(&key, subdiv_ccg);
 
     co = unode->co;
-    for (int j = 0; j < unode->totgrid; j++) {
-      grid = grids[unode->grids[j]];
+    if (unode->grid_elems) {
+      const int grid_area = gridsize * gridsize;
+      for (int i = 0; i < unode->totgrid_elem; i++) {
+        const int offset = unode->grid_elems[i];
+        grid = grids[unode->grids[offset / grid_area]];
+        swap_v3_v3(CCG_elem_offset_co(&key, grid, offset % grid_area), co[i]);
+      }
+    }
+    else {
+      for (int j = 0; j < unode->totgrid; j++) {
+        grid = grids[unode->grids[j]];
 
-      for (int i = 0; i < gridsize * gridsize; i++, co++) {
-        swap_v3_v3(CCG_elem_offset_co(&key, grid, i), co[0]);
+        for (int i = 0; i < gridsize * gridsize; i++, co++) {
+          swap_v3_v3(CCG_elem_offset_co(&key, grid, i), co[0]);
+        }
       }
     }
   }
@@ -381,11 +392,21 @@ static bool sculpt_undo_restore_mask(bContext *C, SculptUndoNode *unode)
     BKE_subdiv_ccg_key_top_level(&key, subdiv_ccg);
 
     mask = unode->mask;
-    for (int j = 0; j < unode->totgrid; j++) {
-      grid = grids[unode->grids[j]];
+    if (unode->grid_elems) {
+      const int grid_area = gridsize * gridsize;
+      for (int i = 0; i < unode->totgrid_elem; i++) {
+        const int offset = unode->grid_elems[i];
+        grid = grids[unode->grids[offset / grid_area]];
+        SWAP(float, *CCG_elem_offset_mask(&key, grid, offset % grid_area), mask[i]);
+      }
+    }
+    else {
+      for (int j = 0; j < unode->totgrid; j++) {
+        grid = grids[unode->grids[j]];
 
-      for (int i = 0; i < gridsize * gridsize; i++, mask++) {
-        SWAP(float, *CCG_elem_offset_mask(&key, grid, i), *mask);
+        for (int i = 0; i < gridsize * gridsize; i++, mask++) {
+          SWAP(float, *CCG_elem_offset_mask(&key, grid, i), *mask);
+        }
       }
     }
   }
@@ -860,6 +881,12 @@ static void sculpt_undo_free_list(ListBase *lb)
     if (unode->mask) {
       MEM_freeN(unode->mask);
     }
+    if (unode->col) {
+      MEM_freeN(unode->col);
+    }
+    if (unode->grid_elems) {
+      MEM_freeN(unode->grid_elems);
+    }
 
     if (unode->bm_entry) {
       BM_log_entry_drop(unode->bm_entry);
@@ -952,6 +979,7 @@ static SculptUndoNode *sculpt_undo_alloc_node_type(Object *object, SculptUndoTyp
 {
   SculptUndoNode *unode = MEM_callocN(sizeof(SculptUndoNode), "SculptUndoNode");
   BLI_strncpy(unode->idname, object->id.name, sizeof(unode->idname));
+  unode->ob_session_uuid = object->id.session_uuid;
   unode->type = type;
 
   UndoSculpt *usculpt = sculpt_undo_get_nodes();
@@ -978,7 +1006,6 @@ static SculptUndoNode *sculpt_undo_find_or_alloc_node_type(Object *object, Sculp
 
 static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, SculptUndoType type)
 {
-  UndoSculpt *usculpt = sculpt_undo_get_nodes();
   SculptSession *ss = ob->sculpt;
   int totvert, allvert, totgrid, maxgrid, gridsize, *grids;
 
@@ -995,13 +1022,10 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
     maxgrid = 0;
   }
 
-  /* General TODO, fix count_alloc. */
   switch (type) {
     case SCULPT_UNDO_COORDS:
       unode->co = MEM_callocN(sizeof(float[3]) * allvert, "SculptUndoNode.co");
       unode->no = MEM_callocN(sizeof(short[3]) * allvert, "SculptUndoNode.no");
-
-      usculpt->undo_size = (sizeof(float[3]) + sizeof(short[3]) + sizeof(int)) * allvert;
       break;
     case SCULPT_UNDO_HIDDEN:
       if (maxgrid) {
@@ -1014,15 +1038,9 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
       break;
     case SCULPT_UNDO_MASK:
       unode->mask = MEM_callocN(sizeof(float) * allvert, "SculptUndoNode.mask");
-
-      usculpt->undo_size += (sizeof(float) * sizeof(int)) * allvert;
-
       break;
     case SCULPT_UNDO_COLOR:
       unode->col = MEM_callocN(sizeof(MPropCol) * allvert, "SculptUndoNode.col");
-
-      usculpt->undo_size += (sizeof(MPropCol) * sizeof(int)) * allvert;
-
       break;
     case SCULPT_UNDO_DYNTOPO_BEGIN:
     case SCULPT_UNDO_DYNTOPO_END:
@@ -1152,6 +1170,7 @@ static SculptUndoNode *sculpt_undo_face_sets_push(Object *ob, SculptUndoType typ
   unode = MEM_callocN(sizeof(*unode), __func__);
 
   BLI_strncpy(unode->idname, ob->id.name, sizeof(unode->idname));
+  unode->ob_session_uuid = ob->id.session_uuid;
   unode->type = type;
   unode->applied = true;
 
@@ -1181,6 +1200,7 @@ static SculptUndoNode *sculpt_undo_bmesh_push(Object *ob, PBVHNode *node, Sculpt
     unode = MEM_callocN(sizeof(*unode), __func__);
 
     BLI_strncpy(unode->idname, ob->id.name, sizeof(unode->idname));
+    unode->ob_session_uuid = ob->id.session_uuid;
     unode->type = type;
     unode->applied = true;
 
@@ -1340,6 +1360,259 @@ SculptUndoNode *SCULPT_undo_push_node(Object *ob, PBVHNode *node, SculptUndoType
   return unode;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compact Undo Nodes
+ *
+ * Nodes are pushed as soon as a brush overlaps them, so a stroke usually stores many more
+ * elements than it changes. Restoring swaps the stored and the current values, which makes
+ * elements that are still equal to the current state no-ops. Once a step is finished those
+ * are removed, leaving sparse index/value pairs for only the changed elements.
+ * \{ */
+
+static bool sculpt_undo_node_can_compact(const SculptSession *ss, const SculptUndoNode *unode)
+{
+  if (unode->node == NULL) {
+    return false;
+  }
+
+  if (unode->maxvert) {
+    if (ss->totvert != unode->maxvert || ss->mvert == NULL) {
+      return false;
+    }
+    switch (unode->type) {
+      case SCULPT_UNDO_COORDS:
+        /* Shape key and deformed coordinates are not restored into `ss->mvert`. */
+        return unode->orig_co == NULL && unode->shapeName[0] == '\0' &&
+               ss->shapekey_active == NULL && !ss->deform_modifiers_active;
+      case SCULPT_UNDO_MASK:
+        return ss->vmask != NULL;
+      case SCULPT_UNDO_COLOR:
+        return ss->vcol != NULL;
+      default:
+        return false;
+    }
+  }
+
+  if (unode->maxgrid) {
+    const SubdivCCG *subdiv_ccg = ss->subdiv_ccg;
+    if (subdiv_ccg == NULL || subdiv_ccg->num_grids != unode->maxgrid ||
+        subdiv_ccg->grid_size != unode->gridsize) {
+      return false;
+    }
+    switch (unode->type) {
+      case SCULPT_UNDO_COORDS:
+        return true;
+      case SCULPT_UNDO_MASK:
+        return subdiv_ccg->has_mask;
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+static void *sculpt_undo_array_shrink(void *array, const int len, const size_t elem_size)
+{
+  if (array == NULL) {
+    return NULL;
+  }
+  return MEM_reallocN(array, (size_t)max_ii(len, 1) * elem_size);
+}
+
+static void sculpt_undo_compact_mesh_node(const SculptSession *ss, SculptUndoNode *unode)
+{
+  int *index = unode->index;
+  int totvert = 0;
+
+  for (int i = 0; i < unode->totvert; i++) {
+    const int vert = index[i];
+    bool changed;
+    switch (unode->type) {
+      case SCULPT_UNDO_COORDS:
+        changed = memcmp(unode->co[i], ss->mvert[vert].co, sizeof(float[3])) != 0;
+        break;
+      case SCULPT_UNDO_MASK:
+        changed = memcmp(&unode->mask[i], &ss->vmask[vert], sizeof(float)) != 0;
+        break;
+      default:
+        changed = memcmp(unode->col[i], ss->vcol[vert].color, sizeof(float[4])) != 0;
+        break;
+    }
+    if (!changed) {
+      continue;
+    }
+
+    if (totvert != i) {
+      index[totvert] = vert;
+      if (unode->co) {
+        copy_v3_v3(unode->co[totvert], unode->co[i]);
+      }
+      if (unode->orig_co) {
+        copy_v3_v3(unode->orig_co[totvert], unode->orig_co[i]);
+      }
+      if (unode->mask) {
+        unode->mask[totvert] = unode->mask[i];
+      }
+      if (unode->col) {
+        copy_v4_v4(unode->col[totvert], unode->col[i]);
+      }
+    }
+    totvert++;
+  }
+
+  unode->totvert = totvert;
+  unode->index = sculpt_undo_array_shrink(unode->index, totvert, sizeof(*unode->index));
+  unode->co = sculpt_undo_array_shrink(unode->co, totvert, sizeof(*unode->co));
+  unode->orig_co = sculpt_undo_array_shrink(unode->orig_co, totvert, sizeof(*unode->orig_co));
+  unode->mask = sculpt_undo_array_shrink(unode->mask, totvert, sizeof(*unode->mask));
+  unode->col = sculpt_undo_array_shrink(unode->col, totvert, sizeof(*unode->col));
+}
+
+static void sculpt_undo_compact_grids_node(const SculptSession *ss, SculptUndoNode *unode)
+{
+  const SubdivCCG *subdiv_ccg = ss->subdiv_ccg;
+  CCGElem **grids = subdiv_ccg->grids;
+  const int grid_area = unode->gridsize * unode->gridsize;
+  CCGKey key;
+  int totelem = 0;
+
+  BKE_subdiv_ccg_key_top_level(&key, subdiv_ccg);
+
+  int *grid_elems = MEM_malloc_arrayN(
+      (size_t)max_ii(unode->totgrid * grid_area, 1), sizeof(int), "SculptUndoNode.grid_elems");
+
+  for (int j = 0, offset = 0; j < unode->totgrid; j++) {
+    CCGElem *grid = grids[unode->grids[j]];
+
+    for (int i = 0; i < grid_area; i++, offset++) {
+      if (unode->type == SCULPT_UNDO_COORDS) {
+        const float *co = CCG_elem_offset_co(&key, grid, i);
+        if (memcmp(unode->co[offset], co, sizeof(float[3])) == 0) {
+          continue;
+        }
+        copy_v3_v3(unode->co[totelem], unode->co[offset]);
+      }
+      else {
+        const float *mask = CCG_elem_offset_mask(&key, grid, i);
+        if (memcmp(&unode->mask[offset], mask, sizeof(float)) == 0) {
+          continue;
+        }
+        unode->mask[totelem] = unode->mask[offset];
+      }
+      grid_elems[totelem++] = offset;
+    }
+  }
+
+  unode->grid_elems = sculpt_undo_array_shrink(grid_elems, totelem, sizeof(*grid_elems));
+  unode->totgrid_elem = totelem;
+  unode->co = sculpt_undo_array_shrink(unode->co, totelem, sizeof(*unode->co));
+  unode->mask = sculpt_undo_array_shrink(unode->mask, totelem, sizeof(*unode->mask));
+}
+
+static size_t sculpt_undo_node_size(const SculptUndoNode *unode)
+{
+  const void *arrays[] = {
+      unode->co,
+      unode->orig_co,
+      unode->no,
+      unode->col,
+      unode->mask,
+      unode->index,
+      unode->vert_hidden,
+      unode->grids,
+      unode->grid_elems,
+      unode->face_sets,
+  };
+  size_t size = sizeof(*unode);
+  for (int i = 0; i < ARRAY_SIZE(arrays); i++) {
+    if (arrays[i]) {
+      size += MEM_allocN_len(arrays[i]);
+    }
+  }
+  if (unode->grid_hidden) {
+    for (int i = 0; i < unode->totgrid; i++) {
+      if (unode->grid_hidden[i]) {
+        size += MEM_allocN_len(unode->grid_hidden[i]);
+      }
+    }
+  }
+  return size;
+}
+
+typedef struct SculptUndoCompactData {
+  const SculptSession *ss;
+  SculptUndoNode **nodes;
+} SculptUndoCompactData;
+
+static void sculpt_undo_compact_node_cb(void *__restrict userdata,
+                                        const int n,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptUndoCompactData *data = userdata;
+  SculptUndoNode *unode = data->nodes[n];
+
+  if (unode->maxvert) {
+    sculpt_undo_compact_mesh_node(data->ss, unode);
+  }
+  else {
+    sculpt_undo_compact_grids_node(data->ss, unode);
+  }
+  unode->undo_size = sculpt_undo_node_size(unode);
+}
+
+/**
+ * Drop the elements of the undo nodes which were not changed by the finished operation,
+ * and update the memory used by the step.
+ */
+static void sculpt_undo_compact_nodes(UndoSculpt *usculpt)
+{
+  /* Nodes of a step always belong to the same object. Names are only unique per library,
+   * find it back from the session UUID. */
+  SculptUndoNode *unode_first = usculpt->nodes.first;
+  Object *ob = NULL;
+  if (unode_first) {
+    const uint ob_session_uuid = unode_first->ob_session_uuid;
+    ob = BLI_listbase_bytes_find(
+        &G_MAIN->objects, &ob_session_uuid, sizeof(ob_session_uuid), offsetof(ID, session_uuid));
+  }
+  const SculptSession *ss = ob ? ob->sculpt : NULL;
+
+  SculptUndoNode **nodes = MEM_malloc_arrayN(
+      max_ii(BLI_listbase_count(&usculpt->nodes), 1), sizeof(*nodes), __func__);
+  int totnode = 0;
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (ss && (unode->ob_session_uuid == ob->id.session_uuid) &&
+        sculpt_undo_node_can_compact(ss, unode)) {
+      nodes[totnode++] = unode;
+      /* The node no longer mirrors the PBVH node, it must not be found by later pushes. */
+      unode->node = NULL;
+    }
+    else {
+      unode->undo_size = sculpt_undo_node_size(unode);
+    }
+  }
+
+  SculptUndoCompactData data = {
+      .ss = ss,
+      .nodes = nodes,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, totnode, &data, sculpt_undo_compact_node_cb, &settings);
+
+  MEM_freeN(nodes);
+
+  usculpt->undo_size = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    usculpt->undo_size += unode->undo_size;
+  }
+}
+
+/** \} */
+
 void SCULPT_undo_push_begin(const char *name)
 {
   UndoStack *ustack = ED_undo_stack_get();
@@ -1371,6 +1644,8 @@ void SCULPT_undo_push_end_ex(const bool use_nested_undo)
   /* We could remove this and enforce all callers run in an operator using 'OPTYPE_UNDO'. */
   wmWindowManager *wm = G_MAIN->wm.first;
   if (wm->op_undo_depth == 0 || use_nested_undo) {
+    sculpt_undo_compact_nodes(usculpt);
+
     UndoStack *ustack = ED_undo_stack_get();
     BKE_undosys_step_push(ustack, NULL, NULL);
     if (wm->op_undo_depth == 0) {
@@ -677,6 +677,9 @@ void createTransEditVerts(TransInfo *t)
     struct TransIslandData island_data = {NULL};
     struct TransMirrorData mirror_data = {NULL};
 
+    /* The converted mesh may be from before the last edit, see #recalcData_mesh. */
+    BKE_editmesh_eval_cache_clear(em);
+
     /**
      * Quick check if we can transform.
      *
@@ -1579,11 +1582,23 @@ void recalcData_mesh(TransInfo *t)
     mesh_customdatacorrect_restore(t);
   }
 
+  /* Modes writing to custom-data (creases, weights, skin radius, custom normals, UV correction)
+   * need a full conversion for the modifier stack, others only move vertices. */
+  const bool is_coords_only = (t->data_type == TC_MESH_VERTS) &&
+                              !ELEM(t->mode, TFM_SKIN_RESIZE, TFM_NORMAL_ROTATION);
+
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
     DEG_id_tag_update(tc->obedit->data, 0); /* sets recalc flags */
     BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
     EDBM_mesh_normals_update(em);
     BKE_editmesh_looptri_calc(em);
+
+    if (is_coords_only && (tc->custom.type.data == NULL)) {
+      BKE_editmesh_eval_cache_tag_coords(em);
+    }
+    else {
+      BKE_editmesh_eval_cache_clear(em);
+    }
   }
 }
 /** \} */
@@ -1597,6 +1612,11 @@ void special_aftertrans_update__mesh(bContext *UNUSED(C), TransInfo *t)
   const bool is_cancelling = (t->state == TRANS_CANCEL);
   const bool use_automerge = !is_cancelling && (t->flag & (T_AUTOMERGE | T_AUTOSPLIT)) != 0;
 
+  /* Coordinate-only updates end with the transform. */
+  FOREACH_TRANS_DATA_CONTAINER (t, tc) {
+    BKE_editmesh_eval_cache_clear(BKE_editmesh_from_object(tc->obedit));
+  }
+
   if (!is_cancelling && ELEM(t->mode, TFM_EDGE_SLIDE, TFM_VERT_SLIDE)) {
     /* Handle multires re-projection, done
      * on transform completion since it's
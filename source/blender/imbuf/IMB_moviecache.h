@@ -43,6 +43,14 @@ typedef void *(*MovieCacheGetPriorityDataFP)(void *userkey);
 typedef int (*MovieCacheGetItemPriorityFP)(void *last_userkey, void *priority_data);
 typedef void (*MovieCachePriorityDeleterFP)(void *priority_data);
 
+typedef struct MovieCacheStatistics {
+  uint64_t hits, misses, puts;
+  /* Items which buffer was destroyed by the cache limiter. */
+  uint64_t destroyed;
+  /* Memory used by buffers currently in the cache, in bytes. */
+  size_t mem_in_use;
+} MovieCacheStatistics;
+
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
 
@@ -58,11 +66,16 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
 
 void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
+void IMB_moviecache_put_with_cost(struct MovieCache *cache,
+                                  void *userkey,
+                                  struct ImBuf *ibuf,
+                                  float cost);
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 struct ImBuf *IMB_moviecache_get(struct MovieCache *cache, void *userkey);
 void IMB_moviecache_remove(struct MovieCache *cache, void *userkey);
 bool IMB_moviecache_has_frame(struct MovieCache *cache, void *userkey);
 void IMB_moviecache_free(struct MovieCache *cache);
+void IMB_moviecache_get_statistics(struct MovieCache *cache, MovieCacheStatistics *r_stats);
 
 void IMB_moviecache_cleanup(struct MovieCache *cache,
                             bool(cleanup_check_cb)(struct ImBuf *ibuf,
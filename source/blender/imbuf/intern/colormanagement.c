@@ -45,6 +45,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
+#include "BLI_math_color_lut.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -135,6 +136,30 @@ static struct global_color_picking_state {
   bool failed;
 } global_color_picking_state = {NULL};
 
+/* Display transform baked into a 3D LUT, see #display_lut_acquire. */
+typedef struct ColormanageDisplayLUT {
+  struct ColormanageDisplayLUT *next, *prev;
+
+  /* Settings of the baked transform for comparison. */
+  bool is_float;
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  char input[MAX_COLORSPACE_NAME];
+  float exposure, gamma;
+  const CurveMapping *orig_curve_mapping;
+  int curve_mapping_timestamp;
+
+  /* Number of display buffer updates using the LUT, it's not freed while in use. */
+  int users;
+
+  ColorLUT3D *lut;
+} ColormanageDisplayLUT;
+
+/* Most recently used LUTs first. */
+static ListBase global_display_luts = {NULL, NULL};
+static ThreadMutex display_lut_lock = BLI_MUTEX_INITIALIZER;
+
 /*********************** Color managed cache *************************/
 
 /* Cache Implementation Notes
@@ -743,6 +768,13 @@ void colormanagement_exit(void)
     OCIO_processorRelease(global_color_picking_state.processor_from);
   }
 
+  LISTBASE_FOREACH_MUTABLE (ColormanageDisplayLUT *, display_lut, &global_display_luts) {
+    BLI_assert(display_lut->users == 0);
+    BLI_color_lut3d_free(display_lut->lut);
+    MEM_freeN(display_lut);
+  }
+  BLI_listbase_clear(&global_display_luts);
+
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
@@ -1459,10 +1491,252 @@ const float *IMB_colormangement_get_xyz_to_rgb()
   return &imbuf_xyz_to_rgb[0][0];
 }
 
+/*********************** Baked display transform routines *************************/
+
+/* The display transform of a byte buffer only depends on the 8 bit RGB values of its pixels,
+ * so for large buffers the whole transform chain (conversion to scene linear, curves, view
+ * transform, look, exposure and gamma) is baked into a 3D LUT which is much cheaper to apply
+ * per pixel. The LUT nodes are placed on byte values, so those are transformed exactly and
+ * the values between them are interpolated.
+ *
+ * Float buffers are baked the same way, using a log shaper to cover scene linear values. Pixels
+ * outside of the domain of the LUT (negative, very bright or NaN) go through the exact
+ * transform. The error against the exact transform stays below half a step of the display
+ * byte buffer, see the tests of #ColorLUT3D. */
+
+/* Nodes per axis, one every 5 byte values. */
+#define DISPLAY_LUT_BYTE_SIZE (255 / 5 + 1)
+/* Nodes per axis, 4 per stop. */
+#define DISPLAY_LUT_FLOAT_SIZE 65
+
+/* Smaller buffers are not worth baking a LUT for. */
+#define DISPLAY_LUT_MIN_PIXELS(size) (4 * (size) * (size) * (size))
+
+/* Maximum number of unused LUTs kept around. */
+#define DISPLAY_LUT_CACHE_LEN 4
+
+static bool display_lut_matches(const ColormanageDisplayLUT *display_lut,
+                                const ColorManagedViewSettings *view_settings,
+                                const ColorManagedDisplaySettings *display_settings,
+                                const char *from_colorspace,
+                                const bool is_float)
+{
+  const bool use_curve_mapping = (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) != 0;
+  const CurveMapping *curve_mapping = use_curve_mapping ? view_settings->curve_mapping : NULL;
+
+  return (display_lut->is_float == is_float && display_lut->exposure == view_settings->exposure &&
+          display_lut->gamma == view_settings->gamma &&
+          display_lut->orig_curve_mapping == curve_mapping &&
+          (curve_mapping == NULL ||
+           display_lut->curve_mapping_timestamp == curve_mapping->changed_timestamp) &&
+          STREQ(display_lut->look, view_settings->look) &&
+          STREQ(display_lut->view, view_settings->view_transform) &&
+          STREQ(display_lut->display, display_settings->display_device) &&
+          STREQ(display_lut->input, from_colorspace ? from_colorspace : ""));
+}
+
+/* Use the LUT cached for these settings, NULL if there is none. Must be called with the lock. */
+static ColormanageDisplayLUT *display_lut_find_and_use(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    const char *from_colorspace,
+    const bool is_float)
+{
+  LISTBASE_FOREACH (ColormanageDisplayLUT *, display_lut, &global_display_luts) {
+    if (display_lut_matches(
+            display_lut, view_settings, display_settings, from_colorspace, is_float)) {
+      display_lut->users++;
+      BLI_remlink(&global_display_luts, display_lut);
+      BLI_addhead(&global_display_luts, display_lut);
+      return display_lut;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Get the display transform of buffers in \a from_colorspace baked into a LUT, baking it with
+ * \a cm_processor if it's not cached yet. \a from_colorspace is NULL for float buffers in scene
+ * linear space. Must be released with #display_lut_release.
+ */
+static ColormanageDisplayLUT *display_lut_acquire(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    const char *from_colorspace,
+    const bool is_float,
+    ColormanageProcessor *cm_processor)
+{
+  ColormanageDisplayLUT *display_lut;
+
+  BLI_mutex_lock(&display_lut_lock);
+  display_lut = display_lut_find_and_use(
+      view_settings, display_settings, from_colorspace, is_float);
+  BLI_mutex_unlock(&display_lut_lock);
+
+  if (display_lut) {
+    return display_lut;
+  }
+
+  /* Bake without holding the lock, so threads displaying other images don't wait. Threads
+   * baking the same LUT at the same time keep the first one added to the cache. */
+  ColorLUT3D *lut = BLI_color_lut3d_new(is_float ? DISPLAY_LUT_FLOAT_SIZE : DISPLAY_LUT_BYTE_SIZE,
+                                        is_float);
+  const int lut_len = lut->size * lut->size * lut->size;
+  if (from_colorspace) {
+    IMB_colormanagement_transform(
+        &lut->table[0][0], lut_len, 1, 3, from_colorspace, global_role_scene_linear, false);
+  }
+  IMB_colormanagement_processor_apply(cm_processor, &lut->table[0][0], lut_len, 1, 3, false);
+
+  BLI_mutex_lock(&display_lut_lock);
+
+  display_lut = display_lut_find_and_use(
+      view_settings, display_settings, from_colorspace, is_float);
+  if (display_lut) {
+    BLI_mutex_unlock(&display_lut_lock);
+    BLI_color_lut3d_free(lut);
+    return display_lut;
+  }
+
+  display_lut = MEM_callocN(sizeof(*display_lut), __func__);
+  display_lut->is_float = is_float;
+  BLI_strncpy(display_lut->look, view_settings->look, MAX_COLORSPACE_NAME);
+  BLI_strncpy(display_lut->view, view_settings->view_transform, MAX_COLORSPACE_NAME);
+  BLI_strncpy(display_lut->display, display_settings->display_device, MAX_COLORSPACE_NAME);
+  BLI_strncpy(display_lut->input, from_colorspace ? from_colorspace : "", MAX_COLORSPACE_NAME);
+  display_lut->exposure = view_settings->exposure;
+  display_lut->gamma = view_settings->gamma;
+  if (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
+    display_lut->orig_curve_mapping = view_settings->curve_mapping;
+    display_lut->curve_mapping_timestamp = view_settings->curve_mapping->changed_timestamp;
+  }
+  display_lut->users = 1;
+  display_lut->lut = lut;
+  BLI_addhead(&global_display_luts, display_lut);
+
+  /* Free least recently used LUTs. */
+  int unused_len = 0;
+  LISTBASE_FOREACH_MUTABLE (ColormanageDisplayLUT *, display_lut_iter, &global_display_luts) {
+    if (display_lut_iter->users == 0 && ++unused_len > DISPLAY_LUT_CACHE_LEN) {
+      BLI_remlink(&global_display_luts, display_lut_iter);
+      BLI_color_lut3d_free(display_lut_iter->lut);
+      MEM_freeN(display_lut_iter);
+    }
+  }
+
+  BLI_mutex_unlock(&display_lut_lock);
+
+  return display_lut;
+}
+
+static void display_lut_release(ColormanageDisplayLUT *display_lut)
+{
+  BLI_mutex_lock(&display_lut_lock);
+  BLI_assert(display_lut->users > 0);
+  display_lut->users--;
+  BLI_mutex_unlock(&display_lut_lock);
+}
+
+/**
+ * Apply the baked display transform to \a pixels_len pixels of a byte buffer, writing
+ * display space float pixels with straight alpha.
+ */
+static void display_lut_apply_byte(const ColormanageDisplayLUT *display_lut,
+                                   const unsigned char *byte_buffer,
+                                   float *linear_buffer,
+                                   const size_t pixels_len)
+{
+  const unsigned char *cp = byte_buffer;
+  float *fp = linear_buffer;
+
+  for (size_t i = 0; i < pixels_len; i++, cp += 4, fp += 4) {
+    BLI_color_lut3d_apply_uchar3(display_lut->lut, cp, fp);
+    fp[3] = ((float)cp[3]) * (1.0f / 255.0f);
+  }
+}
+
+/**
+ * Apply the baked display transform to \a pixels_len pixels of a float buffer with
+ * premultiplied alpha, writing display space float pixels with premultiplied alpha.
+ * Pixels the LUT can't be used for get the exact transform, which is what
+ * #display_buffer_apply_get_linear_buffer and #IMB_colormanagement_processor_apply do.
+ */
+static void display_lut_apply_float(const ColormanageDisplayLUT *display_lut,
+                                    ColormanageProcessor *cm_processor,
+                                    const char *float_colorspace,
+                                    const bool predivide,
+                                    const float *buffer,
+                                    float *linear_buffer,
+                                    const size_t pixels_len)
+{
+  /* Curves are applied to premultiplied colors, the LUT was baked with straight colors. */
+  const bool use_lut_for_transparent = (predivide == false || cm_processor->curve_mapping == NULL);
+  size_t *exact_indices = NULL;
+  float(*exact_pixels)[4] = NULL;
+  size_t exact_len = 0;
+
+  const float *cp = buffer;
+  float *fp = linear_buffer;
+  for (size_t i = 0; i < pixels_len; i++, cp += 4, fp += 4) {
+    const float alpha = cp[3];
+    const bool is_transparent = predivide && alpha != 1.0f && alpha != 0.0f;
+    bool use_lut = false;
+
+    if (!is_transparent) {
+      use_lut = BLI_color_lut3d_apply_v3(display_lut->lut, cp, fp);
+    }
+    else if (use_lut_for_transparent) {
+      float straight[3];
+      mul_v3_v3fl(straight, cp, 1.0f / alpha);
+      use_lut = BLI_color_lut3d_apply_v3(display_lut->lut, straight, fp);
+      if (use_lut) {
+        mul_v3_fl(fp, alpha);
+      }
+    }
+
+    if (use_lut) {
+      fp[3] = alpha;
+    }
+    else {
+      if (exact_pixels == NULL) {
+        exact_indices = MEM_malloc_arrayN(pixels_len, sizeof(*exact_indices), __func__);
+        exact_pixels = MEM_malloc_arrayN(pixels_len, sizeof(*exact_pixels), __func__);
+      }
+      exact_indices[exact_len] = i;
+      copy_v4_v4(exact_pixels[exact_len], cp);
+      exact_len++;
+    }
+  }
+
+  if (exact_len == 0) {
+    return;
+  }
+
+  if (float_colorspace) {
+    IMB_colormanagement_transform(&exact_pixels[0][0],
+                                  (int)exact_len,
+                                  1,
+                                  4,
+                                  float_colorspace,
+                                  global_role_scene_linear,
+                                  predivide);
+  }
+  IMB_colormanagement_processor_apply(
+      cm_processor, &exact_pixels[0][0], (int)exact_len, 1, 4, predivide);
+
+  for (size_t i = 0; i < exact_len; i++) {
+    copy_v4_v4(linear_buffer + exact_indices[i] * 4, exact_pixels[i]);
+  }
+
+  MEM_freeN(exact_indices);
+  MEM_freeN(exact_pixels);
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
   ColormanageProcessor *cm_processor;
+  const ColormanageDisplayLUT *display_lut;
 
   const float *buffer;
   unsigned char *byte_buffer;
@@ -1486,6 +1760,7 @@ typedef struct DisplayBufferThread {
 typedef struct DisplayBufferInitData {
   ImBuf *ibuf;
   ColormanageProcessor *cm_processor;
+  const ColormanageDisplayLUT *display_lut;
   const float *buffer;
   unsigned char *byte_buffer;
 
@@ -1517,6 +1792,7 @@ static void display_buffer_init_handle(void *handle_v,
   memset(handle, 0, sizeof(DisplayBufferThread));
 
   handle->cm_processor = init_data->cm_processor;
+  handle->display_lut = init_data->display_lut;
 
   if (init_data->buffer) {
     handle->buffer = init_data->buffer + offset;
@@ -1669,7 +1945,24 @@ static void *do_display_buffer_apply_thread(void *handle_v)
     float *linear_buffer = MEM_mallocN(((size_t)channels) * width * height * sizeof(float),
                                        "color conversion linear buffer");
 
-    display_buffer_apply_get_linear_buffer(handle, height, linear_buffer, &is_straight_alpha);
+    if (handle->display_lut && handle->display_lut->is_float) {
+      display_lut_apply_float(handle->display_lut,
+                              cm_processor,
+                              handle->float_colorspace,
+                              handle->predivide,
+                              handle->buffer,
+                              linear_buffer,
+                              ((size_t)width) * height);
+      is_straight_alpha = false;
+    }
+    else if (handle->display_lut) {
+      display_lut_apply_byte(
+          handle->display_lut, handle->byte_buffer, linear_buffer, ((size_t)width) * height);
+      is_straight_alpha = true;
+    }
+    else {
+      display_buffer_apply_get_linear_buffer(handle, height, linear_buffer, &is_straight_alpha);
+    }
 
     bool predivide = handle->predivide && (is_straight_alpha == false);
 
@@ -1678,6 +1971,9 @@ static void *do_display_buffer_apply_thread(void *handle_v)
        * only generate byte buffers
        */
     }
+    else if (handle->display_lut) {
+      /* already in display space */
+    }
     else {
       /* apply processor */
       IMB_colormanagement_processor_apply(
@@ -1725,12 +2021,14 @@ static void display_buffer_apply_threaded(ImBuf *ibuf,
                                           unsigned char *byte_buffer,
                                           float *display_buffer,
                                           unsigned char *display_buffer_byte,
-                                          ColormanageProcessor *cm_processor)
+                                          ColormanageProcessor *cm_processor,
+                                          const ColormanageDisplayLUT *display_lut)
 {
   DisplayBufferInitData init_data;
 
   init_data.ibuf = ibuf;
   init_data.cm_processor = cm_processor;
+  init_data.display_lut = display_lut;
   init_data.buffer = buffer;
   init_data.byte_buffer = byte_buffer;
   init_data.display_buffer = display_buffer;
@@ -1791,6 +2089,7 @@ static void colormanage_display_buffer_process_ex(
     const ColorManagedDisplaySettings *display_settings)
 {
   ColormanageProcessor *cm_processor = NULL;
+  ColormanageDisplayLUT *display_lut = NULL;
   bool skip_transform = false;
 
   /* if we're going to transform byte buffer, check whether transformation would
@@ -1804,6 +2103,26 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+
+    /* Apply a baked transform to large buffers. */
+    const bool is_float = ibuf->rect_float != NULL;
+    const size_t min_pixels = is_float ? DISPLAY_LUT_MIN_PIXELS(DISPLAY_LUT_FLOAT_SIZE) :
+                                         DISPLAY_LUT_MIN_PIXELS(DISPLAY_LUT_BYTE_SIZE);
+    if ((is_float || ibuf->rect) && ibuf->channels == 4 && view_settings &&
+        ((size_t)ibuf->x) * ibuf->y >= min_pixels &&
+        (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA) == 0 &&
+        cm_processor->is_data_result == false) {
+      const char *from_colorspace;
+      if (is_float) {
+        from_colorspace = ibuf->float_colorspace ? ibuf->float_colorspace->name : NULL;
+      }
+      else {
+        from_colorspace = ibuf->rect_colorspace ? ibuf->rect_colorspace->name :
+                                                  global_role_default_byte;
+      }
+      display_lut = display_lut_acquire(
+          view_settings, display_settings, from_colorspace, is_float, cm_processor);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1811,7 +2130,12 @@ static void colormanage_display_buffer_process_ex(
                                 (unsigned char *)ibuf->rect,
                                 display_buffer,
                                 display_buffer_byte,
-                                cm_processor);
+                                cm_processor,
+                                display_lut);
+
+  if (display_lut) {
+    display_lut_release(display_lut);
+  }
 
   if (cm_processor) {
     IMB_colormanagement_processor_free(cm_processor);
@@ -29,6 +29,8 @@
 #include "BLI_ghash.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -708,6 +710,11 @@ typedef struct FFmpegIndexBuilderContext {
   double pts_time_base;
   int frameno, frameno_gapless;
   int start_pts_set;
+
+  /* Proxy sizes are scaled and encoded in parallel, while the next frame is decoded. */
+  TaskPool *proxy_pool;
+  /* Copy of the decoded frame being encoded, the decoder reuses its own buffers. */
+  AVFrame *proxy_frame;
 } FFmpegIndexBuilderContext;
 
 static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
@@ -774,6 +781,12 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
 
   context->iCodecCtx->workaround_bugs = 1;
 
+  /* Decoding is the only step which can't be split between proxy sizes, let the decoder use
+   * all threads. Only slice threading is used: frame threading delays decoder output by several
+   * packets, so decoded frames would no longer match the seek position they are indexed with. */
+  context->iCodecCtx->thread_count = BLI_system_thread_count();
+  context->iCodecCtx->thread_type = FF_THREAD_SLICE;
+
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
     MEM_freeN(context);
@@ -808,13 +821,62 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
     }
   }
 
+  context->proxy_pool = BLI_task_pool_create(context, TASK_PRIORITY_LOW);
+
   return (IndexBuildContext *)context;
 }
 
+static void index_rebuild_ffmpeg_proxy_task(TaskPool *__restrict pool, void *taskdata)
+{
+  FFmpegIndexBuilderContext *context = BLI_task_pool_user_data(pool);
+  struct proxy_output_ctx *proxy_ctx = taskdata;
+
+  add_to_proxy_output_ffmpeg(proxy_ctx, context->proxy_frame);
+}
+
+/* Wait for the previous frame to be written to all proxies. */
+static void index_rebuild_ffmpeg_proxies_wait(FFmpegIndexBuilderContext *context)
+{
+  if (context->proxy_frame) {
+    BLI_task_pool_work_and_wait(context->proxy_pool);
+    av_frame_free(&context->proxy_frame);
+  }
+}
+
+/* Start writing the frame to all proxies. Every proxy has its own scaler and encoder, so each
+ * of them is a separate task. Frames have to be written in order, so this waits for the previous
+ * frame first, which still lets decoding of the next frame overlap with encoding. */
+static void index_rebuild_ffmpeg_proxies_add(FFmpegIndexBuilderContext *context,
+                                             AVFrame *in_frame)
+{
+  int i;
+
+  index_rebuild_ffmpeg_proxies_wait(context);
+
+  if (context->proxy_sizes_in_use == 0) {
+    return;
+  }
+
+  context->proxy_frame = av_frame_clone(in_frame);
+  if (context->proxy_frame == NULL) {
+    return;
+  }
+
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      BLI_task_pool_push(
+          context->proxy_pool, index_rebuild_ffmpeg_proxy_task, context->proxy_ctx[i], false, NULL);
+    }
+  }
+}
+
 static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int stop)
 {
   int i;
 
+  index_rebuild_ffmpeg_proxies_wait(context);
+  BLI_task_pool_free(context->proxy_pool);
+
   for (i = 0; i < context->num_indexers; i++) {
     if (context->tcs_in_use & tc_types[i]) {
       IMB_index_builder_finish(context->indexer[i], stop);
@@ -842,9 +904,7 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   unsigned long long s_dts = context->seek_pos_dts;
   unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-  for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-  }
+  index_rebuild_ffmpeg_proxies_add(context, in_frame);
 
   if (!context->start_pts_set) {
     context->start_pts = pts;
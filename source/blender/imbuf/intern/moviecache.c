@@ -23,6 +23,7 @@
 
 #undef DEBUG_MESSAGES
 
+#include <limits.h>
 #include <memory.h>
 #include <stdlib.h> /* for qsort */
 
@@ -30,6 +31,8 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
+#include "BLI_linklist.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -40,6 +43,8 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "atomic_ops.h"
+
 #ifdef DEBUG_MESSAGES
 #  if defined __GNUC__
 #    define PRINT(format, args...) printf(format, ##args)
@@ -53,6 +58,21 @@
 static MEM_CacheLimiterC *limitor = NULL;
 static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Buffers destroyed by the cache limiter, they are freed once the lock is released so other
+ * threads accessing caches don't wait for large buffers to be freed. */
+static LinkNode *limitor_destroyed_ibufs = NULL;
+
+/* Incremented on every cache access, items without priority callback which were not accessed
+ * for the longest time are destroyed first. */
+static unsigned int limitor_access_stamp = 0;
+
+/* Rate at which items of unknown cost are assumed to be recreated, in bytes per second.
+ * Items which are recreated faster than this are destroyed earlier than their access order
+ * suggests, items which are slower to recreate are kept longer. */
+#define MOVIECACHE_NOMINAL_BYTES_PER_SECOND (256.0f * 1024.0f * 1024.0f)
+/* Limits how far the cost of an item can move it away from its access order. */
+#define MOVIECACHE_MAX_EVICT_WEIGHT 16.0f
+
 typedef struct MovieCache {
   char name[64];
 
@@ -74,7 +94,14 @@ typedef struct MovieCache {
   void *last_userkey;
 
   int totseg, *points, proxy, render_flags; /* for visual statistics optimization */
-  int pad;
+
+  /* Number of items which buffer was destroyed by the cache limiter and which are still in the
+   * hash, protected by the limitor lock. */
+  int totdestroyed;
+
+  /* Statistics, updated atomically. */
+  uint64_t tothit, totmiss, totput, totdestroyed_all;
+  size_t mem_in_use;
 } MovieCache;
 
 typedef struct MovieCacheKey {
@@ -87,6 +114,13 @@ typedef struct MovieCacheItem {
   ImBuf *ibuf;
   MEM_CacheLimiterHandleC *c_handle;
   void *priority_data;
+  /* Value of #limitor_access_stamp when the item was last put or accessed. */
+  unsigned int access_stamp;
+  /* Size of the buffer accounted in #MovieCache.mem_in_use. */
+  size_t size;
+  /* Multiplier of the (negative) priority, larger for items which are cheap to recreate
+   * compared to their size, so they are destroyed first. */
+  float evict_weight;
 } MovieCacheItem;
 
 static unsigned int moviecache_hashhash(const void *keyv)
@@ -123,6 +157,7 @@ static void moviecache_valfree(void *val)
   if (item->ibuf) {
     MEM_CacheLimiter_unmanage(item->c_handle);
     IMB_freeImBuf(item->ibuf);
+    atomic_sub_and_fetch_z(&cache->mem_in_use, item->size);
   }
 
   if (item->priority_data && cache->prioritydeleterfp) {
@@ -173,11 +208,15 @@ static void IMB_moviecache_destructor(void *p)
 
     PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-    IMB_freeImBuf(item->ibuf);
+    BLI_linklist_prepend(&limitor_destroyed_ibufs, item->ibuf);
 
     item->ibuf = NULL;
     item->c_handle = NULL;
 
+    cache->totdestroyed++;
+    atomic_add_and_fetch_uint64(&cache->totdestroyed_all, 1);
+    atomic_sub_and_fetch_z(&cache->mem_in_use, item->size);
+
     /* force cached segments to be updated */
     if (cache->points) {
       MEM_freeN(cache->points);
@@ -214,22 +253,39 @@ static int get_item_priority(void *item_v, int default_priority)
   int priority;
 
   if (!cache->getitempriorityfp) {
-    PRINT("%s: cache '%s' item %p use default priority %d\n",
-          __func__,
-          cache->name,
-          item,
-          default_priority);
-
-    return default_priority;
+    /* Least recently used items first, the default priority only depends on insertion order. */
+    const unsigned int age = limitor_access_stamp - item->access_stamp;
+    priority = -(int)MIN2(age, INT_MAX);
+    UNUSED_VARS(default_priority);
+  }
+  else {
+    priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
   }
 
-  priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
+  /* Only push items further away, a non-negative priority is used by callbacks to keep items
+   * which are needed right now. */
+  if (priority < 0) {
+    const double weighted = (double)priority * (double)item->evict_weight;
+    priority = (int)max_dd(weighted, (double)(INT_MIN + 1));
+  }
 
   PRINT("%s: cache '%s' item %p priority %d\n", __func__, cache->name, item, priority);
 
   return priority;
 }
 
+/* Cost is the time in seconds it took to create the buffer, zero when unknown. */
+static float get_item_evict_weight(size_t size, float cost)
+{
+  if (cost <= 0.0f || size == 0) {
+    return 1.0f;
+  }
+  const float bytes_per_second = (float)size / cost;
+  return clamp_f(bytes_per_second / MOVIECACHE_NOMINAL_BYTES_PER_SECOND,
+                 1.0f / MOVIECACHE_MAX_EVICT_WEIGHT,
+                 MOVIECACHE_MAX_EVICT_WEIGHT);
+}
+
 static bool get_item_destroyable(void *item_v)
 {
   MovieCacheItem *item = (MovieCacheItem *)item_v;
@@ -252,11 +308,25 @@ void IMB_moviecache_init(void)
   MEM_CacheLimiter_ItemDestroyable_Func_set(limitor, get_item_destroyable);
 }
 
+/* Take buffers destroyed by the cache limiter, must be called with the limitor lock held. */
+static LinkNode *moviecache_destroyed_ibufs_take(void)
+{
+  LinkNode *destroyed_ibufs = limitor_destroyed_ibufs;
+  limitor_destroyed_ibufs = NULL;
+  return destroyed_ibufs;
+}
+
+static void moviecache_destroyed_ibufs_free(LinkNode *destroyed_ibufs)
+{
+  BLI_linklist_free(destroyed_ibufs, (LinkNodeFreeFP)IMB_freeImBuf);
+}
+
 void IMB_moviecache_destruct(void)
 {
   if (limitor) {
     delete_MEM_CacheLimiter(limitor);
   }
+  moviecache_destroyed_ibufs_free(moviecache_destroyed_ibufs_take());
 }
 
 MovieCache *IMB_moviecache_create(const char *name,
@@ -303,10 +373,13 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
   cache->prioritydeleterfp = prioritydeleterfp;
 }
 
-static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
+static void do_moviecache_put(
+    MovieCache *cache, void *userkey, ImBuf *ibuf, float cost, bool need_lock)
 {
   MovieCacheKey *key;
   MovieCacheItem *item;
+  LinkNode *destroyed_ibufs = NULL;
+  bool has_destroyed_items;
 
   if (!limitor) {
     IMB_moviecache_init();
@@ -327,11 +400,15 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   item->cache_owner = cache;
   item->c_handle = NULL;
   item->priority_data = NULL;
+  item->access_stamp = 0;
+  item->size = get_size_in_memory(ibuf);
+  item->evict_weight = get_item_evict_weight(item->size, cost);
 
   if (cache->getprioritydatafp) {
     item->priority_data = cache->getprioritydatafp(userkey);
   }
 
+  atomic_add_and_fetch_z(&cache->mem_in_use, item->size);
   BLI_ghash_reinsert(cache->hash, key, item, moviecache_keyfree, moviecache_valfree);
 
   if (cache->last_userkey) {
@@ -343,17 +420,27 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   }
 
   item->c_handle = MEM_CacheLimiter_insert(limitor, item);
+  item->access_stamp = atomic_add_and_fetch_uint32(&limitor_access_stamp, 1);
+  atomic_add_and_fetch_uint64(&cache->totput, 1);
 
   MEM_CacheLimiter_ref(item->c_handle);
   MEM_CacheLimiter_enforce_limits(limitor);
   MEM_CacheLimiter_unref(item->c_handle);
 
+  has_destroyed_items = (cache->totdestroyed != 0);
+  cache->totdestroyed = 0;
+
   if (need_lock) {
+    destroyed_ibufs = moviecache_destroyed_ibufs_take();
     BLI_mutex_unlock(&limitor_lock);
   }
 
+  moviecache_destroyed_ibufs_free(destroyed_ibufs);
+
   /* cache limiter can't remove unused keys which points to destroyed values */
-  check_unused_keys(cache);
+  if (has_destroyed_items) {
+    check_unused_keys(cache);
+  }
 
   if (cache->points) {
     MEM_freeN(cache->points);
@@ -363,7 +450,14 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
 void IMB_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
-  do_moviecache_put(cache, userkey, ibuf, true);
+  do_moviecache_put(cache, userkey, ibuf, 0.0f, true);
+}
+
+/* Same as #IMB_moviecache_put, cost is the time in seconds it took to create the buffer.
+ * Buffers which are slow to recreate compared to their size are kept longer. */
+void IMB_moviecache_put_with_cost(MovieCache *cache, void *userkey, ImBuf *ibuf, float cost)
+{
+  do_moviecache_put(cache, userkey, ibuf, cost, true);
 }
 
 bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibuf)
@@ -378,12 +472,15 @@ bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibu
   mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
 
   if (mem_in_use + elem_size <= mem_limit) {
-    do_moviecache_put(cache, userkey, ibuf, false);
+    do_moviecache_put(cache, userkey, ibuf, 0.0f, false);
     result = true;
   }
 
+  LinkNode *destroyed_ibufs = moviecache_destroyed_ibufs_take();
   BLI_mutex_unlock(&limitor_lock);
 
+  moviecache_destroyed_ibufs_free(destroyed_ibufs);
+
   return result;
 }
 
@@ -400,23 +497,29 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
   MovieCacheKey key;
   MovieCacheItem *item;
 
+  ImBuf *ibuf = NULL;
+
   key.cache_owner = cache;
   key.userkey = userkey;
   item = (MovieCacheItem *)BLI_ghash_lookup(cache->hash, &key);
 
-  if (item) {
+  /* Misses don't lock: the buffer of an item is only cleared by the cache limiter, an item seen
+   * without buffer stays a miss. A buffer seen here is checked again while locked, the reference
+   * is added before unlocking so the buffer can't be destroyed by another thread in between.
+   * Touching the limiter is not needed, items are ordered by access stamp instead. */
+  if (item && item->ibuf) {
+    BLI_mutex_lock(&limitor_lock);
     if (item->ibuf) {
-      BLI_mutex_lock(&limitor_lock);
-      MEM_CacheLimiter_touch(item->c_handle);
-      BLI_mutex_unlock(&limitor_lock);
-
-      IMB_refImBuf(item->ibuf);
-
-      return item->ibuf;
+      ibuf = item->ibuf;
+      IMB_refImBuf(ibuf);
+      item->access_stamp = atomic_add_and_fetch_uint32(&limitor_access_stamp, 1);
     }
+    BLI_mutex_unlock(&limitor_lock);
   }
 
-  return NULL;
+  atomic_add_and_fetch_uint64(ibuf ? &cache->tothit : &cache->totmiss, 1);
+
+  return ibuf;
 }
 
 bool IMB_moviecache_has_frame(MovieCache *cache, void *userkey)
@@ -431,9 +534,24 @@ bool IMB_moviecache_has_frame(MovieCache *cache, void *userkey)
   return item != NULL;
 }
 
+void IMB_moviecache_get_statistics(MovieCache *cache, MovieCacheStatistics *r_stats)
+{
+  r_stats->hits = atomic_add_and_fetch_uint64(&cache->tothit, 0);
+  r_stats->misses = atomic_add_and_fetch_uint64(&cache->totmiss, 0);
+  r_stats->puts = atomic_add_and_fetch_uint64(&cache->totput, 0);
+  r_stats->destroyed = atomic_add_and_fetch_uint64(&cache->totdestroyed_all, 0);
+  r_stats->mem_in_use = atomic_add_and_fetch_z(&cache->mem_in_use, 0);
+}
+
 void IMB_moviecache_free(MovieCache *cache)
 {
-  PRINT("%s: cache '%s' free\n", __func__, cache->name);
+  PRINT("%s: cache '%s' free, %llu puts, %llu hits, %llu misses, %llu destroyed by limiter\n",
+        __func__,
+        cache->name,
+        (unsigned long long)cache->totput,
+        (unsigned long long)cache->tothit,
+        (unsigned long long)cache->totmiss,
+        (unsigned long long)cache->totdestroyed_all);
 
   BLI_ghash_free(cache->hash, moviecache_keyfree, moviecache_valfree);
 
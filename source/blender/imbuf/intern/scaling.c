@@ -24,6 +24,7 @@
 
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -906,643 +907,400 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
-{
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
+/* ******** separable scaling ******** */
 
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
+/* The scale-down and scale-up passes below work along one axis. The input pixels contributing
+ * to each output pixel only depend on the position along that axis, so they are computed once
+ * in a table, after which all rows (or all columns) are independent and can be processed in
+ * parallel. For the vertical passes whole rows are processed at once, so the inner loops run
+ * over contiguous memory and are easily vectorized by the compiler. */
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+/** Number of elements of a row processed at once by the vertical passes. */
+#define SCALE_ROW_BLOCK_LEN 256
 
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
+/** Minimum number of output pixels to scale with multiple threads. */
+#define SCALE_THREADED_MIN_LEN (64 * 1024)
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
+/**
+ * Input pixels averaged into an output pixel when scaling down: the pixel before \a start
+ * is subtracted with weight \a sample_prev (it was already partially used by the previous
+ * output pixel), the \a len pixels from \a start are added, then the next pixel is added with
+ * weight \a sample.
+ */
+typedef struct ScaleDownSample {
+  int start;
+  int len;
+  float sample_prev;
+  float sample;
+} ScaleDownSample;
+
+/** Input pixel interpolated with its next neighbor into an output pixel when scaling up. */
+typedef struct ScaleUpSample {
+  int index;
+  int index_next;
+  float sample;
+} ScaleUpSample;
+
+static ScaleDownSample *scaledown_table_create(const int len, const int newlen, const float add)
+{
+  ScaleDownSample *table = MEM_malloc_arrayN(newlen, sizeof(*table), __func__);
+  float sample = 0.0f;
+  int index = 0;
 
-  add = (ibuf->x - 0.01) / newx;
+  for (int i = 0; i < newlen; i++) {
+    ScaleDownSample *s = &table[i];
+    s->start = index;
+    s->sample_prev = sample;
 
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
+    sample += add;
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
+      index++;
+    }
+
+    s->len = index - s->start;
+    s->sample = sample;
+    index++;
+    sample -= 1.0f;
   }
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+  BLI_assert(index == len); /* see bug [#26502] */
+  UNUSED_VARS_NDEBUG(len);
+  return table;
+}
 
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+static ScaleUpSample *scaleup_table_create(const int len, const int newlen, const float add)
+{
+  ScaleUpSample *table = MEM_malloc_arrayN(newlen, sizeof(*table), __func__);
+  float sample = 0.0f;
+  int index = 0;
 
-      sample += add;
+  for (int i = 0; i < newlen; i++) {
+    ScaleUpSample *s = &table[i];
+    if (sample >= 1.0f) {
+      sample -= 1.0f;
+      index++;
+    }
+    s->index = min_ii(index, len - 1);
+    s->index_next = min_ii(index + 1, len - 1);
+    s->sample = sample;
+    sample += add;
+  }
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+  return table;
+}
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
+typedef struct ScaleData {
+  /** Source buffers, with \a x by \a y pixels. */
+  const uchar *rect;
+  const float *rectf;
+  int x, y;
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += 4;
-      }
-      if (do_float) {
+  /** Destination buffers, the scaled axis has \a newlen pixels. */
+  uchar *newrect;
+  float *newrectf;
+  int newlen;
 
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
+  const ScaleDownSample *down;
+  const ScaleUpSample *up;
+  float add;
+} ScaleData;
 
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+static void scale_settings_init(TaskParallelSettings *settings, const int newx, const int newy)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = ((size_t)newx * (size_t)newy >= SCALE_THREADED_MIN_LEN);
+}
 
-        newrectf += 4;
-      }
+static bool scale_buffers_alloc(ImBuf *ibuf, ScaleData *data, const int newx, const int newy)
+{
+  data->rect = (const uchar *)ibuf->rect;
+  data->rectf = ibuf->rect_float;
+  data->x = ibuf->x;
+  data->y = ibuf->y;
+  data->newrect = NULL;
+  data->newrectf = NULL;
 
-      sample -= 1.0f;
+  if (ibuf->rect) {
+    data->newrect = MEM_mallocN(sizeof(uchar[4]) * newx * newy, "scale byte");
+    if (data->newrect == NULL) {
+      return false;
     }
   }
+  if (ibuf->rect_float) {
+    data->newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scale float");
+    if (data->newrectf == NULL) {
+      MEM_SAFE_FREE(data->newrect);
+      return false;
+    }
+  }
+  return true;
+}
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
+static void scale_buffers_assign(ImBuf *ibuf, ScaleData *data)
+{
+  if (data->newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)data->newrect;
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
+  if (data->newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
+    ibuf->rect_float = data->newrectf;
   }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->x = newx;
-  return ibuf;
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+static void scaledownx_cb(void *__restrict userdata,
+                          const int y,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny");
-    if (_newrect == NULL) {
-      return ibuf;
+  const ScaleData *data = userdata;
+  const float add = data->add;
+
+  if (data->rect) {
+    const uchar *rect = data->rect + 4 * (size_t)y * data->x;
+    uchar *newrect = data->newrect + 4 * (size_t)y * data->newlen;
+    for (int i = 0; i < data->newlen; i++, newrect += 4) {
+      const ScaleDownSample *s = &data->down[i];
+      const uchar *p = rect + 4 * s->start;
+      for (int c = 0; c < 4; c++) {
+        float nval = (s->start != 0) ? -p[c - 4] * s->sample_prev : 0.0f;
+        for (int j = 0; j < s->len; j++) {
+          nval += p[4 * j + c];
+        }
+        newrect[c] = ((nval + s->sample * p[4 * s->len + c]) / add + 0.5f);
+      }
     }
   }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+  if (data->rectf) {
+    const float *rectf = data->rectf + 4 * (size_t)y * data->x;
+    float *newrectf = data->newrectf + 4 * (size_t)y * data->newlen;
+    for (int i = 0; i < data->newlen; i++, newrectf += 4) {
+      const ScaleDownSample *s = &data->down[i];
+      const float *p = rectf + 4 * s->start;
+      for (int c = 0; c < 4; c++) {
+        float nval = (s->start != 0) ? -p[c - 4] * s->sample_prev : 0.0f;
+        for (int j = 0; j < s->len; j++) {
+          nval += p[4 * j + c];
+        }
+        newrectf[c] = ((nval + s->sample * p[4 * s->len + c]) / add);
       }
-      return ibuf;
     }
   }
+}
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
+static void scaledowny_cb(void *__restrict userdata,
+                          const int y,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleData *data = userdata;
+  const ScaleDownSample *s = &data->down[y];
+  const float add = data->add;
+  const size_t row_len = 4 * (size_t)data->x;
+  float nval[SCALE_ROW_BLOCK_LEN];
+
+  for (size_t ofs = 0; ofs < row_len; ofs += SCALE_ROW_BLOCK_LEN) {
+    const int block_len = (int)min_zz(SCALE_ROW_BLOCK_LEN, row_len - ofs);
+
+    if (data->rect) {
+      const uchar *rect = data->rect + ofs + row_len * s->start;
+      uchar *newrect = data->newrect + ofs + row_len * y;
+      if (s->start != 0) {
+        const uchar *row = rect - row_len;
+        for (int i = 0; i < block_len; i++) {
+          nval[i] = -row[i] * s->sample_prev;
+        }
       }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
+      else {
+        memset(nval, 0, sizeof(*nval) * block_len);
       }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
+      for (int j = 0; j < s->len; j++) {
+        const uchar *row = rect + row_len * j;
+        for (int i = 0; i < block_len; i++) {
+          nval[i] += row[i];
         }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
+      }
+      const uchar *row = rect + row_len * s->len;
+      for (int i = 0; i < block_len; i++) {
+        newrect[i] = ((nval[i] + s->sample * row[i]) / add + 0.5f);
+      }
+    }
+    if (data->rectf) {
+      const float *rectf = data->rectf + ofs + row_len * s->start;
+      float *newrectf = data->newrectf + ofs + row_len * y;
+      if (s->start != 0) {
+        const float *row = rectf - row_len;
+        for (int i = 0; i < block_len; i++) {
+          nval[i] = -row[i] * s->sample_prev;
         }
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += skipx;
+      else {
+        memset(nval, 0, sizeof(*nval) * block_len);
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
+      for (int j = 0; j < s->len; j++) {
+        const float *row = rectf + row_len * j;
+        for (int i = 0; i < block_len; i++) {
+          nval[i] += row[i];
+        }
+      }
+      const float *row = rectf + row_len * s->len;
+      for (int i = 0; i < block_len; i++) {
+        newrectf[i] = ((nval[i] + s->sample * row[i]) / add);
       }
-
-      sample -= 1.0f;
     }
   }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+static void scaleupx_cb(void *__restrict userdata,
+                        const int y,
+                        const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
-  }
-
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return ibuf;
+  const ScaleData *data = userdata;
+
+  if (data->rect) {
+    const uchar *rect = data->rect + 4 * (size_t)y * data->x;
+    uchar *newrect = data->newrect + 4 * (size_t)y * data->newlen;
+    for (int i = 0; i < data->newlen; i++, newrect += 4) {
+      const ScaleUpSample *s = &data->up[i];
+      const uchar *p = rect + 4 * s->index;
+      const uchar *p_next = rect + 4 * s->index_next;
+      for (int c = 0; c < 4; c++) {
+        const float val = p[c];
+        const float diff = p_next[c] - val;
+        newrect[c] = (val + 0.5f) + s->sample * diff;
+      }
     }
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+  if (data->rectf) {
+    const float *rectf = data->rectf + 4 * (size_t)y * data->x;
+    float *newrectf = data->newrectf + 4 * (size_t)y * data->newlen;
+    for (int i = 0; i < data->newlen; i++, newrectf += 4) {
+      const ScaleUpSample *s = &data->up[i];
+      const float *p = rectf + 4 * s->index;
+      const float *p_next = rectf + 4 * s->index_next;
+      for (int c = 0; c < 4; c++) {
+        newrectf[c] = p[c] + s->sample * (p_next[c] - p[c]);
       }
-      return ibuf;
     }
   }
+}
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
-    }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 8;
+static void scaleupy_cb(void *__restrict userdata,
+                        const int y,
+                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleData *data = userdata;
+  const ScaleUpSample *s = &data->up[y];
+  const size_t row_len = 4 * (size_t)data->x;
+
+  if (data->rect) {
+    const uchar *row = data->rect + row_len * s->index;
+    const uchar *row_next = data->rect + row_len * s->index_next;
+    uchar *newrect = data->newrect + row_len * y;
+    for (size_t i = 0; i < row_len; i++) {
+      const float val = row[i];
+      const float diff = row_next[i] - val;
+      newrect[i] = (val + 0.5f) + s->sample * diff;
     }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
+  }
+  if (data->rectf) {
+    const float *row = data->rectf + row_len * s->index;
+    const float *row_next = data->rectf + row_len * s->index_next;
+    float *newrectf = data->newrectf + row_len * y;
+    for (size_t i = 0; i < row_len; i++) {
+      newrectf[i] = row[i] + s->sample * (row_next[i] - row[i]);
     }
   }
+}
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+  ScaleData data;
+  if (!scale_buffers_alloc(ibuf, &data, newx, ibuf->y)) {
+    return ibuf;
   }
 
+  data.newlen = newx;
+  data.add = (ibuf->x - 0.01) / newx;
+  data.down = scaledown_table_create(ibuf->x, newx, data.add);
+  data.up = NULL;
+
+  TaskParallelSettings settings;
+  scale_settings_init(&settings, newx, ibuf->y);
+  BLI_task_parallel_range(0, ibuf->y, &data, scaledownx_cb, &settings);
+
+  MEM_freeN((void *)data.down);
+  scale_buffers_assign(ibuf, &data);
+
   ibuf->x = newx;
   return ibuf;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+  ScaleData data;
+  if (!scale_buffers_alloc(ibuf, &data, ibuf->x, newy)) {
     return ibuf;
   }
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
+  data.newlen = newy;
+  data.add = (ibuf->y - 0.01) / newy;
+  data.down = scaledown_table_create(ibuf->y, newy, data.add);
+  data.up = NULL;
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  TaskParallelSettings settings;
+  scale_settings_init(&settings, ibuf->x, newy);
+  BLI_task_parallel_range(0, newy, &data, scaledowny_cb, &settings);
 
-  for (x = ibuf->x; x > 0; x--) {
+  MEM_freeN((void *)data.down);
+  scale_buffers_assign(ibuf, &data);
 
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
+  ibuf->y = newy;
+  return ibuf;
+}
 
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
+static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+{
+  ScaleData data;
+  if (!scale_buffers_alloc(ibuf, &data, newx, ibuf->y)) {
+    return ibuf;
+  }
 
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
+  data.newlen = newx;
+  data.add = (ibuf->x - 1.001) / (newx - 1.0);
+  data.up = scaleup_table_create(ibuf->x, newx, data.add);
+  data.down = NULL;
 
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
+  TaskParallelSettings settings;
+  scale_settings_init(&settings, newx, ibuf->y);
+  BLI_task_parallel_range(0, ibuf->y, &data, scaleupx_cb, &settings);
 
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
+  MEM_freeN((void *)data.up);
+  scale_buffers_assign(ibuf, &data);
 
-      rectf += 2 * skipx;
-    }
+  ibuf->x = newx;
+  return ibuf;
+}
 
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
+static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+{
+  ScaleData data;
+  if (!scale_buffers_alloc(ibuf, &data, ibuf->x, newy)) {
+    return ibuf;
   }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
+  data.newlen = newy;
+  data.add = (ibuf->y - 1.001) / (newy - 1.0);
+  data.up = scaleup_table_create(ibuf->y, newy, data.add);
+  data.down = NULL;
+
+  TaskParallelSettings settings;
+  scale_settings_init(&settings, ibuf->x, newy);
+  BLI_task_parallel_range(0, newy, &data, scaleupy_cb, &settings);
+
+  MEM_freeN((void *)data.up);
+  scale_buffers_assign(ibuf, &data);
 
   ibuf->y = newy;
   return ibuf;
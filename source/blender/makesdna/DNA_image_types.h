@@ -158,6 +158,10 @@ typedef struct Image {
 
   int lastused;
 
+  /** Not written in file, identifies the pixels, see #BKE_image_content_version. */
+  int content_version;
+  char _pad3[4];
+
   /* for generated images */
   int gen_x, gen_y;
   char gen_type, gen_flag;
@@ -121,7 +121,13 @@ typedef struct Object_Runtime {
   /** Did last modifier stack generation need mapping support? */
   char last_need_mapping;
 
-  char _pad0[3];
+  /**
+   * Set when the last evaluation only deformed the vertices of the previously evaluated mesh,
+   * its draw cache is then kept by the new evaluated mesh.
+   */
+  char is_data_eval_deform_update;
+
+  char _pad0[2];
 
   /** Only used for drawing the parent/child help-line. */
   float parent_display_origin[3];
@@ -6288,8 +6288,8 @@ static void rna_def_modifier_weld(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop,
       "Duplicate Limit",
-      "For a better performance, limits the number of elements found per vertex. "
-      "(0 makes it infinite)");
+      "For a better performance, limits the number of elements found per vertex, "
+      "the ones with the lowest indices are used. (0 makes it infinite)");
   RNA_def_property_update(prop, 0, "rna_Modifier_update");
 
   prop = RNA_def_property(srna, "vertex_group", PROP_STRING, PROP_NONE);
@@ -28,6 +28,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -159,12 +160,129 @@ static void svert_from_mvert(SortVertsElem *sv,
   }
 }
 
+/**
+ * Search the sorted target verts, starting at \a i_target_low_bound,
+ * for the closest double of \a sve_source within \a dist.
+ * Returns the index of the (possibly already remapped) target vertex, or -1 if none found.
+ */
+static int svert_find_double(const SortVertsElem *sve_source,
+                             const SortVertsElem *sorted_verts_target,
+                             const int target_num_verts,
+                             const int i_target_low_bound,
+                             const int *doubles_map,
+                             const MVert *mverts,
+                             const float dist,
+                             const float dist3)
+{
+  int best_target_vertex = -1;
+  float best_dist_sq = dist * dist;
+  const float sve_source_sumco = sve_source->sum_co;
+
+  /* Test target candidates starting at the low bound of possible doubles,
+   * ordered in terms of sumco. */
+  int i_target = i_target_low_bound;
+  const SortVertsElem *sve_target = sorted_verts_target + i_target_low_bound;
+
+  /* i_target will scan vertices in the
+   * [v_source_sumco - dist3;  v_source_sumco + dist3] range */
+
+  while ((i_target < target_num_verts) && (sve_target->sum_co <= sve_source_sumco + dist3)) {
+    /* Testing distance for candidate double in target */
+    /* v_target is within dist3 of v_source in terms of sumco;  check real distance */
+    float dist_sq;
+    if ((dist_sq = len_squared_v3v3(sve_source->co, sve_target->co)) <= best_dist_sq) {
+      /* Potential double found */
+      best_dist_sq = dist_sq;
+      best_target_vertex = sve_target->vertex_num;
+
+      /* If target is already mapped, we only follow that mapping if final target remains
+       * close enough from current vert (otherwise no mapping at all).
+       * Note that if we later find another target closer than this one, then we check it.
+       * But if other potential targets are farther,
+       * then there will be no mapping at all for this source. */
+      while (best_target_vertex != -1 &&
+             !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
+        if (compare_len_v3v3(mverts[sve_source->vertex_num].co,
+                             mverts[doubles_map[best_target_vertex]].co,
+                             dist)) {
+          best_target_vertex = doubles_map[best_target_vertex];
+        }
+        else {
+          best_target_vertex = -1;
+        }
+      }
+    }
+    i_target++;
+    sve_target++;
+  }
+
+  return best_target_vertex;
+}
+
+/**
+ * Binary search for the first target vertex whose sumco is not lower than \a sum_co,
+ * this gives the same low bound the serial scan reaches by advancing monotonically.
+ */
+static int svert_lower_bound(const SortVertsElem *sorted_verts, const int num_verts, float sum_co)
+{
+  int low = 0, high = num_verts;
+  while (low < high) {
+    const int mid = low + (high - low) / 2;
+    if (sorted_verts[mid].sum_co < sum_co) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+typedef struct MapDoublesData {
+  int *doubles_map;
+  const MVert *mverts;
+  const SortVertsElem *sorted_verts_target;
+  const SortVertsElem *sorted_verts_source;
+  int target_num_verts;
+  float dist;
+  float dist3;
+} MapDoublesData;
+
+static void dm_mvert_map_doubles_task(void *__restrict userdata,
+                                      const int i_source,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MapDoublesData *data = userdata;
+  const SortVertsElem *sve_source = &data->sorted_verts_source[i_source];
+
+  /* If source has already been assigned to a target (in an earlier call, with other chunks) */
+  if (data->doubles_map[sve_source->vertex_num] != -1) {
+    return;
+  }
+
+  const int i_target_low_bound = svert_lower_bound(
+      data->sorted_verts_target, data->target_num_verts, sve_source->sum_co - data->dist3);
+
+  data->doubles_map[sve_source->vertex_num] = svert_find_double(sve_source,
+                                                                data->sorted_verts_target,
+                                                                data->target_num_verts,
+                                                                i_target_low_bound,
+                                                                data->doubles_map,
+                                                                data->mverts,
+                                                                data->dist,
+                                                                data->dist3);
+}
+
 /**
  * Take as inputs two sets of verts, to be processed for detection of doubles and mapping.
  * Each set of verts is defined by its start within mverts array and its num_verts;
  * It builds a mapping for all vertices within source,
  * to vertices within target, or -1 if no double found.
  * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ *
+ * \param use_threading: Scan source vertices in parallel. Only valid when mapping chains
+ * starting in the target set can never reach back into the source set,
+ * which is the case when merging each chunk with the previous one.
  */
 static void dm_mvert_map_doubles(int *doubles_map,
                                  const MVert *mverts,
@@ -172,12 +290,13 @@ static void dm_mvert_map_doubles(int *doubles_map,
                                  const int target_num_verts,
                                  const int source_start,
                                  const int source_num_verts,
-                                 const float dist)
+                                 const float dist,
+                                 const bool use_threading)
 {
   const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist; /* Just above sqrt(3) */
-  int i_source, i_target, i_target_low_bound, target_end, source_end;
+  int i_source, i_target_low_bound, target_end, source_end;
   SortVertsElem *sorted_verts_target, *sorted_verts_source;
-  SortVertsElem *sve_source, *sve_target, *sve_target_low_bound;
+  SortVertsElem *sve_source, *sve_target_low_bound;
   bool target_scan_completed;
 
   target_end = target_start + target_num_verts;
@@ -197,6 +316,27 @@ static void dm_mvert_map_doubles(int *doubles_map,
   qsort(sorted_verts_target, target_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
   qsort(sorted_verts_source, source_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
 
+  if (use_threading) {
+    /* Every source vertex finds its own low bound, results are identical to the serial scan. */
+    MapDoublesData data = {
+        .doubles_map = doubles_map,
+        .mverts = mverts,
+        .sorted_verts_target = sorted_verts_target,
+        .sorted_verts_source = sorted_verts_source,
+        .target_num_verts = target_num_verts,
+        .dist = dist,
+        .dist3 = dist3,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, source_num_verts, &data, dm_mvert_map_doubles_task, &settings);
+
+    MEM_freeN(sorted_verts_source);
+    MEM_freeN(sorted_verts_target);
+    return;
+  }
+
   sve_target_low_bound = sorted_verts_target;
   i_target_low_bound = 0;
   target_scan_completed = false;
@@ -205,8 +345,6 @@ static void dm_mvert_map_doubles(int *doubles_map,
   /* all the while maintaining the lower bound of possible doubles in target vertices */
   for (i_source = 0, sve_source = sorted_verts_source; i_source < source_num_verts;
        i_source++, sve_source++) {
-    int best_target_vertex = -1;
-    float best_dist_sq = dist * dist;
     float sve_source_sumco;
 
     /* If source has already been assigned to a target (in an earlier call, with other chunks) */
@@ -235,45 +373,16 @@ static void dm_mvert_map_doubles(int *doubles_map,
       target_scan_completed = true;
       continue;
     }
-    /* Test target candidates starting at the low bound of possible doubles,
-     * ordered in terms of sumco. */
-    i_target = i_target_low_bound;
-    sve_target = sve_target_low_bound;
-
-    /* i_target will scan vertices in the
-     * [v_source_sumco - dist3;  v_source_sumco + dist3] range */
-
-    while ((i_target < target_num_verts) && (sve_target->sum_co <= sve_source_sumco + dist3)) {
-      /* Testing distance for candidate double in target */
-      /* v_target is within dist3 of v_source in terms of sumco;  check real distance */
-      float dist_sq;
-      if ((dist_sq = len_squared_v3v3(sve_source->co, sve_target->co)) <= best_dist_sq) {
-        /* Potential double found */
-        best_dist_sq = dist_sq;
-        best_target_vertex = sve_target->vertex_num;
-
-        /* If target is already mapped, we only follow that mapping if final target remains
-         * close enough from current vert (otherwise no mapping at all).
-         * Note that if we later find another target closer than this one, then we check it.
-         * But if other potential targets are farther,
-         * then there will be no mapping at all for this source. */
-        while (best_target_vertex != -1 &&
-               !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
-          if (compare_len_v3v3(mverts[sve_source->vertex_num].co,
-                               mverts[doubles_map[best_target_vertex]].co,
-                               dist)) {
-            best_target_vertex = doubles_map[best_target_vertex];
-          }
-          else {
-            best_target_vertex = -1;
-          }
-        }
-      }
-      i_target++;
-      sve_target++;
-    }
+
     /* End of candidate scan: if none found then no doubles */
-    doubles_map[sve_source->vertex_num] = best_target_vertex;
+    doubles_map[sve_source->vertex_num] = svert_find_double(sve_source,
+                                                            sorted_verts_target,
+                                                            target_num_verts,
+                                                            i_target_low_bound,
+                                                            doubles_map,
+                                                            mverts,
+                                                            dist,
+                                                            dist3);
   }
 
   MEM_freeN(sorted_verts_source);
@@ -362,16 +471,139 @@ static void mesh_merge_transform(Mesh *result,
   }
 }
 
+typedef struct ArrayChunkData {
+  const Mesh *src_mesh;
+  Mesh *result;
+  const float (*chunk_offsets)[4][4];
+  int chunk_nverts, chunk_nedges, chunk_nloops, chunk_npolys;
+  bool use_recalc_normals;
+  bool use_uv_offset;
+  float uv_offset[2];
+} ArrayChunkData;
+
+/**
+ * Fill in copy \a c of the source mesh, each chunk only writes to its own range of the result.
+ */
+static void array_chunk_fill_task(void *__restrict userdata,
+                                  const int c,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArrayChunkData *data = userdata;
+  const Mesh *mesh = data->src_mesh;
+  Mesh *result = data->result;
+  const float(*current_offset)[4] = data->chunk_offsets[c];
+  const int chunk_nverts = data->chunk_nverts;
+  const int chunk_nedges = data->chunk_nedges;
+  const int chunk_nloops = data->chunk_nloops;
+  const int chunk_npolys = data->chunk_npolys;
+  MVert *mv;
+  MEdge *me;
+  MLoop *ml;
+  MPoly *mp;
+  int i;
+
+  /* copy customdata to new geometry */
+  CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
+  CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
+  CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
+  CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
+
+  mv = result->mvert + c * chunk_nverts;
+
+  /* apply offset to all new verts */
+  for (i = 0; i < chunk_nverts; i++, mv++) {
+    mul_m4_v3(current_offset, mv->co);
+
+    /* We have to correct normals too, if we do not tag them as dirty! */
+    if (!data->use_recalc_normals) {
+      float no[3];
+      normal_short_to_float_v3(no, mv->no);
+      mul_mat3_m4_v3(current_offset, no);
+      normalize_v3(no);
+      normal_float_to_short_v3(mv->no, no);
+    }
+  }
+
+  /* adjust edge vertex indices */
+  me = result->medge + c * chunk_nedges;
+  for (i = 0; i < chunk_nedges; i++, me++) {
+    me->v1 += c * chunk_nverts;
+    me->v2 += c * chunk_nverts;
+  }
+
+  mp = result->mpoly + c * chunk_npolys;
+  for (i = 0; i < chunk_npolys; i++, mp++) {
+    mp->loopstart += c * chunk_nloops;
+  }
+
+  /* adjust loop vertex and edge indices */
+  ml = result->mloop + c * chunk_nloops;
+  for (i = 0; i < chunk_nloops; i++, ml++) {
+    ml->v += c * chunk_nverts;
+    ml->e += c * chunk_nedges;
+  }
+
+  /* handle UVs */
+  if (data->use_uv_offset) {
+    const float uv_offset[2] = {
+        data->uv_offset[0] * (float)c,
+        data->uv_offset[1] * (float)c,
+    };
+    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
+    for (i = 0; i < totuv; i++) {
+      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
+      dmloopuv += c * chunk_nloops;
+      for (int l_index = chunk_nloops; l_index-- != 0; dmloopuv++) {
+        dmloopuv->uv[0] += uv_offset[0];
+        dmloopuv->uv[1] += uv_offset[1];
+      }
+    }
+  }
+}
+
+typedef struct ArrayMergeTranslateData {
+  int *doubles_map;
+  const MVert *mverts;
+  int this_chunk_index;
+  int prev_chunk_index;
+  int chunk_nverts;
+  float merge_dist;
+} ArrayMergeTranslateData;
+
+static void array_merge_translate_task(void *__restrict userdata,
+                                       const int k,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ArrayMergeTranslateData *data = userdata;
+  int *full_doubles_map = data->doubles_map;
+  const int this_chunk_index = data->this_chunk_index + k;
+  int target = full_doubles_map[data->prev_chunk_index + k];
+
+  if (target != -1) {
+    target += data->chunk_nverts; /* translate mapping */
+    while (target != -1 && !ELEM(full_doubles_map[target], -1, target)) {
+      /* If target is already mapped, we only follow that mapping if final target remains
+       * close enough from current vert (otherwise no mapping at all). */
+      if (compare_len_v3v3(data->mverts[this_chunk_index].co,
+                           data->mverts[full_doubles_map[target]].co,
+                           data->merge_dist)) {
+        target = full_doubles_map[target];
+      }
+      else {
+        target = -1;
+      }
+    }
+  }
+  full_doubles_map[this_chunk_index] = target;
+}
+
 static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                                    const ModifierEvalContext *ctx,
                                    Mesh *mesh)
 {
   const MVert *src_mvert;
-  MVert *mv, *mv_prev, *result_dm_verts;
+  MVert *result_dm_verts;
 
-  MEdge *me;
-  MLoop *ml;
-  MPoly *mp;
   int i, j, c, count;
   float length = amd->length;
   /* offset matrix */
@@ -380,6 +612,7 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   bool offset_has_scale;
   float current_offset[4][4];
   float final_offset[4][4];
+  float(*chunk_offsets)[4][4];
   int *full_doubles_map = NULL;
   int tot_doubles;
 
@@ -576,80 +809,53 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   first_chunk_start = 0;
   first_chunk_nverts = chunk_nverts;
 
-  unit_m4(current_offset);
+  /* Cumulative offset of each chunk, so chunks can be filled in independently. */
+  chunk_offsets = MEM_malloc_arrayN(count, sizeof(*chunk_offsets), "mod array chunk offsets");
+  unit_m4(chunk_offsets[0]);
   for (c = 1; c < count; c++) {
-    /* copy customdata to new geometry */
-    CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
-    CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
-    CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
-    CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
-
-    mv_prev = result_dm_verts;
-    mv = mv_prev + c * chunk_nverts;
-
-    /* recalculate cumulative offset here */
-    mul_m4_m4m4(current_offset, current_offset, offset);
-
-    /* apply offset to all new verts */
-    for (i = 0; i < chunk_nverts; i++, mv++, mv_prev++) {
-      mul_m4_v3(current_offset, mv->co);
-
-      /* We have to correct normals too, if we do not tag them as dirty! */
-      if (!use_recalc_normals) {
-        float no[3];
-        normal_short_to_float_v3(no, mv->no);
-        mul_mat3_m4_v3(current_offset, no);
-        normalize_v3(no);
-        normal_float_to_short_v3(mv->no, no);
-      }
-    }
-
-    /* adjust edge vertex indices */
-    me = result->medge + c * chunk_nedges;
-    for (i = 0; i < chunk_nedges; i++, me++) {
-      me->v1 += c * chunk_nverts;
-      me->v2 += c * chunk_nverts;
-    }
-
-    mp = result->mpoly + c * chunk_npolys;
-    for (i = 0; i < chunk_npolys; i++, mp++) {
-      mp->loopstart += c * chunk_nloops;
-    }
-
-    /* adjust loop vertex and edge indices */
-    ml = result->mloop + c * chunk_nloops;
-    for (i = 0; i < chunk_nloops; i++, ml++) {
-      ml->v += c * chunk_nverts;
-      ml->e += c * chunk_nedges;
-    }
+    mul_m4_m4m4(chunk_offsets[c], chunk_offsets[c - 1], offset);
+  }
+  copy_m4_m4(current_offset, chunk_offsets[count - 1]);
+
+  if (count > 1) {
+    ArrayChunkData data = {
+        .src_mesh = mesh,
+        .result = result,
+        .chunk_offsets = (const float(*)[4][4])chunk_offsets,
+        .chunk_nverts = chunk_nverts,
+        .chunk_nedges = chunk_nedges,
+        .chunk_nloops = chunk_nloops,
+        .chunk_npolys = chunk_npolys,
+        .use_recalc_normals = use_recalc_normals,
+        .use_uv_offset = (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false),
+    };
+    copy_v2_v2(data.uv_offset, amd->uv_offset);
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = ((size_t)chunk_nverts * (size_t)count > 10000);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(1, count, &data, array_chunk_fill_task, &settings);
+  }
 
-    /* Handle merge between chunk n and n-1 */
-    if (use_merge && (c >= 1)) {
+  /* Handle merge between chunk n and n-1 */
+  if (use_merge) {
+    for (c = 1; c < count; c++) {
       if (!offset_has_scale && (c >= 2)) {
         /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
          * ... that is except if scaling makes the distance grow */
-        int k;
-        int this_chunk_index = c * chunk_nverts;
-        int prev_chunk_index = (c - 1) * chunk_nverts;
-        for (k = 0; k < chunk_nverts; k++, this_chunk_index++, prev_chunk_index++) {
-          int target = full_doubles_map[prev_chunk_index];
-          if (target != -1) {
-            target += chunk_nverts; /* translate mapping */
-            while (target != -1 && !ELEM(full_doubles_map[target], -1, target)) {
-              /* If target is already mapped, we only follow that mapping if final target remains
-               * close enough from current vert (otherwise no mapping at all). */
-              if (compare_len_v3v3(result_dm_verts[this_chunk_index].co,
-                                   result_dm_verts[full_doubles_map[target]].co,
-                                   amd->merge_dist)) {
-                target = full_doubles_map[target];
-              }
-              else {
-                target = -1;
-              }
-            }
-          }
-          full_doubles_map[this_chunk_index] = target;
-        }
+        ArrayMergeTranslateData data = {
+            .doubles_map = full_doubles_map,
+            .mverts = result_dm_verts,
+            .this_chunk_index = c * chunk_nverts,
+            .prev_chunk_index = (c - 1) * chunk_nverts,
+            .chunk_nverts = chunk_nverts,
+            .merge_dist = amd->merge_dist,
+        };
+        TaskParallelSettings settings;
+        BLI_parallel_range_settings_defaults(&settings);
+        settings.use_threading = (chunk_nverts > 10000);
+        BLI_task_parallel_range(0, chunk_nverts, &data, array_merge_translate_task, &settings);
       }
       else {
         dm_mvert_map_doubles(full_doubles_map,
@@ -658,30 +864,13 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                              chunk_nverts,
                              c * chunk_nverts,
                              chunk_nverts,
-                             amd->merge_dist);
+                             amd->merge_dist,
+                             chunk_nverts > 10000);
       }
     }
   }
 
-  /* handle UVs */
-  if (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false) {
-    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
-    for (i = 0; i < totuv; i++) {
-      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
-      dmloopuv += chunk_nloops;
-      for (c = 1; c < count; c++) {
-        const float uv_offset[2] = {
-            amd->uv_offset[0] * (float)c,
-            amd->uv_offset[1] * (float)c,
-        };
-        int l_index = chunk_nloops;
-        for (; l_index-- != 0; dmloopuv++) {
-          dmloopuv->uv[0] += uv_offset[0];
-          dmloopuv->uv[1] += uv_offset[1];
-        }
-      }
-    }
-  }
+  MEM_freeN(chunk_offsets);
 
   last_chunk_start = (count - 1) * chunk_nverts;
   last_chunk_nverts = chunk_nverts;
@@ -696,7 +885,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                          last_chunk_nverts,
                          first_chunk_start,
                          first_chunk_nverts,
-                         amd->merge_dist);
+                         amd->merge_dist,
+                         false);
   }
 
   /* start capping */
@@ -725,7 +915,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                            first_chunk_nverts,
                            start_cap_start,
                            start_cap_nverts,
-                           amd->merge_dist);
+                           amd->merge_dist,
+                           false);
     }
   }
 
@@ -754,7 +945,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                            last_chunk_nverts,
                            end_cap_start,
                            end_cap_nverts,
-                           amd->merge_dist);
+                           amd->merge_dist,
+                           false);
     }
   }
   /* done capping */
@@ -32,8 +32,8 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_alloca.h"
-#include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_merge_by_distance.h"
 
 #include "BLT_translation.h"
 
@@ -43,7 +43,6 @@
 #include "DNA_object_types.h"
 #include "DNA_screen_types.h"
 
-#include "BKE_bvhutils.h"
 #include "BKE_context.h"
 #include "BKE_deform.h"
 #include "BKE_mesh.h"
@@ -202,18 +201,15 @@ static bool weld_iter_loop_of_poly_begin(WeldLoopOfPolyIter *iter,
 
 static bool weld_iter_loop_of_poly_next(WeldLoopOfPolyIter *iter);
 
-static void weld_assert_vert_dest_map_setup(const BVHTreeOverlap *overlap,
-                                            const uint overlap_len,
-                                            const uint *vert_dest_map)
+static void weld_assert_vert_dest_map_setup(const uint mvert_len, const uint *vert_dest_map)
 {
-  const BVHTreeOverlap *overlap_iter = &overlap[0];
-  for (uint i = overlap_len; i--; overlap_iter++) {
-    uint indexA = overlap_iter->indexA;
-    uint indexB = overlap_iter->indexB;
-    uint va_dst = vert_dest_map[indexA];
-    uint vb_dst = vert_dest_map[indexB];
-
-    BLI_assert(va_dst == vb_dst);
+  for (uint i = 0; i < mvert_len; i++) {
+    uint v_dst = vert_dest_map[i];
+    if (v_dst != OUT_OF_CONTEXT) {
+      /* Every vertex of a group points to the lowest index of the group. */
+      BLI_assert(v_dst <= i);
+      BLI_assert(vert_dest_map[v_dst] == v_dst);
+    }
   }
 }
 
@@ -383,69 +379,10 @@ static void weld_assert_poly_len(const WeldPoly *wp, const WeldLoop *wloop)
  * \{ */
 
 static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
-                                          const BVHTreeOverlap *overlap,
-                                          const uint overlap_len,
-                                          uint *r_vert_dest_map,
+                                          const uint *vert_dest_map,
                                           WeldVert **r_wvert,
-                                          uint *r_wvert_len,
-                                          uint *r_vert_kill_len)
+                                          uint *r_wvert_len)
 {
-  uint *v_dest_iter = &r_vert_dest_map[0];
-  for (uint i = mvert_len; i--; v_dest_iter++) {
-    *v_dest_iter = OUT_OF_CONTEXT;
-  }
-
-  uint vert_kill_len = 0;
-  const BVHTreeOverlap *overlap_iter = &overlap[0];
-  for (uint i = 0; i < overlap_len; i++, overlap_iter++) {
-    uint indexA = overlap_iter->indexA;
-    uint indexB = overlap_iter->indexB;
-
-    BLI_assert(indexA < indexB);
-
-    uint va_dst = r_vert_dest_map[indexA];
-    uint vb_dst = r_vert_dest_map[indexB];
-    if (va_dst == OUT_OF_CONTEXT) {
-      if (vb_dst == OUT_OF_CONTEXT) {
-        vb_dst = indexA;
-        r_vert_dest_map[indexB] = vb_dst;
-      }
-      r_vert_dest_map[indexA] = vb_dst;
-      vert_kill_len++;
-    }
-    else if (vb_dst == OUT_OF_CONTEXT) {
-      r_vert_dest_map[indexB] = va_dst;
-      vert_kill_len++;
-    }
-    else if (va_dst != vb_dst) {
-      uint v_new, v_old;
-      if (va_dst < vb_dst) {
-        v_new = va_dst;
-        v_old = vb_dst;
-      }
-      else {
-        v_new = vb_dst;
-        v_old = va_dst;
-      }
-      BLI_assert(r_vert_dest_map[v_old] == v_old);
-      BLI_assert(r_vert_dest_map[v_new] == v_new);
-      vert_kill_len++;
-
-      const BVHTreeOverlap *overlap_iter_b = &overlap[0];
-      for (uint j = i + 1; j--; overlap_iter_b++) {
-        indexA = overlap_iter_b->indexA;
-        indexB = overlap_iter_b->indexB;
-        va_dst = r_vert_dest_map[indexA];
-        vb_dst = r_vert_dest_map[indexB];
-        if (ELEM(v_old, vb_dst, va_dst)) {
-          r_vert_dest_map[indexA] = v_new;
-          r_vert_dest_map[indexB] = v_new;
-        }
-      }
-      BLI_assert(r_vert_dest_map[v_old] == v_new);
-    }
-  }
-
   /* Vert Context. */
   uint wvert_len = 0;
 
@@ -453,7 +390,7 @@ static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
   wvert = MEM_mallocN(sizeof(*wvert) * mvert_len, __func__);
   wv = &wvert[0];
 
-  v_dest_iter = &r_vert_dest_map[0];
+  const uint *v_dest_iter = &vert_dest_map[0];
   for (uint i = 0; i < mvert_len; i++, v_dest_iter++) {
     if (*v_dest_iter != OUT_OF_CONTEXT) {
       wv->vert_dest = *v_dest_iter;
@@ -464,12 +401,11 @@ static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
   }
 
 #ifdef USE_WELD_DEBUG
-  weld_assert_vert_dest_map_setup(overlap, overlap_len, r_vert_dest_map);
+  weld_assert_vert_dest_map_setup(mvert_len, vert_dest_map);
 #endif
 
   *r_wvert = MEM_reallocN(wvert, sizeof(*wvert) * wvert_len);
   *r_wvert_len = wvert_len;
-  *r_vert_kill_len = vert_kill_len;
 }
 
 static void weld_vert_groups_setup(const uint mvert_len,
@@ -1394,9 +1330,13 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
 /** \name Weld Mesh API
  * \{ */
 
+/**
+ * \param vert_dest_map: The merge target of every vertex (or #OUT_OF_CONTEXT),
+ * owned by the weld mesh afterwards.
+ */
 static void weld_mesh_context_create(const Mesh *mesh,
-                                     BVHTreeOverlap *overlap,
-                                     const uint overlap_len,
+                                     uint *vert_dest_map,
+                                     const uint vert_kill_len,
                                      WeldMesh *r_weld_mesh)
 {
   const MEdge *medge = mesh->medge;
@@ -1407,19 +1347,13 @@ static void weld_mesh_context_create(const Mesh *mesh,
   const uint mloop_len = mesh->totloop;
   const uint mpoly_len = mesh->totpoly;
 
-  uint *vert_dest_map = MEM_mallocN(sizeof(*vert_dest_map) * mvert_len, __func__);
   uint *edge_dest_map = MEM_mallocN(sizeof(*edge_dest_map) * medge_len, __func__);
   struct WeldGroup *v_links = MEM_callocN(sizeof(*v_links) * mvert_len, __func__);
 
   WeldVert *wvert;
   uint wvert_len;
-  weld_vert_ctx_alloc_and_setup(mvert_len,
-                                overlap,
-                                overlap_len,
-                                vert_dest_map,
-                                &wvert,
-                                &wvert_len,
-                                &r_weld_mesh->vert_kill_len);
+  weld_vert_ctx_alloc_and_setup(mvert_len, vert_dest_map, &wvert, &wvert_len);
+  r_weld_mesh->vert_kill_len = vert_kill_len;
 
   uint *edge_ctx_map;
   WeldEdge *wedge;
@@ -1633,22 +1567,6 @@ static void customdata_weld(
 /** \name Weld Modifier Main
  * \{ */
 
-struct WeldOverlapData {
-  const MVert *mvert;
-  float merge_dist_sq;
-};
-static bool bvhtree_weld_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
-{
-  if (index_a < index_b) {
-    struct WeldOverlapData *data = userdata;
-    const MVert *mvert = data->mvert;
-    const float dist_sq = len_squared_v3v3(mvert[index_a].co, mvert[index_b].co);
-    BLI_assert(dist_sq <= ((data->merge_dist_sq + FLT_EPSILON) * 3));
-    return dist_sq <= data->merge_dist_sq;
-  }
-  return false;
-}
-
 static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   Mesh *result = mesh;
@@ -1657,13 +1575,11 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   BLI_bitmap *v_mask = NULL;
   int v_mask_act = 0;
 
-  const MVert *mvert;
   const MLoop *mloop;
   const MPoly *mpoly, *mp;
   uint totvert, totedge, totloop, totpoly;
   uint i;
 
-  mvert = mesh->mvert;
   totvert = mesh->totvert;
 
   /* Vertex Group. */
@@ -1685,48 +1601,38 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     }
   }
 
-  /* Get overlap map. */
-  /* TODO: For a better performanse use KD-Tree. */
-  struct BVHTreeFromMesh treedata;
-  BVHTree *bvhtree = bvhtree_from_mesh_verts_ex(&treedata,
-                                                mvert,
-                                                totvert,
-                                                false,
-                                                v_mask,
-                                                v_mask_act,
-                                                wmd->merge_dist / 2,
-                                                2,
-                                                6,
-                                                0,
-                                                NULL,
-                                                NULL);
+  /* Get the merge target of every vertex. */
+  uint *vert_dest_map = NULL;
+  uint vert_kill_len = 0;
+  if (v_mask == NULL || v_mask_act > 1) {
+    float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+    vert_dest_map = MEM_mallocN(sizeof(*vert_dest_map) * totvert, __func__);
+    /* #OUT_OF_CONTEXT matches the -1 used for vertices that are not merged.
+     * With a duplicate limit, every vertex is linked to the vertices of the lowest higher
+     * indices in range. The BVH-tree overlap used before kept the first pairs it happened to
+     * find while traversing the tree, so dense groups can be split differently than they were
+     * in older files, but the result no longer depends on the layout of the tree. */
+    vert_kill_len = (uint)BLI_merge_by_distance_clusters(vert_coords,
+                                                         (int)totvert,
+                                                         v_mask,
+                                                         wmd->merge_dist,
+                                                         (int)wmd->max_interactions,
+                                                         (int *)vert_dest_map);
+    MEM_freeN(vert_coords);
+  }
 
   if (v_mask) {
     MEM_freeN(v_mask);
   }
 
-  if (bvhtree == NULL) {
+  if (vert_kill_len == 0) {
+    MEM_SAFE_FREE(vert_dest_map);
     return result;
   }
 
-  struct WeldOverlapData data;
-  data.mvert = mvert;
-  data.merge_dist_sq = square_f(wmd->merge_dist);
-
-  uint overlap_len;
-  BVHTreeOverlap *overlap = BLI_bvhtree_overlap_ex(bvhtree,
-                                                   bvhtree,
-                                                   &overlap_len,
-                                                   bvhtree_weld_overlap_cb,
-                                                   &data,
-                                                   wmd->max_interactions,
-                                                   BVH_OVERLAP_RETURN_PAIRS);
-
-  free_bvhtree_from_mesh(&treedata);
-
-  if (overlap_len) {
+  {
     WeldMesh weld_mesh;
-    weld_mesh_context_create(mesh, overlap, overlap_len, &weld_mesh);
+    weld_mesh_context_create(mesh, vert_dest_map, vert_kill_len, &weld_mesh);
 
     mloop = mesh->mloop;
     mpoly = mesh->mpoly;
@@ -1918,7 +1824,6 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     weld_mesh_context_free(&weld_mesh);
   }
 
-  MEM_freeN(overlap);
   return result;
 }
 
@@ -92,6 +92,8 @@
 #include "BLO_undofile.h" /* to save from an undo memfile */
 #include "BLO_writefile.h"
 
+#include "COM_compositor.h"
+
 #include "RNA_access.h"
 #include "RNA_define.h"
 
@@ -543,6 +545,10 @@ static void wm_file_read_pre(bContext *C, bool use_data, bool UNUSED(use_userdef
   if (use_data) {
     BKE_callback_exec_null(CTX_data_main(C), BKE_CB_EVT_LOAD_PRE);
     BLI_timer_on_file_load();
+#ifdef WITH_COMPOSITOR
+    /* Cached results are only valid for the data of the current file. */
+    COM_clearCaches();
+#endif
   }
 
   /* Always do this as both startup and preferences may have loaded in many font's